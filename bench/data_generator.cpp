@@ -0,0 +1,148 @@
+/**
+ * \file data_generator.cpp
+ * \brief Быстрый генератор входных CSV: исторические файлы и дозапись с заданным темпом
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Без --rate пишет N исторических файлов до заданного числа строк или
+ * размера (многогигабайтные файлы за секунды). С --rate дописывает в N
+ * файлов суммарно rate строк/с с receive_ts по системным часам, как
+ * data_generation.py, но без пауз в секунды и без ожидания Enter:
+ * работа ограничивается --duration.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "trade_generator.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+/**
+ * \brief Пути выходных файлов
+ */
+[[nodiscard]] std::vector<std::string> output_files(const fs::path& dir_, const std::string& prefix_, std::size_t count_)
+{
+    fs::create_directories(dir_);
+    std::vector<std::string> files;
+    for (std::size_t i = 0; i < count_; ++i) {
+        files.push_back((dir_ / (prefix_ + std::to_string(i) + ".csv")).string());
+    }
+    return files;
+}
+
+/**
+ * \brief Дописывает в файлы с темпом rate_ в течение duration_ (0 - без ограничения)
+ */
+[[nodiscard]] app::bench::written_totals generate_stream(
+    const std::vector<std::string>& files_,
+    double rate_,
+    std::uint64_t seed_,
+    std::chrono::duration<double> duration_,
+    std::chrono::milliseconds tick_)
+{
+    app::bench::stream_writer writer{files_, rate_, seed_};
+    const auto start = clock_type::now();
+    auto next_report = start + std::chrono::seconds{1};
+
+    while (duration_.count() <= 0.0 || clock_type::now() - start < duration_) {
+        writer.append_due();
+        if (clock_type::now() >= next_report) {
+            const std::chrono::duration<double> elapsed = clock_type::now() - start;
+            const auto rows = writer.totals()._rows;
+            std::cerr << "\rRows: " << rows << " (" << static_cast<std::size_t>(static_cast<double>(rows) / elapsed.count())
+                      << " rows/s)" << std::flush;
+            next_report += std::chrono::seconds{1};
+        }
+        std::this_thread::sleep_for(tick_);
+    }
+    std::cerr << std::endl;
+    return writer.totals();
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа генератора
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("output-dir", po::value<std::string>()->default_value("generated"), "Directory for generated files")
+        ("prefix", po::value<std::string>()->default_value("orders_"), "File name prefix")
+        ("files", po::value<std::size_t>()->default_value(1), "Number of files")
+        ("rows", po::value<std::size_t>()->default_value(0), "Historical mode: rows per file (0 - unlimited)")
+        ("size-mb", po::value<std::size_t>()->default_value(0), "Historical mode: size per file in MiB (0 - unlimited)")
+        ("rate", po::value<double>()->default_value(0.0), "Streaming mode: total rows per second appended to the files")
+        ("duration", po::value<double>()->default_value(0.0), "Streaming mode: seconds to run (0 - until killed)")
+        ("tick-ms", po::value<std::int64_t>()->default_value(10), "Streaming mode: append period")
+        ("seed", po::value<std::uint64_t>()->default_value(42), "Random seed");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    const auto rate = vm["rate"].as<double>();
+    const auto rows = vm["rows"].as<std::size_t>();
+    const auto bytes = vm["size-mb"].as<std::size_t>() << 20;
+    const auto seed = vm["seed"].as<std::uint64_t>();
+    if (rate <= 0.0 && !rows && !bytes) {
+        std::cerr << "Either --rate or --rows/--size-mb is required\n" << desc << std::endl;
+        return 1;
+    }
+
+    try {
+        const auto files = output_files(vm["output-dir"].as<std::string>(), vm["prefix"].as<std::string>(),
+                                        std::max<std::size_t>(vm["files"].as<std::size_t>(), 1));
+
+        const auto start = clock_type::now();
+        app::bench::written_totals totals;
+        if (rate > 0.0) {
+            totals = generate_stream(files, rate, seed, std::chrono::duration<double>{vm["duration"].as<double>()},
+                                     std::chrono::milliseconds{std::max<std::int64_t>(vm["tick-ms"].as<std::int64_t>(), 1)});
+        } else {
+            // Общее начало receive_ts: ряды файлов перекрываются, как у нескольких инструментов
+            const auto start_ts = app::bench::trade_generator::wall_clock_us();
+            for (std::size_t i = 0; i < files.size(); ++i) {
+                const auto file_totals = app::bench::write_history(files[i], seed + i, start_ts, rows, bytes);
+                totals._rows += file_totals._rows;
+                totals._bytes += file_totals._bytes;
+            }
+        }
+        const std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+        const auto total_rows = totals._rows;
+        std::cout << "Files: " << files.size() << ", rows: " << total_rows << ", bytes: " << totals._bytes
+                  << ", seconds: " << elapsed.count()
+                  << ", rows/s: " << (elapsed.count() > 0.0 ? static_cast<double>(total_rows) / elapsed.count() : 0.0)
+                  << std::endl;
+    } catch (const std::exception& e_) {
+        std::cerr << "Generation failed: " << e_.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
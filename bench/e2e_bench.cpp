@@ -0,0 +1,251 @@
+/**
+ * \file e2e_bench.cpp
+ * \brief Сквозной замер конвейера: пропускная способность и задержка
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Две фазы в одном процессе:
+ *   throughput - генерирует исторические файлы и прогоняет их через
+ *                конвейер без потокового режима: строк/с от чтения первой
+ *                строки до последнего вывода, процессорное время на строку,
+ *                пиковая резидентная память;
+ *   latency    - потоковый режим, генератор дописывает в файлы с темпом
+ *                --rate, задержка от дозаписи строки до результата
+ *                (перцентили), потерянные результаты, процессор на строку
+ *                (без времени генератора, он работает в главном потоке).
+ * Итог печатается JSON-объектом, как у csv_median_bench.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "logger.hpp"
+#include "pipeline_harness.hpp"
+#include "pipeline_metrics.hpp"
+#include "process_stats.hpp"
+#include "trade_generator.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+constexpr double PERCENTILES[] = {0.5, 0.9, 0.99, 0.999};   ///< Выводимые перцентили задержки
+constexpr const char* PERCENTILE_NAMES[] = {"p50", "p90", "p99", "p999"};
+
+/**
+ * \brief Параметры прогона
+ */
+struct e2e_settings {
+    std::size_t _files{4};                              ///< Входных файлов
+    std::size_t _rows{1'000'000};                       ///< Исторических строк на все файлы
+    double _rate{100'000.0};                            ///< Темп дозаписи, строк/с на все файлы
+    double _duration{10.0};                             ///< Длительность фазы задержки, с
+    std::chrono::milliseconds _tick{1};                 ///< Период дозаписи
+    bool _skip_throughput{false};                       ///< Пропустить фазу пропускной способности
+    bool _skip_latency{false};                          ///< Пропустить фазу задержки
+    fs::path _work_dir;                                 ///< Директория временных файлов
+    app::bench::harness_settings _harness;              ///< Параметры конвейера
+};
+
+/**
+ * \brief Пути входных файлов
+ */
+[[nodiscard]] std::vector<std::string> input_files(const e2e_settings& settings_)
+{
+    std::vector<std::string> files;
+    for (std::size_t i = 0; i < settings_._files; ++i) {
+        files.push_back((settings_._work_dir / ("orders_" + std::to_string(i) + ".csv")).string());
+    }
+    return files;
+}
+
+/**
+ * \brief Дописывает поле JSON "name": value
+ */
+template <typename T>
+void put_field(std::ostream& out_, const char* name_, const T& value_, bool last_ = false)
+{
+    out_ << "\"" << name_ << "\": " << value_ << (last_ ? "" : ", ");
+}
+
+/**
+ * \brief Фаза пропускной способности
+ */
+void run_throughput(std::ostream& out_, const e2e_settings& settings_)
+{
+    const auto files = input_files(settings_);
+    const auto generate_start = clock_type::now();
+    const auto start_ts = app::bench::trade_generator::wall_clock_us();
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        (void)app::bench::write_history(files[i], i + 1, start_ts, settings_._rows / files.size(), 0);
+    }
+    const std::chrono::duration<double> generate_time = clock_type::now() - generate_start;
+    std::cerr << "Generated " << settings_._rows << " rows in " << generate_time.count() << " s" << std::endl;
+
+    auto harness_settings = settings_._harness;
+    harness_settings._streaming = false;
+
+    const auto cpu_start = app::bench::cpu_seconds();
+    app::bench::pipeline_harness harness{harness_settings, files};
+    harness.run();
+    harness.finish();
+    const auto cpu = app::bench::cpu_seconds() - cpu_start;
+    const auto rows = harness.rows();
+
+    // От чтения первой строки до последнего вывода: паузы add_csv_file() и stop() по 100 мс не входят
+    const auto& metrics = app::processing::pipeline_metrics::instance();
+    const auto seconds = static_cast<double>(metrics.last_emitted() - metrics.first_read()) * 1e-9;
+
+    out_ << "  \"throughput\": {";
+    put_field(out_, "rows", rows);
+    put_field(out_, "seconds", seconds);
+    put_field(out_, "rows_per_sec", seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0);
+    put_field(out_, "cpu_ns_per_row", rows ? cpu * 1e9 / static_cast<double>(rows) : 0.0);
+    put_field(out_, "peak_rss_bytes", app::bench::peak_rss(), true);
+    out_ << "}";
+
+    for (const auto& file : files) {
+        fs::remove(file);
+    }
+}
+
+/**
+ * \brief Фаза задержки в потоковом режиме
+ */
+void run_latency(std::ostream& out_, const e2e_settings& settings_)
+{
+    const auto files = input_files(settings_);
+    for (const auto& file : files) {
+        std::ofstream{file, std::ios::binary | std::ios::trunc} << app::bench::CSV_HEADER;
+    }
+
+    auto harness_settings = settings_._harness;
+    harness_settings._streaming = true;
+
+    app::bench::pipeline_harness harness{harness_settings, files};
+    harness.run();
+    // Расписание дозаписи начинается, когда ридеры уже ждут данных
+    app::bench::stream_writer writer{files, settings_._rate, 1};
+    const auto cpu_start = app::bench::cpu_seconds();
+    const auto writer_cpu_start = app::bench::thread_cpu_seconds();
+    const auto start = clock_type::now();
+    while (clock_type::now() - start < std::chrono::duration<double>{settings_._duration}) {
+        writer.append_due();
+        std::this_thread::sleep_for(settings_._tick);
+    }
+    // Генератор дописывает из этого потока: его время не относится к конвейеру
+    const auto writer_cpu = app::bench::thread_cpu_seconds() - writer_cpu_start;
+    const auto cpu = app::bench::cpu_seconds() - cpu_start - writer_cpu;
+    harness.finish();
+
+    const auto rows = harness.rows();
+    const auto& latency = harness.latency();
+    out_ << "  \"latency\": {";
+    put_field(out_, "rate", settings_._rate);
+    put_field(out_, "written", writer.totals()._rows);
+    put_field(out_, "rows", rows);
+    put_field(out_, "results", latency.count());
+    put_field(out_, "lost_results", harness.lost());
+    put_field(out_, "cpu_ns_per_row", rows ? cpu * 1e9 / static_cast<double>(rows) : 0.0);
+    put_field(out_, "generator_cpu_seconds", writer_cpu);
+    out_ << "\"latency_us\": {";
+    for (std::size_t i = 0; i < std::size(PERCENTILES); ++i) {
+        put_field(out_, PERCENTILE_NAMES[i], static_cast<double>(latency.percentile(PERCENTILES[i])) / 1000.0);
+    }
+    put_field(out_, "max", static_cast<double>(latency.max()) / 1000.0, true);
+    out_ << "}, ";
+    put_field(out_, "peak_rss_bytes", app::bench::peak_rss(), true);
+    out_ << "}";
+
+    for (const auto& file : files) {
+        fs::remove(file);
+    }
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа сквозного замера
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    e2e_settings settings;
+    std::string output;
+    std::size_t tick_ms = static_cast<std::size_t>(settings._tick.count());
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("files", po::value<std::size_t>(&settings._files)->default_value(settings._files), "Input files")
+        ("rows", po::value<std::size_t>(&settings._rows)->default_value(settings._rows), "Throughput phase: rows across all files")
+        ("rate", po::value<double>(&settings._rate)->default_value(settings._rate), "Latency phase: appended rows per second across all files")
+        ("duration", po::value<double>(&settings._duration)->default_value(settings._duration), "Latency phase: seconds")
+        ("tick-ms", po::value<std::size_t>(&tick_ms)->default_value(tick_ms), "Latency phase: append period")
+        ("shards", po::value<std::size_t>(&settings._harness._shards)->default_value(1), "Calculator shards")
+        ("compression", po::value<std::size_t>(&settings._harness._engine._compression)->default_value(100), "Digest compression")
+        ("min-interval", po::value<std::int_fast64_t>(&settings._harness._emission._min_interval)->default_value(0), "Emission min interval in receive_ts units")
+        ("skip-throughput", po::bool_switch(&settings._skip_throughput), "Skip the throughput phase")
+        ("skip-latency", po::bool_switch(&settings._skip_latency), "Skip the latency phase")
+        ("output", po::value<std::string>(&output), "Write JSON to this file instead of stdout");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    settings._files = std::max<std::size_t>(settings._files, 1);
+    settings._tick = std::chrono::milliseconds{std::max<std::size_t>(tick_ms, 1)};
+
+    // Ридеры сообщают о каждом прочитанном файле; JSON в stdout должен остаться чистым
+    spdlog::set_level(spdlog::level::warn);
+
+    settings._work_dir = fs::temp_directory_path() / "csv_median_e2e";
+    fs::create_directories(settings._work_dir);
+    settings._harness._output = settings._work_dir / "median.csv";
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output, std::ios::trunc);
+    }
+    std::ostream& out = output.empty() ? std::cout : file;
+
+    try {
+        out << "{\n";
+        if (!settings._skip_throughput) {
+            run_throughput(out, settings);
+            out << (settings._skip_latency ? "\n" : ",\n");
+        }
+        if (!settings._skip_latency) {
+            run_latency(out, settings);
+            out << "\n";
+        }
+        out << "}" << std::endl;
+    } catch (const std::exception& e_) {
+        std::cerr << "Benchmark failed: " << e_.what() << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::remove_all(settings._work_dir, ec);
+    return 0;
+}
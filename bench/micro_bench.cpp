@@ -0,0 +1,410 @@
+/**
+ * \file micro_bench.cpp
+ * \brief Микробенчмарки горячих компонентов конвейера с выводом в JSON
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Замеряет разбор строки CSV, очередь под конкуренцией потоков, слияние
+ * потоков ридеров в readers_manager, вставку и запрос квантиля T-Digest
+ * и запись строки результата в file_streamer. Каждый замер повторяется
+ * --repeats раз, в отчёт идёт медианное время. Результат - JSON-массив,
+ * пригодный для сравнения между сборками.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "csv_reader.hpp"
+#include "data_queue.hpp"
+#include "file_streamer.hpp"
+#include "logger.hpp"
+#include "readers_manager.hpp"
+#include "TDigest.hpp"
+#include "types.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+constexpr std::int_fast64_t BASE_TS = 1771189878289859;     ///< Первый receive_ts сгенерированных строк
+constexpr std::size_t COMPRESSIONS[] = {25, 100, 400};      ///< Компрессии T-Digest
+constexpr std::size_t QUERY_COUNT = 10'000;                 ///< Запросов квантиля на замер
+
+/**
+ * \brief Результат одного замера
+ */
+struct bench_result {
+    std::string _name;                                      ///< Имя замера
+    std::vector<std::pair<std::string, double>> _params;    ///< Параметры замера
+    std::size_t _operations{0};                             ///< Операций за прогон
+    double _ns_per_op{0.0};                                 ///< Медианное время операции, нс
+    double _ops_per_sec{0.0};                               ///< Операций в секунду
+};
+
+/**
+ * \brief Параметры прогона
+ */
+struct bench_settings {
+    std::size_t _rows{1'000'000};                           ///< Строк на замер
+    std::size_t _repeats{5};                                ///< Повторов замера
+    std::vector<std::size_t> _threads{1, 2, 4};             ///< Производителей в замере очереди
+    std::vector<std::size_t> _readers{1, 4, 16};            ///< Ридеров в замере слияния
+    std::string _filter;                                    ///< Подстрока имени замера (пусто - все)
+    fs::path _work_dir;                                     ///< Директория временных файлов
+};
+
+/**
+ * \brief Повторяет прогон run_ и возвращает медианное время в секундах
+ *
+ * run_ возвращает длительность своей измеряемой части, чтобы подготовку
+ * (генерацию файлов, наполнение очередей) можно было исключить.
+ */
+template <typename Run>
+[[nodiscard]] double median_seconds(std::size_t repeats_, Run&& run_)
+{
+    std::vector<double> times;
+    times.reserve(repeats_);
+    for (std::size_t i = 0; i < repeats_; ++i) {
+        const std::chrono::duration<double> elapsed = run_();
+        times.push_back(elapsed.count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+/**
+ * \brief Собирает результат из числа операций и времени прогона
+ */
+[[nodiscard]] bench_result make_result(
+    std::string name_,
+    std::vector<std::pair<std::string, double>> params_,
+    std::size_t operations_,
+    double seconds_)
+{
+    bench_result result{std::move(name_), std::move(params_), operations_};
+    if (operations_ && seconds_ > 0.0) {
+        result._ns_per_op = seconds_ * 1e9 / static_cast<double>(operations_);
+        result._ops_per_sec = static_cast<double>(operations_) / seconds_;
+    }
+    std::cerr << result._name << ": " << result._ns_per_op << " ns/op" << std::endl;
+    return result;
+}
+
+/**
+ * \brief Генерирует строки CSV в формате receive_ts;exchange_ts;price;quantity;side
+ */
+[[nodiscard]] std::vector<std::string> make_lines(std::size_t rows_, std::uint32_t seed_)
+{
+    std::mt19937_64 rng{seed_};
+    std::normal_distribution<double> step{0.0, 0.1};
+    std::uniform_real_distribution<double> quantity{0.001, 1.0};
+    std::bernoulli_distribution side{0.5};
+
+    std::vector<std::string> lines;
+    lines.reserve(rows_);
+    double price = 68480.0;
+    for (std::size_t i = 0; i < rows_; ++i) {
+        price += step(rng);
+        const auto ts = BASE_TS + static_cast<std::int_fast64_t>(i) * 3;
+        lines.push_back(std::to_string(ts) + ';' + std::to_string(ts - 8) + ';'
+            + std::to_string(price) + ';' + std::to_string(quantity(rng)) + ';' + (side(rng) ? "bid" : "ask"));
+    }
+    return lines;
+}
+
+// ==================== замеры ====================
+
+/**
+ * \brief csv_reader::parse_line на сгенерированных строках
+ */
+[[nodiscard]] bench_result bench_parse_line(const bench_settings& settings_)
+{
+    const auto lines = make_lines(settings_._rows, 1);
+    std::size_t parsed = 0;
+
+    const auto seconds = median_seconds(settings_._repeats, [&] {
+        const auto start = clock_type::now();
+        for (const auto& line : lines) {
+            parsed += app::io::csv_reader::parse_line(line) != nullptr;
+        }
+        return clock_type::now() - start;
+    });
+
+    if (parsed != lines.size() * settings_._repeats) {
+        std::cerr << "parse_line rejected generated rows" << std::endl;
+    }
+    return make_result("csv_reader.parse_line", {}, lines.size(), seconds);
+}
+
+/**
+ * \brief data_queue: producers_ потоков push, один поток pop_batch, как у калькулятора
+ */
+[[nodiscard]] bench_result bench_queue(const bench_settings& settings_, std::size_t producers_)
+{
+    const auto per_producer = settings_._rows / producers_;
+    const auto total = per_producer * producers_;
+
+    const auto seconds = median_seconds(settings_._repeats, [&] {
+        app::processing::data_queue queue;
+        std::vector<std::unique_ptr<data>> batch;
+        batch.reserve(1024);
+        std::size_t received = 0;
+
+        const auto start = clock_type::now();
+        std::vector<std::jthread> threads;
+        for (std::size_t p = 0; p < producers_; ++p) {
+            threads.emplace_back([&queue, per_producer, p] {
+                for (std::size_t i = 0; i < per_producer; ++i) {
+                    queue.push(std::make_unique<data>(BASE_TS + static_cast<std::int_fast64_t>(i), static_cast<double>(p)));
+                }
+            });
+        }
+        while (received < total) {
+            batch.clear();
+            received += queue.pop_batch(batch, 1024);
+        }
+        const auto elapsed = clock_type::now() - start;
+        threads.clear();
+        return elapsed;
+    });
+
+    return make_result("data_queue.push_pop", {{"producers", static_cast<double>(producers_)}}, total, seconds);
+}
+
+/**
+ * \brief readers_manager: слияние readers_ отсортированных файлов в одну очередь
+ *
+ * Время считается от запуска воронки до её остановки; чтение файлов
+ * ридерами начинается раньше и частично перекрывается с ним.
+ */
+[[nodiscard]] bench_result bench_merge(const bench_settings& settings_, std::size_t readers_)
+{
+    const auto per_reader = settings_._rows / readers_;
+    const auto lines = make_lines(per_reader * readers_, 2);
+
+    // Строки раздаются по файлам по кругу: каждый файл отсортирован, а слияние перемешивает их
+    std::vector<std::string> files;
+    for (std::size_t r = 0; r < readers_; ++r) {
+        const auto path = settings_._work_dir / ("merge_" + std::to_string(r) + ".csv");
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out << "receive_ts;exchange_ts;price;quantity;side\n";
+        for (std::size_t i = r; i < lines.size(); i += readers_) {
+            out << lines[i] << '\n';
+        }
+        files.push_back(path.string());
+    }
+
+    std::size_t merged = 0;
+    const auto seconds = median_seconds(settings_._repeats, [&] {
+        app::io::readers_manager manager{false};
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            manager.add_csv_file(files[i], static_cast<std::uint32_t>(i));
+        }
+        const auto start = clock_type::now();
+        manager.run();
+        // Время слияния - до последней строки в очереди: stop() спит по 100 мс на ридер
+        while (manager.tasks()->size() < lines.size()) {
+            std::this_thread::yield();
+        }
+        const auto elapsed = clock_type::now() - start;
+        manager.stop();
+        merged = manager.tasks()->size();
+        return elapsed;
+    });
+
+    for (const auto& file : files) {
+        fs::remove(file);
+    }
+    return make_result("readers_manager.merge", {{"readers", static_cast<double>(readers_)}}, merged, seconds);
+}
+
+/**
+ * \brief tdigest::add и tdigest::quantile при компрессии compression_
+ */
+[[nodiscard]] std::vector<bench_result> bench_tdigest(const bench_settings& settings_, std::size_t compression_)
+{
+    std::mt19937_64 rng{3};
+    std::lognormal_distribution<double> distribution{0.0, 1.0};
+    std::vector<double> values(settings_._rows);
+    for (auto& value : values) {
+        value = 100.0 * distribution(rng);
+    }
+
+    app::statistics::tdigest digest{compression_};
+    const auto add_seconds = median_seconds(settings_._repeats, [&] {
+        digest = app::statistics::tdigest{compression_};
+        const auto start = clock_type::now();
+        for (const double value : values) {
+            digest.add(value);
+        }
+        return clock_type::now() - start;
+    });
+
+    // Запросы к заполненному дайджесту, вперемешку со вставками, как в калькуляторе
+    volatile double sink = 0.0;
+    const auto query_seconds = median_seconds(settings_._repeats, [&] {
+        std::chrono::nanoseconds elapsed{0};
+        for (std::size_t i = 0; i < QUERY_COUNT; ++i) {
+            digest.add(values[i % values.size()]);
+            const auto start = clock_type::now();
+            sink = digest.quantile(0.5);
+            elapsed += clock_type::now() - start;
+        }
+        return elapsed;
+    });
+    (void)sink;
+
+    const std::vector<std::pair<std::string, double>> params{{"compression", static_cast<double>(compression_)}};
+    return {
+        make_result("tdigest.add", params, values.size(), add_seconds),
+        make_result("tdigest.quantile", params, QUERY_COUNT, query_seconds),
+    };
+}
+
+/**
+ * \brief file_streamer::write_median с двумя дополнительными колонками, включая сброс на диск
+ */
+[[nodiscard]] bench_result bench_write(const bench_settings& settings_)
+{
+    const auto path = settings_._work_dir / "median.csv";
+    std::vector<std::pair<std::string, double>> extras{{"mean", 0.0}, {"p99", 0.0}};
+
+    const auto seconds = median_seconds(settings_._repeats, [&] {
+        fs::remove(path);
+        app::io::file_streamer streamer{path.string()};
+        const auto start = clock_type::now();
+        for (std::size_t i = 0; i < settings_._rows; ++i) {
+            const double value = 68480.0 + static_cast<double>(i % 1000) * 0.01;
+            extras[0].second = value;
+            extras[1].second = value + 1.0;
+            streamer.write_median(BASE_TS + static_cast<std::int_fast64_t>(i), value, extras);
+        }
+        streamer.flush();
+        return clock_type::now() - start;
+    });
+
+    fs::remove(path);
+    return make_result("file_streamer.write_median", {}, settings_._rows, seconds);
+}
+
+// ==================== отчёт ====================
+
+/**
+ * \brief Печатает результаты JSON-массивом
+ */
+void print_json(std::ostream& out_, const std::vector<bench_result>& results_)
+{
+    out_ << "[\n";
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+        const auto& result = results_[i];
+        out_ << "  {\"name\": \"" << result._name << "\", \"params\": {";
+        for (std::size_t p = 0; p < result._params.size(); ++p) {
+            out_ << (p ? ", \"" : "\"") << result._params[p].first << "\": " << result._params[p].second;
+        }
+        out_ << "}, \"operations\": " << result._operations
+             << ", \"ns_per_op\": " << result._ns_per_op
+             << ", \"ops_per_sec\": " << result._ops_per_sec
+             << (i + 1 < results_.size() ? "},\n" : "}\n");
+    }
+    out_ << "]\n";
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа микробенчмарков
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    bench_settings settings;
+    std::string output;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("rows", po::value<std::size_t>(&settings._rows)->default_value(settings._rows), "Rows per benchmark")
+        ("repeats", po::value<std::size_t>(&settings._repeats)->default_value(settings._repeats), "Runs per benchmark (median is reported)")
+        ("threads", po::value<std::vector<std::size_t>>(&settings._threads)->multitoken(), "Producer counts for the queue benchmark")
+        ("readers", po::value<std::vector<std::size_t>>(&settings._readers)->multitoken(), "Reader counts for the merge benchmark")
+        ("filter", po::value<std::string>(&settings._filter), "Run only benchmarks whose name contains this string")
+        ("output", po::value<std::string>(&output), "Write JSON to this file instead of stdout");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    settings._repeats = std::max<std::size_t>(settings._repeats, 1);
+    settings._rows = std::max<std::size_t>(settings._rows, 1);
+
+    // Ридеры сообщают о каждом прочитанном файле; JSON в stdout должен остаться чистым
+    spdlog::set_level(spdlog::level::warn);
+
+    settings._work_dir = fs::temp_directory_path() / "csv_median_bench";
+    fs::create_directories(settings._work_dir);
+
+    const auto selected = [&settings](std::string_view name_) {
+        return settings._filter.empty() || name_.find(settings._filter) != std::string_view::npos;
+    };
+
+    std::vector<bench_result> results;
+    try {
+        if (selected("csv_reader.parse_line")) {
+            results.push_back(bench_parse_line(settings));
+        }
+        if (selected("data_queue.push_pop")) {
+            for (const auto producers : settings._threads) {
+                results.push_back(bench_queue(settings, std::max<std::size_t>(producers, 1)));
+            }
+        }
+        if (selected("readers_manager.merge")) {
+            for (const auto readers : settings._readers) {
+                results.push_back(bench_merge(settings, std::max<std::size_t>(readers, 1)));
+            }
+        }
+        if (selected("tdigest.add") || selected("tdigest.quantile")) {
+            for (const auto compression : COMPRESSIONS) {
+                auto digest_results = bench_tdigest(settings, compression);
+                results.insert(results.end(), digest_results.begin(), digest_results.end());
+            }
+        }
+        if (selected("file_streamer.write_median")) {
+            results.push_back(bench_write(settings));
+        }
+    } catch (const std::exception& e_) {
+        std::cerr << "Benchmark failed: " << e_.what() << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::remove_all(settings._work_dir, ec);
+
+    if (output.empty()) {
+        print_json(std::cout, results);
+    } else {
+        std::ofstream out{output, std::ios::trunc};
+        print_json(out, results);
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * \file pipeline_harness.hpp
+ * \brief Конвейер калькулятора в одном процессе для сквозных замеров (header-only)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Собирает то же, что main.cpp: readers_manager → калькулятор →
+ * file_streamer, и дополнительно публикует результаты в кольцо в
+ * разделяемой памяти. Поток-потребитель читает кольцо и считает задержку
+ * от дозаписи строки в файл (её receive_ts - системное время дозаписи в
+ * микросекундах, см. trade_generator) до появления результата.
+ */
+
+#ifndef PIPELINE_HARNESS_HPP
+#define PIPELINE_HARNESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "file_streamer.hpp"
+#include "latency_histogram.hpp"
+#include "median_calculator.hpp"
+#include "readers_manager.hpp"
+#include "shm_publisher.hpp"
+#include "shm_ring.hpp"
+#include "trade_generator.hpp"
+
+namespace app::bench {
+
+/**
+ * \brief Параметры конвейера
+ */
+struct harness_settings {
+    std::filesystem::path _output;                          ///< Файл результата
+    bool _streaming{false};                                 ///< Потоковый режим ридеров
+    std::size_t _shards{1};                                 ///< Шардов калькулятора
+    app::statistics::engine_settings _engine;               ///< Движок квантилей
+    app::processing::emission_settings _emission;           ///< Политика вывода
+    std::string _shm_name{"csv_median_harness"};            ///< Сегмент кольца результатов
+    std::size_t _shm_capacity{1 << 16};                     ///< Ячеек в кольце
+};
+
+/**
+ * \brief Запущенный конвейер над набором входных файлов
+ *
+ * До разрушения нужно вызвать finish(): в потоковом режиме ридеры иначе
+ * не остановятся.
+ */
+class pipeline_harness {
+public:
+    /**
+     * \brief Создаёт конвейер и ридеры файлов (ридеры сразу начинают чтение)
+     */
+    pipeline_harness(const harness_settings& settings_, const std::vector<std::string>& files_) noexcept(false)
+        : _streamer{std::make_shared<app::io::file_streamer>(settings_._output.string())}
+        , _readers{std::make_unique<app::io::readers_manager>(settings_._streaming)}
+        , _publisher{std::make_shared<app::io::shm_publisher>(app::io::publisher_settings{settings_._shm_name, settings_._shm_capacity})}
+        , _consumer{settings_._shm_name}
+    {
+        _calculator = app::processing::make_median_calculator(
+            _readers->tasks(), {}, _streamer, settings_._engine, {}, {}, settings_._emission, settings_._shards);
+        _calculator->publish_to(_publisher);
+        _listening = std::jthread{[this](std::stop_token stoken_) { listening(stoken_); }};
+        for (std::size_t i = 0; i < files_.size(); ++i) {
+            _readers->add_csv_file(files_[i], static_cast<std::uint32_t>(i));
+        }
+    }
+
+    // Запрет копирования
+    pipeline_harness(const pipeline_harness&) = delete;
+    pipeline_harness& operator=(const pipeline_harness&) = delete;
+
+    /**
+     * \brief Запускает воронку ридеров
+     */
+    void run() noexcept { _readers->run(); }
+
+    /**
+     * \brief Останавливает ридеры, дожидается обработки очереди и сброса вывода
+     */
+    void finish() noexcept(false)
+    {
+        _readers->stop();
+        // Калькулятор дорабатывает взятую пачку до конца, поэтому достаточно пустой очереди
+        while (!_readers->tasks()->empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        _calculator->stop();
+        _streamer->flush();
+        _listening.request_stop();
+        if (_listening.joinable()) {
+            _listening.join();
+        }
+    }
+
+    /**
+     * \brief Строк, прошедших через калькулятор
+     */
+    [[nodiscard]] std::size_t rows() const noexcept { return _readers->tasks()->total_count().load(); }
+
+    /**
+     * \brief Строк в очереди калькулятора сейчас
+     */
+    [[nodiscard]] std::size_t backlog() const noexcept { return _readers->tasks()->size(); }
+
+    /**
+     * \brief Задержка дозапись → результат, нс
+     */
+    [[nodiscard]] const app::processing::latency_histogram& latency() const noexcept { return _latency; }
+
+    /**
+     * \brief Задержка дозапись → результат с последнего reset_window(), нс
+     */
+    [[nodiscard]] const app::processing::latency_histogram& window_latency() const noexcept { return _window; }
+
+    /**
+     * \brief Начинает новое окно замера задержки
+     */
+    void reset_window() noexcept { _window.reset(); }
+
+    /**
+     * \brief Результатов, перезаписанных в кольце до чтения
+     */
+    [[nodiscard]] std::uint64_t lost() const noexcept { return _lost.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * \brief Поток-потребитель кольца результатов
+     */
+    void listening(std::stop_token stoken_) noexcept
+    {
+        app::io::shm::record record;
+        std::uint64_t next = 1;
+        while (!stoken_.stop_requested()) {
+            const auto published = _consumer.published();
+            if (published < next) {
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+                continue;
+            }
+            // Отставшие на целое кольцо записи уже перезаписаны
+            const auto capacity = _consumer.capacity();
+            if (published - next >= capacity) {
+                _lost.fetch_add(published - next + 1 - capacity, std::memory_order_relaxed);
+                next = published + 1 - capacity;
+            }
+            const auto now = trade_generator::wall_clock_us();
+            for (; next <= published; ++next) {
+                if (!_consumer.read(next, record)) {
+                    _lost.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                const auto latency = now - record._timestamp;
+                const auto nanoseconds = latency > 0 ? static_cast<std::uint64_t>(latency) * 1000 : 0;
+                _latency.record(nanoseconds);
+                _window.record(nanoseconds);
+            }
+        }
+    }
+
+private:
+    std::shared_ptr<app::io::file_streamer> _streamer;                  ///< Выходной файл
+    std::unique_ptr<app::io::readers_manager> _readers;                 ///< Ридеры и воронка
+    std::shared_ptr<app::io::shm_publisher> _publisher;                 ///< Кольцо результатов
+    app::io::shm::consumer _consumer;                                   ///< Читатель кольца
+    std::unique_ptr<app::processing::median_calculator> _calculator;    ///< Калькулятор
+    app::processing::latency_histogram _latency;                        ///< Задержка дозапись → результат, нс
+    app::processing::latency_histogram _window;                         ///< То же с последнего reset_window()
+    std::atomic<std::uint64_t> _lost{0};                                ///< Потерянные результаты
+    std::jthread _listening;                                            ///< Поток-потребитель
+};
+
+}  // namespace app::bench
+
+#endif  // PIPELINE_HARNESS_HPP
@@ -0,0 +1,218 @@
+/**
+ * \file process_stats.hpp
+ * \brief Ресурсы текущего процесса для бенчмарков (header-only)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef PROCESS_STATS_HPP
+#define PROCESS_STATS_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+    #include <psapi.h>
+    #include <tlhelp32.h>
+#else
+    #include <sys/resource.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+namespace app::bench {
+
+/**
+ * \brief Процессорное время процесса (user + system) в секундах
+ */
+[[nodiscard]] inline double cpu_seconds() noexcept
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    const auto ticks = [](const FILETIME& time_) {
+        return (static_cast<unsigned long long>(time_.dwHighDateTime) << 32) | time_.dwLowDateTime;
+    };
+    return static_cast<double>(ticks(kernel) + ticks(user)) * 1e-7;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+/**
+ * \brief Процессорное время вызывающего потока (user + system) в секундах
+ */
+[[nodiscard]] inline double thread_cpu_seconds() noexcept
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    const auto ticks = [](const FILETIME& time_) {
+        return (static_cast<unsigned long long>(time_.dwHighDateTime) << 32) | time_.dwLowDateTime;
+    };
+    return static_cast<double>(ticks(kernel) + ticks(user)) * 1e-7;
+#else
+    timespec time{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
+
+/**
+ * \brief Пиковый размер резидентной памяти процесса в байтах
+ */
+[[nodiscard]] inline std::size_t peak_rss() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    #ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss);
+    #else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+}
+
+/**
+ * \brief Текущий размер резидентной памяти процесса в байтах (0 - неизвестно)
+ */
+[[nodiscard]] inline std::size_t current_rss() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.WorkingSetSize;
+#elif defined(__linux__)
+    std::ifstream statm{"/proc/self/statm"};
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+/**
+ * \brief Резидентная память процесса без страниц отображённых файлов и разделяемой памяти, байт (0 - неизвестно)
+ *
+ * Страницы выходных сегментов file_streamer и кольца результатов тоже
+ * попадают в current_rss() и растут вместе с записанным; утечку в куче
+ * видно по этой величине.
+ */
+[[nodiscard]] inline std::size_t private_memory() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        return 0;
+    }
+    return counters.PrivateUsage;
+#elif defined(__linux__)
+    std::ifstream statm{"/proc/self/statm"};
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    std::size_t shared = 0;
+    if (!(statm >> size >> resident >> shared) || shared > resident) {
+        return 0;
+    }
+    return (resident - shared) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+/**
+ * \brief Количество потоков процесса (0 - неизвестно)
+ */
+[[nodiscard]] inline std::size_t thread_count() noexcept
+{
+#ifdef _WIN32
+    const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    std::size_t count = 0;
+    THREADENTRY32 entry{};
+    entry.dwSize = sizeof(entry);
+    for (BOOL found = Thread32First(snapshot, &entry); found; found = Thread32Next(snapshot, &entry)) {
+        count += entry.th32OwnerProcessID == GetCurrentProcessId();
+    }
+    CloseHandle(snapshot);
+    return count;
+#elif defined(__linux__)
+    std::ifstream status{"/proc/self/status"};
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("Threads:", 0) == 0) {
+            return static_cast<std::size_t>(std::strtoul(line.c_str() + 8, nullptr, 10));
+        }
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * \brief Количество отображений файлов и разделяемой памяти в адресном пространстве (0 - неизвестно)
+ *
+ * На Linux - все строки /proc/self/maps, на Windows - регионы MEM_MAPPED.
+ * Важна не абсолютная величина, а её рост со временем.
+ */
+[[nodiscard]] inline std::size_t mapping_count() noexcept
+{
+#ifdef _WIN32
+    std::size_t count = 0;
+    MEMORY_BASIC_INFORMATION info{};
+    const char* address = nullptr;
+    while (VirtualQuery(address, &info, sizeof(info)) == sizeof(info)) {
+        count += info.State == MEM_COMMIT && info.Type == MEM_MAPPED;
+        address = static_cast<const char*>(info.BaseAddress) + info.RegionSize;
+    }
+    return count;
+#elif defined(__linux__)
+    std::ifstream maps{"/proc/self/maps"};
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(maps, line)) {
+        ++count;
+    }
+    return count;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace app::bench
+
+#endif  // PROCESS_STATS_HPP
@@ -0,0 +1,251 @@
+/**
+ * \file quantile_bench.cpp
+ * \brief Сравнение движков квантилей по скорости, памяти и точности
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Прогоняет каждый движок по сгенерированным наборам данных и выводит
+ * вставки/сек, задержку запроса медианы, память и ошибку ранга
+ * относительно точного эталона.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "quantile_engine.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+namespace stats = app::statistics;
+
+constexpr std::int_fast64_t TS_STEP = 100;                  ///< Шаг receive_ts между строками (мкс)
+constexpr std::size_t QUERY_COUNT = 1000;                   ///< Количество замеров запроса медианы
+constexpr double CHECK_QUANTILES[] = {0.5, 0.9, 0.99};      ///< Квантили для оценки точности
+
+/**
+ * \brief Набор данных для прогона
+ */
+struct dataset {
+    std::string _name;                      ///< Имя набора
+    std::vector<double> _values;            ///< Значения
+};
+
+/**
+ * \brief Результат прогона одного движка по одному набору
+ */
+struct bench_result {
+    double _inserts_per_sec{0.0};           ///< Вставок в секунду
+    double _query_ns{0.0};                  ///< Средняя задержка median() в наносекундах
+    std::size_t _memory{0};                 ///< Память движка в байтах
+    double _rank_error{-1.0};               ///< Максимальная ошибка ранга (< 0 - не применимо)
+};
+
+/**
+ * \brief Генерирует наборы данных
+ */
+[[nodiscard]] std::vector<dataset> make_datasets(std::size_t rows_, std::uint32_t seed_)
+{
+    std::mt19937_64 rng{seed_};
+    std::vector<dataset> result;
+
+    // Случайное блуждание цены, как у генератора данных
+    {
+        std::normal_distribution<double> step{0.0, 0.1};
+        std::uniform_real_distribution<double> level{-0.6, 0.6};
+        dataset ds{"random_walk", {}};
+        ds._values.reserve(rows_);
+        double price = 68480.0;
+        for (std::size_t i = 0; i < rows_; ++i) {
+            price += step(rng);
+            ds._values.push_back(price + level(rng));
+        }
+        result.push_back(std::move(ds));
+    }
+
+    // То же блуждание на сетке тиков 0.01
+    {
+        dataset ds{"random_walk_ticks", result.front()._values};
+        for (auto& value : ds._values) {
+            value = std::round(value * 100.0) / 100.0;
+        }
+        result.push_back(std::move(ds));
+    }
+
+    // Нормальное распределение
+    {
+        std::normal_distribution<double> dist{100.0, 10.0};
+        dataset ds{"normal", {}};
+        ds._values.reserve(rows_);
+        for (std::size_t i = 0; i < rows_; ++i) {
+            ds._values.push_back(dist(rng));
+        }
+        result.push_back(std::move(ds));
+    }
+
+    // Тяжёлый хвост
+    {
+        std::lognormal_distribution<double> dist{0.0, 1.0};
+        dataset ds{"lognormal", {}};
+        ds._values.reserve(rows_);
+        for (std::size_t i = 0; i < rows_; ++i) {
+            ds._values.push_back(100.0 * dist(rng));
+        }
+        result.push_back(std::move(ds));
+    }
+
+    return result;
+}
+
+/**
+ * \brief Прогоняет движок Engine по набору данных
+ */
+template <stats::quantile_estimator Engine>
+[[nodiscard]] bench_result run_engine(const dataset& dataset_, const stats::engine_settings& settings_)
+{
+    bench_result result;
+    auto engine = stats::make_engine<Engine>(settings_);
+    const auto& values = dataset_._values;
+    const std::size_t warm = values.size() > QUERY_COUNT ? values.size() - QUERY_COUNT : 0;
+
+    // Вставки
+    const auto insert_start = clock_type::now();
+    for (std::size_t i = 0; i < warm; ++i) {
+        stats::insert(engine, values[i], static_cast<std::int_fast64_t>(i) * TS_STEP);
+    }
+    const std::chrono::duration<double> insert_time = clock_type::now() - insert_start;
+    result._inserts_per_sec = insert_time.count() > 0.0 ? static_cast<double>(warm) / insert_time.count() : 0.0;
+
+    // Запросы медианы вперемешку со вставками, как в калькуляторе
+    volatile double sink = 0.0;
+    std::chrono::nanoseconds query_time{0};
+    for (std::size_t i = warm; i < values.size(); ++i) {
+        stats::insert(engine, values[i], static_cast<std::int_fast64_t>(i) * TS_STEP);
+        const auto query_start = clock_type::now();
+        sink = engine.median();
+        query_time += clock_type::now() - query_start;
+    }
+    (void)sink;
+    const auto queries = values.size() - warm;
+    result._query_ns = queries ? static_cast<double>(query_time.count()) / static_cast<double>(queries) : 0.0;
+    result._memory = engine.memory_bytes();
+
+    // Эталон: все значения, для окна - только значения окна; у затухания эталона нет
+    if constexpr (std::is_same_v<Engine, stats::decayed_tdigest>) {
+        return result;
+    } else {
+        stats::exact_quantiles reference;
+        std::size_t first = 0;
+        if constexpr (std::is_same_v<Engine, stats::sliding_window>) {
+            // Окно вытесняет срезами, поэтому строк в нём от span до span + span / SLICES
+            first = values.size() - engine.size();
+        }
+        for (std::size_t i = first; i < values.size(); ++i) {
+            reference.add(values[i]);
+        }
+
+        double max_error = 0.0;
+        for (const double q : CHECK_QUANTILES) {
+            max_error = std::max(max_error, std::abs(reference.rank(engine.quantile(q)) - q));
+        }
+        result._rank_error = max_error;
+        return result;
+    }
+}
+
+/**
+ * \brief Печатает строку таблицы результатов
+ */
+void print_row(const std::string& dataset_, std::string_view engine_, const bench_result& result_)
+{
+    std::cout << std::left << std::setw(20) << dataset_
+              << std::setw(12) << engine_
+              << std::right << std::fixed
+              << std::setw(16) << std::setprecision(0) << result_._inserts_per_sec
+              << std::setw(14) << std::setprecision(1) << result_._query_ns
+              << std::setw(14) << result_._memory;
+    if (result_._rank_error < 0.0) {
+        std::cout << std::setw(14) << "-";
+    } else {
+        std::cout << std::setw(14) << std::setprecision(6) << result_._rank_error;
+    }
+    std::cout << '\n';
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа бенчмарка движков квантилей
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("rows", po::value<std::size_t>()->default_value(1'000'000), "Rows per dataset")
+        ("seed", po::value<std::uint32_t>()->default_value(42), "Random seed")
+        ("compression", po::value<std::size_t>()->default_value(100), "Digest compression")
+        ("tick-size", po::value<double>()->default_value(0.01), "Histogram tick size")
+        ("window-seconds", po::value<double>()->default_value(60.0), "Sliding window width")
+        ("half-life-seconds", po::value<double>()->default_value(300.0), "Decay half-life");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    stats::engine_settings settings;
+    settings._compression = vm["compression"].as<std::size_t>();
+    settings._tick_size = vm["tick-size"].as<double>();
+    settings._window_seconds = vm["window-seconds"].as<double>();
+    settings._half_life_seconds = vm["half-life-seconds"].as<double>();
+
+    const auto datasets = make_datasets(vm["rows"].as<std::size_t>(), vm["seed"].as<std::uint32_t>());
+    constexpr stats::engine_kind engines[] = {
+        stats::engine_kind::tdigest,
+        stats::engine_kind::merging,
+        stats::engine_kind::histogram,
+        stats::engine_kind::window,
+        stats::engine_kind::decayed,
+        stats::engine_kind::exact,
+    };
+
+    std::cout << std::left << std::setw(20) << "dataset"
+              << std::setw(12) << "engine"
+              << std::right
+              << std::setw(16) << "inserts/s"
+              << std::setw(14) << "median ns"
+              << std::setw(14) << "memory B"
+              << std::setw(14) << "rank error" << '\n';
+
+    for (const auto& ds : datasets) {
+        for (const auto kind : engines) {
+            settings._kind = kind;
+            const auto result = stats::with_engine(kind, [&]<typename Engine>(std::type_identity<Engine>) {
+                return run_engine<Engine>(ds, settings);
+            });
+            print_row(ds._name, stats::engine_name(kind), result);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file shm_latency_bench.cpp
+ * \brief Задержка доставки результатов через кольцо в разделяемой памяти
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Писатель публикует записи с меткой steady_clock вместо receive_ts,
+ * читатель в другом потоке через shm::consumer ждёт каждую следующую
+ * запись и считает задержку от публикации до чтения. Выводит перцентили
+ * задержки и число потерянных (перезаписанных до чтения) записей.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "shm_publisher.hpp"
+#include "shm_ring.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr double PERCENTILES[] = {0.5, 0.9, 0.99, 0.999};   ///< Выводимые перцентили задержки
+
+/**
+ * \brief Текущее время steady_clock в наносекундах
+ */
+[[nodiscard]] std::int64_t now_ns() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа бенчмарка кольца в разделяемой памяти
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("name", po::value<std::string>()->default_value("csv_median_shm_bench"), "Shared memory segment name")
+        ("records", po::value<std::size_t>()->default_value(1'000'000), "Records to publish")
+        ("capacity", po::value<std::size_t>()->default_value(4096), "Ring capacity")
+        ("columns", po::value<std::size_t>()->default_value(4), "Extra columns per record")
+        ("interval-ns", po::value<std::int64_t>()->default_value(1000), "Pause between records (0 - no pause)");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    const auto records = vm["records"].as<std::size_t>();
+    const auto interval = vm["interval-ns"].as<std::int64_t>();
+
+    app::io::publisher_settings settings;
+    settings._name = vm["name"].as<std::string>();
+    settings._capacity = vm["capacity"].as<std::size_t>();
+    app::io::shm_publisher publisher{settings};
+    app::io::shm::consumer consumer{settings._name};
+
+    std::vector<std::pair<std::string, double>> extra_values;
+    for (std::size_t i = 0; i < std::min(vm["columns"].as<std::size_t>(), app::io::shm::MAX_COLUMNS); ++i) {
+        extra_values.emplace_back("c" + std::to_string(i), static_cast<double>(i));
+    }
+
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(records);
+    std::size_t lost = 0;
+
+    // Читатель: ждёт каждую следующую запись и меряет задержку
+    std::jthread reader{[&] {
+        app::io::shm::record record;
+        std::uint64_t next = 1;
+        while (next <= records) {
+            const auto published = consumer.published();
+            if (published < next) {
+                continue;
+            }
+            if (consumer.read(next, record)) {
+                latencies.push_back(now_ns() - record._timestamp);
+            } else {
+                ++lost;
+            }
+            ++next;
+        }
+    }};
+
+    // Писатель: метка времени публикации вместо receive_ts
+    for (std::size_t i = 0; i < records; ++i) {
+        publisher.publish(now_ns(), static_cast<double>(i), extra_values);
+        if (interval > 0) {
+            const auto until = now_ns() + interval;
+            while (now_ns() < until) {
+            }
+        }
+    }
+    reader.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "records: " << records << ", read: " << latencies.size() << ", lost: " << lost << '\n';
+    if (latencies.empty()) {
+        return 0;
+    }
+    for (const double p : PERCENTILES) {
+        const auto index = std::min(latencies.size() - 1, static_cast<std::size_t>(p * static_cast<double>(latencies.size())));
+        std::cout << std::fixed << std::setprecision(1) << "p" << p * 100.0 << ": " << latencies[index] << " ns\n";
+    }
+    std::cout << "max: " << latencies.back() << " ns" << std::endl;
+
+    return 0;
+}
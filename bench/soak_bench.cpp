@@ -0,0 +1,296 @@
+/**
+ * \file soak_bench.cpp
+ * \brief Длительный прогон потокового режима с контролем дрейфа ресурсов
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Генератор дописывает в N файлов с заданным темпом, конвейер работает в
+ * потоковом режиме. Раз в --sample-interval снимаются резидентная память,
+ * число отображений, число потоков, очередь калькулятора и задержка
+ * дозапись → результат за окно. Первая выборка после прогрева - эталон;
+ * если любая следующая уходит от него дальше порога, прогон считается
+ * проваленным (код возврата 2). Итог печатается JSON-объектом.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "logger.hpp"
+#include "pipeline_harness.hpp"
+#include "process_stats.hpp"
+#include "trade_generator.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+/**
+ * \brief Параметры прогона и пороги дрейфа
+ */
+struct soak_settings {
+    std::size_t _files{16};                             ///< Входных файлов
+    double _rate{100'000.0};                            ///< Темп дозаписи, строк/с на все файлы
+    double _duration{600.0};                            ///< Длительность, с
+    double _warmup{60.0};                               ///< Прогрев до эталонной выборки, с
+    double _sample_interval{10.0};                      ///< Период выборок, с
+    std::chrono::milliseconds _tick{1};                 ///< Период дозаписи
+    double _max_rss_growth{0.25};                       ///< Допустимый рост приватной памяти (доля эталона)
+    double _max_latency_growth{2.0};                    ///< Допустимое отношение p99 окна к эталону
+    double _latency_floor_ms{250.0};                    ///< p99 ниже этого не считается дрейфом, мс
+    std::size_t _max_mapping_growth{16};                ///< Допустимый прирост числа отображений
+    std::size_t _max_thread_growth{0};                  ///< Допустимый прирост числа потоков
+    std::size_t _max_backlog{1'000'000};                ///< Допустимая длина очереди калькулятора
+    fs::path _work_dir;                                 ///< Директория временных файлов
+    app::bench::harness_settings _harness;              ///< Параметры конвейера
+};
+
+/**
+ * \brief Одна выборка
+ */
+struct sample {
+    double _time{0.0};                                  ///< Секунд от начала
+    std::size_t _rss{0};                                ///< Резидентная память, байт
+    std::size_t _private{0};                            ///< Резидентная память без отображений файлов, байт
+    std::size_t _mappings{0};                           ///< Отображений
+    std::size_t _threads{0};                            ///< Потоков
+    std::size_t _backlog{0};                            ///< Строк в очереди калькулятора
+    std::size_t _rows{0};                               ///< Строк обработано с начала
+    std::uint64_t _p99_ns{0};                           ///< p99 задержки за окно, нс
+    std::uint64_t _results{0};                          ///< Результатов за окно
+};
+
+/**
+ * \brief Снимает выборку и начинает новое окно задержки
+ */
+[[nodiscard]] sample take_sample(app::bench::pipeline_harness& harness_, double time_)
+{
+    sample result;
+    result._time = time_;
+    result._rss = app::bench::current_rss();
+    result._private = app::bench::private_memory();
+    result._mappings = app::bench::mapping_count();
+    result._threads = app::bench::thread_count();
+    result._backlog = harness_.backlog();
+    result._rows = harness_.rows();
+    result._p99_ns = harness_.window_latency().percentile(0.99);
+    result._results = harness_.window_latency().count();
+    harness_.reset_window();
+    return result;
+}
+
+/**
+ * \brief Проверяет выборку относительно эталона
+ * \return описания нарушенных порогов
+ */
+[[nodiscard]] std::vector<std::string> check_drift(const soak_settings& settings_, const sample& baseline_, const sample& sample_)
+{
+    std::vector<std::string> violations;
+    const auto at = [&sample_](const std::string& what_) {
+        std::ostringstream out;
+        out << "t=" << sample_._time << "s: " << what_;
+        return out.str();
+    };
+
+    // Страницы выходного файла растут вместе с записанным и утечкой не являются
+    if (baseline_._private && static_cast<double>(sample_._private) > static_cast<double>(baseline_._private) * (1.0 + settings_._max_rss_growth)) {
+        violations.push_back(at("private memory " + std::to_string(sample_._private) + " > baseline " + std::to_string(baseline_._private)));
+    }
+    if (sample_._mappings > baseline_._mappings + settings_._max_mapping_growth) {
+        violations.push_back(at("mappings " + std::to_string(sample_._mappings) + " > baseline " + std::to_string(baseline_._mappings)));
+    }
+    if (sample_._threads > baseline_._threads + settings_._max_thread_growth) {
+        violations.push_back(at("threads " + std::to_string(sample_._threads) + " > baseline " + std::to_string(baseline_._threads)));
+    }
+    if (sample_._backlog > settings_._max_backlog) {
+        violations.push_back(at("backlog " + std::to_string(sample_._backlog) + " rows"));
+    }
+    const auto latency_limit = std::max(static_cast<double>(baseline_._p99_ns) * settings_._max_latency_growth,
+                                        settings_._latency_floor_ms * 1e6);
+    if (static_cast<double>(sample_._p99_ns) > latency_limit) {
+        violations.push_back(at("p99 latency " + std::to_string(sample_._p99_ns / 1000) + " us > limit "
+                                + std::to_string(static_cast<std::uint64_t>(latency_limit / 1000.0)) + " us"));
+    }
+    return violations;
+}
+
+/**
+ * \brief Печатает выборку JSON-объектом
+ */
+void print_sample(std::ostream& out_, const sample& sample_)
+{
+    out_ << "{\"t\": " << sample_._time
+         << ", \"rss_bytes\": " << sample_._rss
+         << ", \"private_bytes\": " << sample_._private
+         << ", \"mappings\": " << sample_._mappings
+         << ", \"threads\": " << sample_._threads
+         << ", \"backlog\": " << sample_._backlog
+         << ", \"rows\": " << sample_._rows
+         << ", \"results\": " << sample_._results
+         << ", \"p99_us\": " << static_cast<double>(sample_._p99_ns) / 1000.0 << "}";
+}
+
+/**
+ * \brief Экранирует строку для JSON
+ */
+[[nodiscard]] std::string json_string(const std::string& value_)
+{
+    std::string result = "\"";
+    for (const char c : value_) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа длительного прогона
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    soak_settings settings;
+    std::string output;
+    std::size_t tick_ms = static_cast<std::size_t>(settings._tick.count());
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("files", po::value<std::size_t>(&settings._files)->default_value(settings._files), "Input files")
+        ("rate", po::value<double>(&settings._rate)->default_value(settings._rate), "Appended rows per second across all files")
+        ("duration", po::value<double>(&settings._duration)->default_value(settings._duration), "Run time in seconds")
+        ("warmup", po::value<double>(&settings._warmup)->default_value(settings._warmup), "Seconds before the baseline sample")
+        ("sample-interval", po::value<double>(&settings._sample_interval)->default_value(settings._sample_interval), "Seconds between samples")
+        ("tick-ms", po::value<std::size_t>(&tick_ms)->default_value(tick_ms), "Append period")
+        ("max-rss-growth", po::value<double>(&settings._max_rss_growth)->default_value(settings._max_rss_growth), "Allowed private memory growth as a fraction of the baseline")
+        ("max-latency-growth", po::value<double>(&settings._max_latency_growth)->default_value(settings._max_latency_growth), "Allowed ratio of window p99 to the baseline p99")
+        ("latency-floor-ms", po::value<double>(&settings._latency_floor_ms)->default_value(settings._latency_floor_ms), "p99 below this never counts as drift")
+        ("max-mapping-growth", po::value<std::size_t>(&settings._max_mapping_growth)->default_value(settings._max_mapping_growth), "Allowed growth of the mapping count")
+        ("max-thread-growth", po::value<std::size_t>(&settings._max_thread_growth)->default_value(settings._max_thread_growth), "Allowed growth of the thread count")
+        ("max-backlog", po::value<std::size_t>(&settings._max_backlog)->default_value(settings._max_backlog), "Allowed calculator queue length")
+        ("shards", po::value<std::size_t>(&settings._harness._shards)->default_value(1), "Calculator shards")
+        ("compression", po::value<std::size_t>(&settings._harness._engine._compression)->default_value(100), "Digest compression")
+        ("min-interval", po::value<std::int_fast64_t>(&settings._harness._emission._min_interval)->default_value(0), "Emission min interval in receive_ts units")
+        ("output", po::value<std::string>(&output), "Write JSON to this file instead of stdout");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+    settings._files = std::max<std::size_t>(settings._files, 1);
+    settings._tick = std::chrono::milliseconds{std::max<std::size_t>(tick_ms, 1)};
+    settings._sample_interval = std::max(settings._sample_interval, 0.1);
+
+    // Ридеры сообщают о каждом прочитанном файле; JSON в stdout должен остаться чистым
+    spdlog::set_level(spdlog::level::warn);
+
+    settings._work_dir = fs::temp_directory_path() / "csv_median_soak";
+    fs::create_directories(settings._work_dir);
+    settings._harness._output = settings._work_dir / "median.csv";
+    settings._harness._shm_name = "csv_median_soak";
+    settings._harness._streaming = true;
+
+    std::vector<std::string> files;
+    for (std::size_t i = 0; i < settings._files; ++i) {
+        const auto path = settings._work_dir / ("orders_" + std::to_string(i) + ".csv");
+        std::ofstream{path, std::ios::binary | std::ios::trunc} << app::bench::CSV_HEADER;
+        files.push_back(path.string());
+    }
+
+    std::vector<sample> samples;
+    std::vector<std::string> violations;
+    std::size_t written = 0;
+    try {
+        app::bench::pipeline_harness harness{settings._harness, files};
+        harness.run();
+
+        // Дозапись в отдельном потоке, чтобы выборки не сбивали темп
+        std::jthread generating{[&settings, &files, &written](std::stop_token stoken_) {
+            app::bench::stream_writer writer{files, settings._rate, 1};
+            while (!stoken_.stop_requested()) {
+                writer.append_due();
+                std::this_thread::sleep_for(settings._tick);
+            }
+            written = writer.totals()._rows;
+        }};
+
+        const auto start = clock_type::now();
+        const auto interval = std::chrono::duration<double>{settings._sample_interval};
+        auto next_sample = start + std::chrono::duration_cast<clock_type::duration>(interval);
+        std::optional<sample> baseline;
+
+        while (clock_type::now() - start < std::chrono::duration<double>{settings._duration}) {
+            std::this_thread::sleep_until(next_sample);
+            next_sample += std::chrono::duration_cast<clock_type::duration>(interval);
+
+            const std::chrono::duration<double> elapsed = clock_type::now() - start;
+            const auto current = take_sample(harness, elapsed.count());
+            samples.push_back(current);
+            print_sample(std::cerr, current);
+            std::cerr << std::endl;
+
+            if (!baseline) {
+                if (elapsed.count() >= settings._warmup) {
+                    baseline = current;
+                }
+                continue;
+            }
+            auto found = check_drift(settings, *baseline, current);
+            violations.insert(violations.end(), found.begin(), found.end());
+        }
+
+        generating.request_stop();
+        generating.join();
+        harness.finish();
+    } catch (const std::exception& e_) {
+        std::cerr << "Soak run failed: " << e_.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output, std::ios::trunc);
+    }
+    std::ostream& out = output.empty() ? std::cout : file;
+
+    out << "{\n  \"passed\": " << (violations.empty() ? "true" : "false")
+        << ",\n  \"written\": " << written
+        << ",\n  \"violations\": [";
+    for (std::size_t i = 0; i < violations.size(); ++i) {
+        out << (i ? ", " : "") << json_string(violations[i]);
+    }
+    out << "],\n  \"samples\": [";
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        out << (i ? ",\n    " : "\n    ");
+        print_sample(out, samples[i]);
+    }
+    out << "\n  ]\n}" << std::endl;
+
+    std::error_code ec;
+    fs::remove_all(settings._work_dir, ec);
+    return violations.empty() ? 0 : 2;
+}
@@ -0,0 +1,292 @@
+/**
+ * \file trade_generator.hpp
+ * \brief Генератор синтетических сделок в формате входных CSV (header-only)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Повторяет модель data_generation.py (блуждание цены с трендом и
+ * волатильностью, пачки из 3-12 заявок bid/ask вокруг цены), но пишет
+ * строки через std::to_chars в буфер вызывающего и не делает пауз, поэтому
+ * темп задаёт только вызывающий код.
+ */
+
+#ifndef TRADE_GENERATOR_HPP
+#define TRADE_GENERATOR_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace app::bench {
+
+constexpr std::string_view CSV_HEADER = "receive_ts;exchange_ts;price;quantity;side\n";    ///< Заголовок входного CSV
+constexpr std::size_t CHUNK_SIZE = 4 << 20;                 ///< Размер блока записи исторического файла
+constexpr std::int64_t MIN_BATCH_GAP_US = 50;               ///< Минимальный шаг exchange_ts между историческими пачками
+constexpr std::int64_t MAX_BATCH_GAP_US = 500;              ///< Максимальный шаг exchange_ts между историческими пачками
+
+/**
+ * \brief Генератор пачек сделок
+ */
+class trade_generator {
+public:
+    /**
+     * \brief Конструктор
+     * \param seed_ зерно генератора (разные файлы - разные зёрна)
+     * \param base_price_ начальная цена
+     */
+    explicit trade_generator(std::uint64_t seed_, double base_price_ = 68480.0)
+        : _rng{seed_}
+        , _price{base_price_}
+    {}
+
+    /**
+     * \brief Текущее системное время в микросекундах, как receive_ts у шлюза
+     */
+    [[nodiscard]] static std::int64_t wall_clock_us() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * \brief Дописывает одну пачку сделок с биржевой меткой exchange_ts_
+     *
+     * В отличие от data_generation.py receive_ts строк файла строго
+     * растёт (и внутри пачки, и между пачками с одной меткой), чтобы
+     * воронка readers_manager не отбрасывала их как пришедшие не по порядку.
+     * \return число дописанных строк
+     */
+    std::size_t append_batch(std::string& out_, std::int64_t exchange_ts_)
+    {
+        update_price();
+
+        const auto rows = std::uniform_int_distribution<std::size_t>{3, 12}(_rng);
+        _orders.clear();
+        for (std::size_t level = 1; _orders.size() < rows && level <= rows; ++level) {
+            for (const bool bid : {true, false}) {
+                if (_unit(_rng) > 0.3) {
+                    const double offset = static_cast<double>(level) * (0.05 + 0.15 * _unit(_rng));
+                    const double quantity = (0.005 + 0.025 * _unit(_rng)) * (1.0 + _unit(_rng));
+                    _orders.push_back({bid, bid ? _price - offset : _price + offset, quantity});
+                }
+            }
+        }
+        std::shuffle(_orders.begin(), _orders.end(), _rng);
+        _orders.resize(std::min(_orders.size(), rows));
+
+        const auto delay = std::uniform_int_distribution<std::int64_t>{1, 10}(_rng);
+        const auto first = std::max(exchange_ts_ + delay, _last_receive_ts + 1);
+        for (std::size_t i = 0; i < _orders.size(); ++i) {
+            _last_receive_ts = first + static_cast<std::int64_t>(i);
+            append_int(out_, _last_receive_ts);
+            out_ += ';';
+            append_int(out_, exchange_ts_);
+            out_ += ';';
+            append_fixed(out_, _orders[i]._price);
+            out_ += ';';
+            append_fixed(out_, _orders[i]._quantity);
+            out_ += _orders[i]._bid ? ";bid\n" : ";ask\n";
+        }
+        return _orders.size();
+    }
+
+    /**
+     * \brief Текущая цена рынка
+     */
+    [[nodiscard]] double price() const noexcept { return _price; }
+
+private:
+    /**
+     * \brief Заявка пачки
+     */
+    struct order {
+        bool _bid;              ///< Сторона
+        double _price;          ///< Цена
+        double _quantity;       ///< Объём
+    };
+
+    /**
+     * \brief Сдвигает цену с учётом тренда и волатильности
+     */
+    void update_price()
+    {
+        if (_unit(_rng) < 0.1) {
+            _trend = std::clamp(_trend + (_unit(_rng) - 0.5) * 0.4, -1.0, 1.0);
+        }
+        if (_unit(_rng) < 0.05) {
+            _volatility = 0.05 + 0.25 * _unit(_rng);
+        }
+        _price += _trend + (2.0 * _unit(_rng) - 1.0) * _volatility;
+    }
+
+    static void append_int(std::string& out_, std::int64_t value_)
+    {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value_);
+        out_.append(buffer, result.ptr);
+    }
+
+    static void append_fixed(std::string& out_, double value_)
+    {
+        char buffer[64];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value_, std::chars_format::fixed, 8);
+        out_.append(buffer, result.ptr);
+    }
+
+private:
+    std::mt19937_64 _rng;                                       ///< Генератор случайных чисел
+    std::uniform_real_distribution<double> _unit{0.0, 1.0};     ///< Равномерное [0, 1)
+    double _price;                                              ///< Текущая цена
+    double _trend{0.0};                                         ///< Тренд цены за пачку
+    double _volatility{0.1};                                    ///< Волатильность
+    std::int64_t _last_receive_ts{0};                           ///< receive_ts последней строки
+    std::vector<order> _orders;                                 ///< Заявки текущей пачки
+};
+
+/**
+ * \brief Объём записанного в файл
+ */
+struct written_totals {
+    std::size_t _rows{0};                                   ///< Строк
+    std::size_t _bytes{0};                                  ///< Байт
+};
+
+/**
+ * \brief Пишет исторический файл с заголовком до rows_ строк или bytes_ байт (0 - без ограничения)
+ * \param start_ts_ receive_ts первой пачки; у файлов с общим началом ряды перекрываются
+ * \throws std::runtime_error если файл не открывается
+ */
+inline written_totals write_history(
+    const std::filesystem::path& path_,
+    std::uint64_t seed_,
+    std::int64_t start_ts_,
+    std::size_t rows_,
+    std::size_t bytes_) noexcept(false)
+{
+    std::ofstream out{path_, std::ios::binary | std::ios::trunc};
+    if (!out) {
+        throw std::runtime_error{"Failed to open " + path_.string()};
+    }
+    trade_generator generator{seed_};
+    std::mt19937_64 rng{seed_};
+    std::uniform_int_distribution<std::int64_t> gap{MIN_BATCH_GAP_US, MAX_BATCH_GAP_US};
+
+    written_totals totals{0, CSV_HEADER.size()};
+    out << CSV_HEADER;
+
+    std::string chunk;
+    chunk.reserve(CHUNK_SIZE + 4096);
+    auto exchange_ts = start_ts_;
+    while ((!rows_ || totals._rows < rows_) && (!bytes_ || totals._bytes < bytes_)) {
+        chunk.clear();
+        while (chunk.size() < CHUNK_SIZE && (!rows_ || totals._rows < rows_)
+               && (!bytes_ || totals._bytes + chunk.size() < bytes_)) {
+            exchange_ts += gap(rng);
+            totals._rows += generator.append_batch(chunk, exchange_ts);
+        }
+        out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        totals._bytes += chunk.size();
+    }
+    return totals;
+}
+
+/**
+ * \brief Дозапись в набор файлов с заданным суммарным темпом
+ *
+ * Каждый вызов append_due() догоняет расписание rate строк/с от момента
+ * создания; receive_ts строк - системное время дозаписи в микросекундах.
+ */
+class stream_writer {
+public:
+    /**
+     * \brief Открывает файлы на дозапись; в новые и пустые пишет заголовок
+     * \throws std::runtime_error если файл не открывается
+     */
+    stream_writer(const std::vector<std::string>& files_, double rate_, std::uint64_t seed_) noexcept(false)
+        : _per_file{rate_ / static_cast<double>(std::max<std::size_t>(files_.size(), 1))}
+    {
+        for (std::size_t i = 0; i < files_.size(); ++i) {
+            const bool fresh = !std::filesystem::exists(files_[i]) || std::filesystem::file_size(files_[i]) == 0;
+            auto& file = _files.emplace_back(file_state{
+                std::ofstream{files_[i], std::ios::binary | std::ios::app},
+                trade_generator{seed_ + i},
+            });
+            if (!file._stream) {
+                throw std::runtime_error{"Failed to open " + files_[i]};
+            }
+            if (fresh) {
+                file._stream << CSV_HEADER;
+                file._stream.flush();
+                _totals._bytes += CSV_HEADER.size();
+            }
+        }
+    }
+
+    // Запрет копирования
+    stream_writer(const stream_writer&) = delete;
+    stream_writer& operator=(const stream_writer&) = delete;
+
+    /**
+     * \brief Дописывает строки, положенные по расписанию к текущему моменту
+     */
+    void append_due()
+    {
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _start;
+        const auto target = static_cast<std::size_t>(_per_file * elapsed.count());
+
+        // Вся пачка получает одну биржевую метку
+        for (auto& file : _files) {
+            _chunk.clear();
+            while (file._rows < target) {
+                file._rows += file._generator.append_batch(_chunk, trade_generator::wall_clock_us());
+            }
+            if (!_chunk.empty()) {
+                file._stream.write(_chunk.data(), static_cast<std::streamsize>(_chunk.size()));
+                file._stream.flush();
+                _totals._bytes += _chunk.size();
+            }
+        }
+    }
+
+    /**
+     * \brief Записано всего
+     */
+    [[nodiscard]] written_totals totals() const noexcept
+    {
+        auto totals = _totals;
+        for (const auto& file : _files) {
+            totals._rows += file._rows;
+        }
+        return totals;
+    }
+
+private:
+    /**
+     * \brief Файл и его генератор
+     */
+    struct file_state {
+        std::ofstream _stream;                              ///< Поток дозаписи
+        trade_generator _generator;                         ///< Генератор сделок файла
+        std::size_t _rows{0};                               ///< Записано строк
+    };
+
+    const std::chrono::steady_clock::time_point _start{std::chrono::steady_clock::now()};  ///< Начало расписания
+    double _per_file;                                       ///< Темп на файл, строк/с
+    std::vector<file_state> _files;                         ///< Файлы
+    written_totals _totals;                                 ///< Байты (строки считаются по файлам)
+    std::string _chunk;                                     ///< Буфер пачек
+};
+
+}  // namespace app::bench
+
+#endif  // TRADE_GENERATOR_HPP
@@ -0,0 +1,168 @@
+/**
+ * \file wait_bench.cpp
+ * \brief Задержка пробуждения и расход CPU в простое для стратегий ожидания очереди
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ *
+ * Для каждой стратегии потребитель в отдельном потоке забирает строки из
+ * data_queue через pop_batch. Производитель кладёт по одной строке с
+ * паузой между ними, так что потребитель каждый раз успевает уйти в
+ * ожидание; задержка - от push до получения строки. Затем очередь
+ * простаивает, и за это время меряется процессорное время процесса:
+ * сколько ядер съедает ожидание без данных.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "data_queue.hpp"
+#include "process_stats.hpp"
+#include "types.hpp"
+#include "wait_strategy.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using app::processing::wait_strategy;
+
+constexpr double PERCENTILES[] = {0.5, 0.9, 0.99};  ///< Выводимые перцентили задержки
+
+/**
+ * \brief Текущее время steady_clock в наносекундах
+ */
+[[nodiscard]] std::int64_t now_ns() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+/**
+ * \brief Результат одной стратегии
+ */
+struct wait_result {
+    std::vector<std::int64_t> _latencies;   ///< Задержки пробуждения, нс (отсортированы)
+    double _idle_cores{0.0};                ///< Ядер занято в простое
+};
+
+/**
+ * \brief Прогон одной стратегии
+ */
+[[nodiscard]] wait_result run(wait_strategy strategy_, std::size_t messages_, std::chrono::microseconds interval_,
+                              std::chrono::milliseconds idle_)
+{
+    auto queue = std::make_shared<app::processing::data_queue>();
+    queue->set_wait_strategy(strategy_);
+
+    wait_result result;
+    result._latencies.reserve(messages_);
+
+    std::jthread consumer{[&] {
+        std::vector<std::unique_ptr<data>> batch;
+        while (queue->pop_batch(batch, 1024) > 0) {
+            const auto now = now_ns();
+            for (const auto& row : batch) {
+                result._latencies.push_back(now - row->read_time);
+            }
+            batch.clear();
+        }
+    }};
+
+    // Задержка: по одной строке, потребитель между ними засыпает
+    for (std::size_t i = 0; i < messages_; ++i) {
+        std::this_thread::sleep_for(interval_);
+        auto row = std::make_unique<data>(static_cast<std::int_fast64_t>(i), 100.0);
+        row->read_time = now_ns();
+        queue->push(std::move(row));
+    }
+
+    // Простой: производитель спит, считается только ожидание потребителя
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    const auto cpu_start = app::bench::cpu_seconds();
+    const auto wall_start = clock_type::now();
+    std::this_thread::sleep_for(idle_);
+    const std::chrono::duration<double> wall = clock_type::now() - wall_start;
+    result._idle_cores = (app::bench::cpu_seconds() - cpu_start) / wall.count();
+
+    queue->stop();
+    consumer.join();
+    std::sort(result._latencies.begin(), result._latencies.end());
+    return result;
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Точка входа бенчмарка стратегий ожидания
+ */
+int main(int argc, char* argv[])
+{
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"};
+    desc.add_options()
+        ("help", "Show this help message")
+        ("strategy", po::value<std::vector<std::string>>()->multitoken(),
+            "Strategies to run: blocking, busy_spin, spin_yield, spin_park (default - all)")
+        ("messages", po::value<std::size_t>()->default_value(10'000), "Rows pushed one at a time")
+        ("interval-us", po::value<std::int64_t>()->default_value(200), "Pause between rows")
+        ("idle-ms", po::value<std::int64_t>()->default_value(1000), "Idle window for CPU measurement");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e_) {
+        std::cerr << e_.what() << '\n' << desc << std::endl;
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    std::vector<wait_strategy> strategies{
+        wait_strategy::blocking, wait_strategy::busy_spin, wait_strategy::spin_yield, wait_strategy::spin_park};
+    if (vm.count("strategy")) {
+        strategies.clear();
+        for (const auto& name : vm["strategy"].as<std::vector<std::string>>()) {
+            wait_strategy strategy{};
+            if (!app::processing::parse_wait_strategy(name, strategy)) {
+                std::cerr << "Unknown strategy: " << name << std::endl;
+                return 1;
+            }
+            strategies.push_back(strategy);
+        }
+    }
+
+    const auto messages = std::max<std::size_t>(vm["messages"].as<std::size_t>(), 1);
+    const std::chrono::microseconds interval{vm["interval-us"].as<std::int64_t>()};
+    const std::chrono::milliseconds idle{vm["idle-ms"].as<std::int64_t>()};
+
+    std::cout << std::left << std::setw(12) << "strategy";
+    for (const double p : PERCENTILES) {
+        std::cout << std::right << std::setw(12) << ("p" + std::to_string(static_cast<int>(p * 100.0)) + ", ns");
+    }
+    std::cout << std::setw(14) << "max, ns" << std::setw(14) << "idle cores" << '\n';
+
+    for (const auto strategy : strategies) {
+        const auto result = run(strategy, messages, interval, idle);
+        const auto& latencies = result._latencies;
+        std::cout << std::left << std::setw(12) << app::processing::wait_strategy_name(strategy) << std::right;
+        for (const double p : PERCENTILES) {
+            const auto index = std::min(latencies.size() - 1, static_cast<std::size_t>(p * static_cast<double>(latencies.size())));
+            std::cout << std::setw(12) << latencies[index];
+        }
+        std::cout << std::setw(14) << latencies.back() << std::setw(14) << std::fixed << std::setprecision(3)
+                  << result._idle_cores << std::endl;
+    }
+
+    return 0;
+}
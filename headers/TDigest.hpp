@@ -39,7 +39,31 @@ public:
      * \brief Добавляет значение в распределение
      * \param value_ значение для добавления
      */
-    void add(double value_) noexcept;
+    void add(double value_) noexcept { add_weighted(value_, 1.0); }
+
+    /**
+     * \brief Добавляет значение с весом
+     * \param value_ значение для добавления
+     * \param weight_ вес значения (> 0)
+     *
+     * Ограничение на вес центроида считается от суммарного веса,
+     * поэтому при весе 1 поведение совпадает с add(value_).
+     */
+    void add_weighted(double value_, double weight_) noexcept;
+
+    /**
+     * \brief Вливает центроиды другого дигеста и сжимает результат
+     */
+    void merge(const tdigest& other_) noexcept(false);
+
+    /**
+     * \brief Умножает веса всех центроидов на коэффициент
+     * \param factor_ коэффициент (> 0)
+     *
+     * Квантили от общего масштаба весов не зависят; используется
+     * для перенормировки при прямом затухании (forward decay).
+     */
+    void scale(double factor_) noexcept;
     
     /**
      * \brief Вычисляет квантиль распределения
@@ -50,10 +74,14 @@ public:
     [[nodiscard]] double quantile(double q_) const noexcept(false);
     
     /**
-     * \brief Вычисляет медиану распределения
-     * \return медианное значение
+     * \brief Вычисляет медиану распределения за O(1)
+     * \return медианное значение (совпадает с quantile(0.5))
+     * \throws std::runtime_error если дигест пуст
+     *
+     * Медианный центроид и вес центроидов левее него поддерживаются
+     * инкрементально при вставке и пересчитываются при сжатии.
      */
-    [[nodiscard]] double median() const noexcept { return quantile(0.5); }
+    [[nodiscard]] double median() const noexcept(false);
 
     /**
      * \brief Вычисляет mean
@@ -77,20 +105,25 @@ public:
      */
     [[nodiscard]] bool empty() const noexcept { return _total_count == 0; }
 
+    /**
+     * \brief Занимаемая память в байтах (центроиды и служебные поля)
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
 private:
     /**
      * \brief Центроид - кластер близких значений
      */
     struct centroid {
         double _mean;       ///< Среднее значение
-        std::size_t _count; ///< Количество точек в кластере
+        double _count;      ///< Вес кластера (количество точек для невзвешенных данных)
         
-        centroid(double mean_ = 0.0, std::size_t count_ = 0) noexcept;
+        centroid(double mean_ = 0.0, double count_ = 0.0) noexcept;
         
         /**
-         * \brief Добавляет значение в центроид
+         * \brief Добавляет значение с весом в центроид
          */
-        void add(double value_) noexcept;
+        void add(double value_, double weight_) noexcept;
         
         /**
          * \brief Сливает два центроида
@@ -113,6 +146,26 @@ private:
      */
     [[nodiscard]] std::size_t find_nearest_centroid(double value_) const noexcept;
 
+    /**
+     * \brief Суммарный вес центроидов левее index_ (от ближайшей опоры)
+     */
+    [[nodiscard]] double weight_before(std::size_t index_) const noexcept;
+
+    /**
+     * \brief Сдвигает медианный центроид к половине суммарного веса
+     */
+    void seek_median() noexcept;
+
+    /**
+     * \brief Заново находит медианный центроид (после сжатия)
+     */
+    void reset_median() noexcept;
+
+    /**
+     * \brief Значение квантиля q_ внутри центроида index_ с весом before_ левее
+     */
+    [[nodiscard]] double interpolate(std::size_t index_, double before_, double q_) const noexcept;
+
     /**
      * \brief Возвращает количество данных
      */
@@ -123,8 +176,14 @@ private:
     static constexpr double WEIGHT_MULTIPLIER = 4.0;
     
     std::size_t _compression;           ///< Параметр компрессии
+    std::size_t _compress_at;           ///< Число центроидов, при превышении которого сжимаем
     std::vector<centroid> _centroids;   ///< Вектор центроидов
     std::size_t _total_count{0};        ///< Общее количество точек
+    double _total_weight{0.0};          ///< Суммарный вес точек
+    double _unit_weight{1.0};           ///< Вес последней точки (вес одиночной точки)
+    double _weighted_sum{0.0};          ///< Сумма значений с весами (для mean за O(1))
+    std::size_t _median_index{0};       ///< Индекс центроида, содержащего медиану
+    double _median_before{0.0};         ///< Суммарный вес центроидов левее медианного
     double _min_value{MAX_DOUBLE};      ///< Минимальное значение
     double _max_value{-MAX_DOUBLE};     ///< Максимальное значение
 };
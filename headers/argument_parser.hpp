@@ -21,6 +21,7 @@ namespace app::cli {
  */
 struct parsing_result {
     bool _streaming_mode{false};
+    bool _calibrate{false};
     bool _show_help{false};
     std::string _config_file{"config.toml"};
     boost::program_options::variables_map _variables;
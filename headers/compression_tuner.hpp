@@ -0,0 +1,64 @@
+/**
+ * \file compression_tuner.hpp
+ * \brief Подбор компрессии T-Digest под допустимую ошибку ранга
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef COMPRESSION_TUNER_HPP
+#define COMPRESSION_TUNER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "quantile_engine.hpp"
+
+namespace app::statistics {
+
+/**
+ * \brief Параметры подбора (секция [calibration] конфига)
+ */
+struct tuning_settings {
+    std::vector<double> _quantiles{0.5};                ///< Проверяемые квантили
+    double _max_rank_error{0.001};                      ///< Допустимая ошибка ранга для каждого квантиля
+    std::size_t _sample_rows{200'000};                  ///< Строк выборки со всех файлов
+    std::size_t _min_compression{10};                   ///< Нижняя граница поиска
+    std::size_t _max_compression{1000};                 ///< Верхняя граница поиска
+};
+
+/**
+ * \brief Результат подбора
+ */
+struct tuning_result {
+    std::size_t _compression{0};                        ///< Выбранная компрессия
+    bool _met{false};                                   ///< Порог достигнут (иначе - верхняя граница)
+    std::vector<double> _rank_errors;                   ///< Наибольшая по точкам проверки ошибка ранга по квантилям settings._quantiles
+    std::size_t _memory_bytes{0};                       ///< Память одного движка после выборки
+    double _inserts_per_sec{0.0};                       ///< Вставок в секунду на выборке
+    std::size_t _sample_rows{0};                        ///< Строк в выборке
+    std::size_t _evaluations{0};                        ///< Проверенных значений компрессии
+};
+
+/**
+ * \brief Подбирает наименьшую компрессию, при которой ошибка ранга каждого квантиля не больше порога
+ *
+ * Движок прогоняется по выборке в её порядке, как в калькуляторе, и на
+ * каждой четверти выборки сравнивается с точным эталоном по уже вставленным
+ * значениям; порог должен выполняться во всех точках. Ошибка ранга -
+ * расстояние от q до диапазона рангов оценки (у цен на сетке тиков
+ * значение повторяется, и весь диапазон его рангов считается точным).
+ * Поиск - удвоение от нижней границы, затем бинарный поиск между последним
+ * непрошедшим и первым прошедшим значением.
+ * \param sample_ значения выборки
+ * \param engine_ параметры движка; поддерживаются tdigest и merging
+ * \throws std::invalid_argument если движок без компрессии, выборка пуста или границы некорректны
+ */
+[[nodiscard]] tuning_result tune_compression(
+    const std::vector<double>& sample_,
+    const engine_settings& engine_,
+    const tuning_settings& settings_) noexcept(false);
+
+}  // namespace app::statistics
+
+#endif  // COMPRESSION_TUNER_HPP
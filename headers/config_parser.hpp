@@ -16,6 +16,18 @@
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include "compression_tuner.hpp"
+#include "emission_policy.hpp"
+#include "file_streamer.hpp"
+#include "group_key.hpp"
+#include "memory_budget.hpp"
+#include "pipeline_metrics.hpp"
+#include "quantile_engine.hpp"
+#include "shm_publisher.hpp"
+#include "thread_placement.hpp"
+#include "trace.hpp"
+#include "wait_strategy.hpp"
+
 namespace app::config {
 
 using path = std::filesystem::path;
@@ -29,6 +41,20 @@ struct parsing_result {
     string_vector _csv_files;
     string_vector _csv_filename_mask;
     std::vector<std::string> _extra_values_name;
+    app::statistics::engine_settings _engine_settings;
+    app::statistics::tuning_settings _tuning_settings;
+    bool _auto_compression{false};
+    app::processing::group_settings _group_settings;
+    std::vector<std::string> _metrics;
+    app::processing::emission_settings _emission_settings;
+    std::size_t _shards{1};
+    app::io::output_settings _output_settings;
+    app::io::publisher_settings _publisher_settings;
+    app::processing::stats_settings _stats_settings;
+    app::processing::trace_settings _trace_settings;
+    app::processing::memory_settings _memory_settings;
+    app::processing::placement_settings _placement_settings;
+    app::processing::wait_settings _wait_settings;
     
     /**
      * \brief Проверяет, валидна ли конфигурация
@@ -9,13 +9,17 @@
 #ifndef CSV_READER_HPP
 #define CSV_READER_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 
 #include "data_queue.hpp"
+#include "memory_budget.hpp"
+#include "pipeline_metrics.hpp"
 
 namespace app::io {
 
@@ -36,14 +40,16 @@ public:
      * \brief Конструктор
      * \param filename_ путь к CSV файлу
      * \param tasks_ очередь для передачи прочитанных данных
+     * \param streamin_mode_ режим потокового чтения данных
+     * \param source_ индекс файла-источника для группировки
      * \throws boost::interprocess::interprocess_exception если файл не может быть открыт
      */
-    csv_reader(path_string filename_, data_queue_ptr tasks_, bool streamin_mode_);
+    csv_reader(path_string filename_, data_queue_ptr tasks_, bool streamin_mode_, std::uint32_t source_ = 0);
     
     /**
-     * \brief Деструктор
+     * \brief Деструктор - снимает отображение с учёта памяти
      */
-    ~csv_reader() = default;
+    ~csv_reader();
     
     // Запрет копирования
     csv_reader(const csv_reader&) = delete;
@@ -72,21 +78,23 @@ public:
     //  */
     [[nodiscard]] std::shared_ptr<app::processing::data_queue> local_queue() const noexcept { return _local_queue; };
 
-private:
-    /**
-     * \brief Обновляет memory-mapped region после изменения файла
-     * \param position_ текущая позиция для продолжения чтения
-     */
-    void refresh(std::size_t position_) noexcept(false);
-    
     /**
      * \brief Парсит одну строку CSV в структуру Data
+     *
+     * Не зависит от состояния ридера; открыт для бенчмарков.
      * \param line_ строка для парсинга
      * \return unique_ptr на Data или nullptr при ошибке
      */
     [[nodiscard]] static std::unique_ptr<class data> parse_line(
         const std::string& line_) noexcept;
 
+private:
+    /**
+     * \brief Обновляет memory-mapped region после изменения файла
+     * \param position_ текущая позиция для продолжения чтения
+     */
+    void refresh(std::size_t position_) noexcept(false);
+    
 private:
     file_mapping _mapping;      ///< Memory-mapped file
     mapped_region _region;      ///< Mapped region
@@ -97,9 +105,23 @@ private:
     data_queue_ptr _tasks;      ///< Очередь для результатов
     bool _existing_data_has_been_processed{true}; ///< Обработаны ли существующие данные
     bool _streaming_mode{false};///< Состояние streaming-mode (нужно ли ожидать новых данных)
+    std::uint32_t _source{0};   ///< Индекс файла-источника
     std::shared_ptr<app::processing::data_queue> _local_queue; ///< Локальная очередь ридера
+    app::processing::reader_counters* _counters{nullptr}; ///< Счётчики ридера в метриках конвейера
+    app::processing::memory_account* _mappings{nullptr};  ///< Учёт отображённых файлов
 };
 
+/**
+ * \brief Читает цены первых строк входного потока (выборка для подбора компрессии)
+ * \param files_ входные файлы; строки сливаются по receive_ts, как в воронке ридеров
+ * \param rows_ строк всего
+ * \return цены в порядке, в котором их увидит калькулятор; нераспознанные строки и заголовок пропускаются
+ * \throws std::runtime_error если файл не открывается
+ */
+[[nodiscard]] std::vector<double> read_price_sample(
+    const std::vector<std::string>& files_,
+    std::size_t rows_) noexcept(false);
+
 }  // namespace app::io
 
 #endif  // CSV_READER_HPP
\ No newline at end of file
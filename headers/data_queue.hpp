@@ -15,8 +15,10 @@
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <vector>
 
 #include "types.hpp"
+#include "wait_strategy.hpp"
 
 namespace app::processing {
 
@@ -57,13 +59,45 @@ public:
      * \return уникальный указатель на data (ждёт пока появится элемент или is_stopped())
      */
     std::unique_ptr<data> pop() noexcept(false);
+
+    /**
+     * \brief Извлекает все доступные задачи за один захват мьютекса (блокирующая версия)
+     * \param batch_ вектор, в конец которого добавляются задачи
+     * \param max_ предельное количество задач
+     * \return количество извлечённых задач (0 - очередь остановлена и пуста)
+     *
+     * После stop() досылает оставшиеся в очереди задачи, а не отбрасывает их.
+     */
+    std::size_t pop_batch(std::vector<std::unique_ptr<data>>& batch_, std::size_t max_) noexcept(false);
     
     /**
      * \brief Проверяет, пуста ли очередь
      * \return true если очередь пуста
      */
     [[nodiscard]] bool empty() const noexcept;
+
+    /**
+     * \brief Текущее количество задач в очереди (без блокировки, для учёта и метрик)
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _depth.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Наибольшая глубина очереди за всё время
+     */
+    [[nodiscard]] std::size_t high_water() const noexcept { return _high_water.load(std::memory_order_relaxed); }
     
+    /**
+     * \brief Задаёт способ ожидания в pop / pop_batch (до запуска потребителя)
+     */
+    void set_wait_strategy(wait_strategy strategy_) noexcept { _strategy = strategy_; }
+
+    /**
+     * \brief Подключает общий сигнал, по которому push будит потребителя нескольких очередей
+     *
+     * Вызывается до запуска производителя и потребителя.
+     */
+    void attach_signal(std::shared_ptr<wake_signal> signal_) noexcept { _signal = std::move(signal_); }
+
     /**
      * \brief Останавливает ожидание в pop
      */
@@ -84,12 +118,22 @@ public:
      */
     [[nodiscard]] std::atomic<std::size_t> total_count() const noexcept;
 
+private:
+    /**
+     * \brief Ждёт задач или остановки по стратегии _strategy (blocking ждёт на _condition)
+     */
+    void await_tasks() noexcept;
+
 private:
     std::queue<std::unique_ptr<data>> _tasks;        ///< Очередь задач
     mutable std::mutex _mutex;                       ///< Мьютекс для синхронизации
     std::condition_variable _condition;              ///< Condition variable для ожидания
     std::atomic<bool> _stopped{false};               ///< Флаг остановки
     std::atomic<std::size_t> _total_count{0};        ///< Обработанные задачи
+    std::atomic<std::size_t> _high_water{0};         ///< Наибольшая глубина (пишется под _mutex)
+    std::atomic<std::size_t> _depth{0};              ///< Текущая глубина (пишется под _mutex)
+    wait_strategy _strategy{wait_strategy::blocking}; ///< Способ ожидания потребителя
+    std::shared_ptr<wake_signal> _signal{std::make_shared<wake_signal>()}; ///< Сигнал о новых задачах
 };
 
 }  // namespace app::processing
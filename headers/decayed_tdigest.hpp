@@ -0,0 +1,101 @@
+/**
+ * \file decayed_tdigest.hpp
+ * \brief T-Digest с экспоненциальным затуханием (forward decay)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef DECAYED_TDIGEST_HPP
+#define DECAYED_TDIGEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tdigest.hpp"
+
+namespace app::statistics {
+
+/**
+ * \brief Квантили с затуханием по receive_ts и заданным периодом полураспада
+ *
+ * Прямое затухание: точка со временем t получает вес 2^((t - L) / half_life),
+ * где L — опорная метка. Общий множитель на квантили не влияет, поэтому
+ * старые точки не пересчитываются. Когда веса приближаются к пределу double,
+ * опорная метка сдвигается, а веса центроидов перенормируются за O(центроидов).
+ * Память и стоимость вставки те же, что у tdigest.
+ */
+class decayed_tdigest {
+public:
+    /**
+     * \brief Конструктор
+     * \param half_life_ период полураспада в единицах receive_ts
+     * \param compression_ параметр компрессии T-Digest
+     * \throws std::invalid_argument если half_life_ <= 0
+     */
+    explicit decayed_tdigest(double half_life_, std::size_t compression_ = 100);
+
+    /**
+     * \brief Добавляет значение с весом, зависящим от времени
+     * \param value_ значение для добавления
+     * \param timestamp_ receive_ts значения (не убывает от вызова к вызову)
+     */
+    void add(double value_, std::int_fast64_t timestamp_) noexcept;
+
+    /**
+     * \brief Вычисляет квантиль распределения с учётом затухания
+     * \param q_ квантиль от 0 до 1
+     * \throws std::invalid_argument если q_ вне [0,1]
+     */
+    [[nodiscard]] double quantile(double q_) const noexcept(false) { return _digest.quantile(q_); }
+
+    /**
+     * \brief Вычисляет медиану распределения с учётом затухания
+     */
+    [[nodiscard]] double median() const noexcept(false) { return _digest.median(); }
+
+    /**
+     * \brief Вычисляет mean
+     */
+    [[nodiscard]] double mean() const noexcept { return _digest.mean(); }
+
+    /**
+     * \brief Вычисляет extra_values (mean, p90, p95, p99)
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, double>> extra_values(std::vector<std::string> const values_name_) const noexcept
+    {
+        return _digest.extra_values(values_name_);
+    }
+
+    /**
+     * \brief Возвращает количество добавленных элементов
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _digest.size(); }
+
+    /**
+     * \brief Проверяет, пуст ли дигест
+     */
+    [[nodiscard]] bool empty() const noexcept { return _digest.empty(); }
+
+    /**
+     * \brief Занимаемая память в байтах
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept
+    {
+        return sizeof(*this) - sizeof(_digest) + _digest.memory_bytes();
+    }
+
+private:
+    static constexpr double RESCALE_EXPONENT = 256.0;   ///< Показатель веса, после которого сдвигаем опорную метку
+
+    tdigest _digest;                        ///< Дигест с весами
+    double _half_life;                      ///< Период полураспада в единицах receive_ts
+    std::int_fast64_t _landmark{0};         ///< Опорная метка L
+    bool _has_landmark{false};              ///< Установлена ли опорная метка
+};
+
+}  // namespace app::statistics
+
+#endif  // DECAYED_TDIGEST_HPP
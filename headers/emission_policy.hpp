@@ -0,0 +1,71 @@
+/**
+ * \file emission_policy.hpp
+ * \brief Политика вывода строк результата
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef EMISSION_POLICY_HPP
+#define EMISSION_POLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace app::processing {
+
+/**
+ * \brief Параметры вывода (секция [emission] конфига)
+ *
+ * Строка выводится, только если выполнены все условия одновременно.
+ */
+struct emission_settings {
+    std::int_fast64_t _min_interval{0};     ///< Минимальный интервал между строками в единицах receive_ts
+    double _abs_threshold{1e-10};           ///< Минимальное абсолютное изменение медианы
+    double _rel_threshold{0.0};             ///< Минимальное относительное изменение медианы (0 - не проверяется)
+    std::size_t _every{1};                  ///< Выводить не чаще, чем раз в _every обновлений
+    bool _coalesce_timestamps{true};        ///< Проверять вывод один раз на серию строк с одинаковым receive_ts
+    bool _conflate{false};                  ///< Схлопывать пачку строк из очереди до последнего значения
+    std::size_t _conflate_limit{4096};      ///< Предельная длина схлопываемой пачки
+};
+
+/**
+ * \brief Состояние политики вывода одного потока медиан
+ */
+class emission_state {
+public:
+    /**
+     * \brief Учитывает обновление медианы и решает, выводить ли строку
+     * \param settings_ параметры вывода
+     * \param timestamp_ receive_ts обновления
+     * \param median_ новое значение медианы
+     * \return true, если строку нужно вывести (состояние уже обновлено)
+     *
+     * Подавленное обновление запоминается до следующей строки или flush().
+     */
+    [[nodiscard]] bool should_emit(
+        const emission_settings& settings_,
+        std::int_fast64_t timestamp_,
+        double median_) noexcept;
+
+    /**
+     * \brief Отдаёт последнее подавленное обновление (конец потока или остановка)
+     * \param timestamp_ receive_ts подавленного обновления
+     * \param median_ его медиана
+     * \return true, если строку нужно вывести: медиана отличается от выведенной
+     */
+    [[nodiscard]] bool flush(std::int_fast64_t& timestamp_, double& median_) noexcept;
+
+private:
+    std::int_fast64_t _last_timestamp{0};   ///< receive_ts последней выведенной строки
+    double _last_median{0.0};               ///< Последняя выведенная медиана
+    std::size_t _updates{0};                ///< Обновлений с последней выведенной строки
+    std::int_fast64_t _pending_timestamp{0};///< receive_ts последнего подавленного обновления
+    double _pending_median{0.0};            ///< Медиана последнего подавленного обновления
+    bool _pending{false};                   ///< Есть подавленное обновление после выведенной строки
+    bool _emitted{false};                   ///< Выводилась ли строка
+};
+
+}  // namespace app::processing
+
+#endif  // EMISSION_POLICY_HPP
@@ -0,0 +1,113 @@
+/**
+ * \file exact_quantiles.hpp
+ * \brief Точные квантили по всем значениям (эталон)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef EXACT_QUANTILES_HPP
+#define EXACT_QUANTILES_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace app::statistics {
+
+/**
+ * \brief Точные квантили по всем значениям
+ *
+ * Эталон для оценки точности остальных движков. Память O(n): значения
+ * лежат в отсортированных блоках до 2 * BLOCK_SIZE, а дерево Фенвика
+ * по размерам блоков находит блок с заданным рангом. Вставка — O(BLOCK_SIZE
+ * + log n) амортизированно, квантиль и ранг — O(log n), поэтому запрос
+ * после каждой вставки не делает весь прогон квадратичным.
+ */
+class exact_quantiles {
+public:
+    /**
+     * \brief Конструктор
+     */
+    exact_quantiles() = default;
+
+    /**
+     * \brief Добавляет значение
+     */
+    void add(double value_) noexcept(false);
+
+    /**
+     * \brief Добавляет все значения другого распределения
+     */
+    void merge(const exact_quantiles& other_) noexcept(false);
+
+    /**
+     * \brief Вычисляет квантиль (линейная интерполяция между соседними рангами)
+     * \param q_ квантиль от 0 до 1
+     * \throws std::invalid_argument если q_ вне [0,1]
+     * \throws std::runtime_error если значений нет
+     */
+    [[nodiscard]] double quantile(double q_) const noexcept(false);
+
+    /**
+     * \brief Вычисляет медиану
+     */
+    [[nodiscard]] double median() const noexcept(false) { return quantile(0.5); }
+
+    /**
+     * \brief Вычисляет mean
+     */
+    [[nodiscard]] double mean() const noexcept;
+
+    /**
+     * \brief Доля значений, не превышающих value_ (ранг значения)
+     */
+    [[nodiscard]] double rank(double value_) const noexcept;
+
+    /**
+     * \brief Возвращает количество добавленных элементов
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    /**
+     * \brief Проверяет, пусто ли распределение
+     */
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+    /**
+     * \brief Все добавленные значения в порядке возрастания
+     */
+    [[nodiscard]] std::vector<double> values() const noexcept(false);
+
+    /**
+     * \brief Занимаемая память в байтах
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+private:
+    /**
+     * \brief Значение с рангом rank_ (от 0 до size() - 1)
+     */
+    [[nodiscard]] double select(std::size_t rank_) const noexcept;
+
+    /**
+     * \brief Количество значений в первых blocks_ блоках
+     */
+    [[nodiscard]] std::size_t count_before(std::size_t blocks_) const noexcept;
+
+    /**
+     * \brief Перестраивает дерево Фенвика по размерам блоков (после деления блока)
+     */
+    void rebuild_tree() noexcept;
+
+private:
+    static constexpr std::size_t BLOCK_SIZE = 1024;     ///< Размер половины блока после деления
+
+    std::vector<std::vector<double>> _blocks;   ///< Отсортированные блоки; блоки упорядочены между собой
+    std::vector<std::size_t> _tree;             ///< Дерево Фенвика по размерам блоков (1-индексация)
+    std::size_t _size{0};                       ///< Количество значений
+    double _sum{0.0};                           ///< Сумма значений
+};
+
+}  // namespace app::statistics
+
+#endif  // EXACT_QUANTILES_HPP
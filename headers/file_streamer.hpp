@@ -9,20 +9,74 @@
 #ifndef FILE_STREAMER_HPP
 #define FILE_STREAMER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
+#include "memory_budget.hpp"
+#include "segment_writer.hpp"
 #include "types.hpp"
 
 namespace app::io {
 
+/**
+ * \brief Формат выходного файла
+ */
+enum class output_format {
+    csv,        ///< Текст, колонки через ';'
+    binary      ///< Записи фиксированной длины (см. median_binary.hpp)
+};
+
+/**
+ * \brief Параметры вывода (секция [output] конфига)
+ */
+struct output_settings {
+    output_format _format{output_format::csv};                  ///< Формат выходного файла
+    bool _delta_timestamps{false};                              ///< receive_ts разностями в varint (только binary)
+    std::size_t _buffer_size{1 << 20};                          ///< Размер буфера, после которого он уходит на запись (байт)
+    std::chrono::milliseconds _flush_interval{1000};            ///< Предельная задержка записи неполного буфера
+    std::size_t _rotate_size{0};                                ///< Размер сегмента, после которого начинается новый (0 - без ротации)
+    std::chrono::seconds _rotate_interval{0};                   ///< Время жизни сегмента (0 - без ротации по времени)
+
+    /**
+     * \brief Пишется ли вывод сегментами
+     */
+    [[nodiscard]] bool rotating() const noexcept { return _rotate_size > 0 || _rotate_interval.count() > 0; }
+};
+
+/**
+ * \brief Преобразует имя формата из конфига в output_format
+ * \param name_ имя формата ("csv" или "binary")
+ * \throws std::invalid_argument при неизвестном имени
+ */
+[[nodiscard]] output_format parse_output_format(std::string_view name_) noexcept(false);
+
+/**
+ * \brief Имя выходного файла для формата (median.csv или median.bin)
+ */
+[[nodiscard]] std::string_view output_filename(output_format format_) noexcept;
+
 /**
  * \brief Класс для записи результатов в CSV файл
  * 
- * Автоматически добавляет заголовок если файл пустой.
+ * Автоматически добавляет заголовок если файл пустой (двоичный файл
+ * перезаписывается при открытии и всегда начинается с заголовка). Строки форматируются
+ * через std::to_chars в буфер в памяти; заполненный буфер (или неполный -
+ * по истечении _flush_interval) меняется местами со вторым и записывается
+ * фоновым потоком, поэтому вызывающий поток не делает системных вызовов.
+ * При ротации вывод идёт в сегменты <имя>.NNNNNN<расширение>, каждый со
+ * своим заголовком; сегмент пишется через segment_writer и закрывается
+ * по размеру или времени на границе записи.
  * Потокобезопасность должна обеспечиваться вызывающим кодом.
  */
 class file_streamer {
@@ -32,53 +86,145 @@ public:
      * \param filename_ путь к выходному файлу
      * \throws std::runtime_error если файл не может быть открыт
      */
-    explicit file_streamer(std::string filename_);
+    explicit file_streamer(std::string filename_, const output_settings& settings_ = {});
     
     /**
-     * \brief Деструктор - автоматически закрывает файл
+     * \brief Деструктор - дописывает буферы и закрывает файл
      */
-    ~file_streamer() = default;
+    ~file_streamer();
     
     // Запрет копирования
     file_streamer(const file_streamer&) = delete;
     file_streamer& operator=(const file_streamer&) = delete;
     
-    // Разрешение перемещения
-    file_streamer(file_streamer&& other_) noexcept;
-    file_streamer& operator=(file_streamer&& other_) noexcept;
+    // Запрет перемещения (поток записи захватывает this)
+    file_streamer(file_streamer&&) = delete;
+    file_streamer& operator=(file_streamer&&) = delete;
     
     /**
      * \brief Записывает медианное значение
      * \param timestamp_ временная метка
      * \param median_ медианное значение
      * \return ссылка на себя для chaining
+     * \throws std::runtime_error если фоновая запись в файл не удалась
      */
     file_streamer& write_median(
         std::int_fast64_t timestamp_,
         double median_,
         std::vector<std::pair<std::string, double>> const extra_values_) noexcept(false);
 
+    /**
+     * \brief Записывает медианное значение группы (с колонкой group)
+     * \param timestamp_ временная метка
+     * \param group_ имя группы
+     * \param median_ медианное значение
+     * \return ссылка на себя для chaining
+     * \throws std::runtime_error в двоичном формате (группы не поддерживаются)
+     */
+    file_streamer& write_group_median(
+        std::int_fast64_t timestamp_,
+        std::string_view group_,
+        double median_,
+        std::vector<std::pair<std::string, double>> const& extra_values_) noexcept(false);
+
     /**
      * \brief Возвращает количество добавленных записей
      */
     std::size_t total_records() const noexcept;
     
     /**
-     * \brief Принудительно сбрасывает буфер на диск
+     * \brief Принудительно сбрасывает буфер на диск (дожидается записи)
      */
     void flush() noexcept;
 
 private:
     /**
-     * \brief Записывает заголовок если файл пустой
+     * \brief Формирует заголовок и пишет его, если файл пустой или вывод идёт сегментами
+     */
+    void write_header_if_needed(std::vector<std::pair<std::string, double>> const extra_values_name_, bool grouped_ = false) noexcept;
+
+    /**
+     * \brief Проверяет состояние файла перед записью строки
+     */
+    void check_stream() const noexcept(false);
+
+    /**
+     * \brief Дописывает число в заполняемый буфер (вызывать под _mutex)
+     */
+    void append(std::int_fast64_t value_) noexcept(false);
+
+    /**
+     * \brief Дописывает число с 8 знаками после запятой в заполняемый буфер (вызывать под _mutex)
+     */
+    void append(double value_) noexcept(false);
+
+    /**
+     * \brief Дописывает двоичную запись (вызывать под _mutex)
      */
-    void write_header_if_needed(std::vector<std::pair<std::string, double>> const extra_values_name_) noexcept;
+    void append_binary(
+        std::int_fast64_t timestamp_,
+        double median_,
+        std::vector<std::pair<std::string, double>> const& extra_values_) noexcept(false);
+
+    /**
+     * \brief Начинает запись: при необходимости закрывает сегмент и пишет заголовок
+     */
+    void begin_record(
+        std::unique_lock<std::mutex>& lock_,
+        std::vector<std::pair<std::string, double>> const& extra_values_,
+        bool grouped_) noexcept(false);
+
+    /**
+     * \brief Завершает строку; отдаёт буфер на запись, если он заполнен
+     * \param start_ размер буфера до начала записи
+     */
+    void end_record(std::unique_lock<std::mutex>& lock_, std::size_t start_) noexcept(false);
+
+    /**
+     * \brief Отдаёт заполняемый буфер потоку записи (вызывать под _mutex)
+     * \param rotate_ закрыть текущий сегмент после записи буфера
+     */
+    void hand_off(std::unique_lock<std::mutex>& lock_, bool rotate_ = false) noexcept;
+
+    /**
+     * \brief Записывает буфер в файл или сегмент (поток записи)
+     */
+    void write_out(const std::string& buffer_) noexcept(false);
+
+    /**
+     * \brief Открывает следующий свободный сегмент (поток записи)
+     */
+    void open_segment() noexcept(false);
+
+    /**
+     * \brief Поток записи: пишет отданные буферы и по таймеру - неполный
+     */
+    void writing(std::stop_token stoken_) noexcept;
     
 private:
+    static constexpr std::size_t NUMBER_CHARS = 352;    ///< Запас под число в fixed (до 309 цифр и 8 знаков дроби)
+    static constexpr std::size_t TIME_SEGMENT_SIZE = 64 << 20;  ///< Предвыделение сегмента при ротации только по времени
+
     std::ofstream _file_stream;           ///< Файловый поток
-    std::string _filename;                ///< Имя файла для перемещения
+    std::string _filename;                ///< Имя файла
+    output_settings _settings;            ///< Параметры буферизации
     bool _header_written{false};          ///< Флаг записи заголовка
-    static std::size_t _total_records;    ///< Общее количество записей
+    std::string _header;                  ///< Заголовок (повторяется в каждом сегменте)
+    std::size_t _segment_bytes{0};        ///< Байт в текущем сегменте (с заголовком)
+    std::chrono::steady_clock::time_point _segment_start;   ///< Начало текущего сегмента
+    std::int_fast64_t _last_timestamp{0}; ///< receive_ts предыдущей записи (для разностей)
+    std::mutex _mutex;                    ///< Мьютекс обмена буферами
+    std::condition_variable_any _condition; ///< Отдан буфер / буфер записан
+    std::string _front;                   ///< Заполняемый буфер
+    std::string _back;                    ///< Буфер, который пишет поток записи
+    bool _back_ready{false};              ///< _back отдан на запись
+    bool _back_rotate{false};             ///< После _back закрыть сегмент
+    app::processing::memory_account* _memory{nullptr};  ///< Учёт памяти буферов
+    std::unique_ptr<segment_writer> _segment;   ///< Текущий сегмент (только поток записи)
+    std::size_t _segment_index{0};        ///< Номер последнего открытого сегмента
+    std::atomic<bool> _failed{false};     ///< Фоновая запись не удалась
+    static std::atomic<std::size_t> _total_records; ///< Общее количество записей (читается из потока метрик)
+    std::jthread _writing;                ///< Поток записи (последним: стартует после остальных полей)
 };
 
 // Перегрузки операторов для удобства (но лучше использовать write_median)
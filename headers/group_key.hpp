@@ -0,0 +1,70 @@
+/**
+ * \file group_key.hpp
+ * \brief Ключ группировки строк (сторона, файл-источник)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef GROUP_KEY_HPP
+#define GROUP_KEY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "types.hpp"
+
+namespace app::processing {
+
+/**
+ * \brief Параметры группировки (ключ group_by секции [calculator])
+ */
+struct group_settings {
+    bool _by_side{false};                   ///< Разделять bid и ask
+    bool _by_file{false};                   ///< Разделять файлы-источники (инструменты)
+    std::vector<std::string> _sources;      ///< Имена источников по индексу data::source
+    std::size_t _small_limit{64};           ///< Сколько значений ключ хранит точно до создания движка
+
+    /**
+     * \brief Включена ли группировка
+     */
+    [[nodiscard]] bool enabled() const noexcept { return _by_side || _by_file; }
+};
+
+/**
+ * \brief Добавляет измерение группировки по имени
+ * \param settings_ параметры группировки
+ * \param name_ "side", "file" или "instrument" (инструмент определяется файлом)
+ * \throws std::invalid_argument при неизвестном имени
+ */
+void add_group_dimension(group_settings& settings_, std::string_view name_) noexcept(false);
+
+/**
+ * \brief Ключ группы строки: индекс источника в старших битах, сторона в младшем байте
+ */
+[[nodiscard]] inline std::uint64_t group_key(const data& row_, const group_settings& settings_) noexcept
+{
+    std::uint64_t key = 0;
+    if (settings_._by_file) {
+        key = static_cast<std::uint64_t>(row_.source) << 8;
+    }
+    if (settings_._by_side) {
+        key |= static_cast<std::uint8_t>(row_.side);
+    }
+    return key;
+}
+
+/**
+ * \brief Имя группы для вывода ("bid", "trades_btc", "trades_btc/ask")
+ *
+ * Если имена файлов без расширения совпадают, к имени добавляется
+ * индекс источника ("orders#1/ask").
+ */
+[[nodiscard]] std::string group_label(std::uint64_t key_, const group_settings& settings_);
+
+}  // namespace app::processing
+
+#endif  // GROUP_KEY_HPP
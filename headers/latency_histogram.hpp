@@ -0,0 +1,84 @@
+/**
+ * \file latency_histogram.hpp
+ * \brief Гистограмма задержек с логарифмически-линейными корзинами (в духе HDR Histogram)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace app::processing {
+
+/**
+ * \brief Гистограмма неотрицательных значений (наносекунд) на весь диапазон uint64
+ *
+ * Каждая степень двойки делится на 2^SUB_BITS равных корзин, поэтому
+ * относительная погрешность перцентилей не больше 1/2^SUB_BITS (~3%).
+ * Запись - один relaxed-инкремент; читать можно из другого потока.
+ */
+class latency_histogram {
+public:
+    latency_histogram() = default;
+
+    // Запрет копирования
+    latency_histogram(const latency_histogram&) = delete;
+    latency_histogram& operator=(const latency_histogram&) = delete;
+
+    /**
+     * \brief Добавляет значение
+     */
+    void record(std::uint64_t value_) noexcept;
+
+    /**
+     * \brief Количество значений
+     */
+    [[nodiscard]] std::uint64_t count() const noexcept { return _count.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Максимальное значение
+     */
+    [[nodiscard]] std::uint64_t max() const noexcept { return _max.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Перцентиль q_ из [0, 1] (верхняя граница корзины; 0 - значений нет)
+     */
+    [[nodiscard]] std::uint64_t percentile(double q_) const noexcept;
+
+    /**
+     * \brief Обнуляет гистограмму (для замеров по окнам)
+     *
+     * Значения, записанные одновременно со сбросом, могут попасть в любое окно.
+     */
+    void reset() noexcept;
+
+private:
+    /**
+     * \brief Корзина значения
+     */
+    [[nodiscard]] static std::size_t index(std::uint64_t value_) noexcept;
+
+    /**
+     * \brief Наибольшее значение, попадающее в корзину
+     */
+    [[nodiscard]] static std::uint64_t upper_bound(std::size_t index_) noexcept;
+
+private:
+    static constexpr unsigned SUB_BITS = 5;                             ///< Двоичных разрядов точности
+    static constexpr std::size_t SUB_COUNT = std::size_t{1} << SUB_BITS;///< Корзин на степень двойки
+    static constexpr std::size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT; ///< Всего корзин
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> _buckets{};         ///< Счётчики корзин
+    std::atomic<std::uint64_t> _count{0};                               ///< Количество значений
+    std::atomic<std::uint64_t> _max{0};                                 ///< Максимальное значение
+};
+
+}  // namespace app::processing
+
+#endif  // LATENCY_HISTOGRAM_HPP
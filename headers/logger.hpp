@@ -9,6 +9,12 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
 #include "spdlog/spdlog.h"
 
 namespace app::processing {
@@ -47,6 +53,72 @@ private:
     logger& operator=(const logger&) = delete;  //< запрет на копирование
 };
 
+/**
+ * \brief Ограничитель частоты сообщений одного места вызова
+ *
+ * Пропускает не больше burst_ сообщений за окно window_, остальные
+ * считает. Без блокировок: на границе окна возможен лишний пропуск.
+ */
+class log_limiter {
+public:
+    /**
+     * \param burst_ сообщений за окно
+     * \param window_ длина окна
+     */
+    explicit log_limiter(std::uint32_t burst_ = 10, std::chrono::nanoseconds window_ = std::chrono::seconds{1}) noexcept
+        : _burst{burst_}
+        , _window{static_cast<std::uint64_t>(window_.count())}
+    {}
+
+    // Запрет копирования
+    log_limiter(const log_limiter&) = delete;
+    log_limiter& operator=(const log_limiter&) = delete;
+
+    /**
+     * \brief Можно ли писать сообщение
+     * \return число подавленных с прошлого пропуска или nullopt, если сообщение подавлено
+     */
+    [[nodiscard]] std::optional<std::uint64_t> acquire() noexcept
+    {
+        const auto now = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        auto start = _window_start.load(std::memory_order_relaxed);
+        if (now - start >= _window && _window_start.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            _in_window.store(0, std::memory_order_relaxed);
+        }
+        if (_in_window.fetch_add(1, std::memory_order_relaxed) < _burst) {
+            return _suppressed.exchange(0, std::memory_order_relaxed);
+        }
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+private:
+    std::uint32_t _burst;                           ///< Сообщений за окно
+    std::uint64_t _window;                          ///< Длина окна, нс
+    std::atomic<std::uint64_t> _window_start{0};    ///< Начало текущего окна, нс
+    std::atomic<std::uint32_t> _in_window{0};       ///< Сообщений в текущем окне
+    std::atomic<std::uint64_t> _suppressed{0};      ///< Подавлено с прошлого пропуска
+};
+
 }  // namespace app::processing
 
+/**
+ * \brief Сообщение с ограничением частоты по месту вызова
+ *
+ * У каждого места вызова свой log_limiter; число подавленных сообщений
+ * выводится со следующим пропущенным.
+ * \param level_ уровень spdlog::level
+ */
+#define LOG_LIMITED(level_, ...)                                                                    \
+    do {                                                                                            \
+        static ::app::processing::log_limiter log_limiter_;                                         \
+        if (const auto suppressed_ = log_limiter_.acquire()) {                                      \
+            if (*suppressed_) {                                                                     \
+                spdlog::log(level_, "... подавлено похожих сообщений: {}", *suppressed_);           \
+            }                                                                                       \
+            spdlog::log(level_, __VA_ARGS__);                                                       \
+        }                                                                                           \
+    } while (false)
+
 #endif  // LOGGER_HPP
\ No newline at end of file
@@ -0,0 +1,308 @@
+/**
+ * \file median_binary.hpp
+ * \brief Двоичный формат ряда медиан и чтение его через mmap (header-only)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Формат файла (все числа little-endian):
+ *   заголовок: MAGIC[8], u16 версия, u16 флаги, u32 число доп. колонок N,
+ *              u32 размер заголовка, затем N имён (u16 длина + байты),
+ *              дополнение нулями до кратного 8 размера;
+ *   запись:    i64 receive_ts, f64 median, N x f64 значения колонок.
+ * С флагом FLAG_DELTA_TIMESTAMPS receive_ts записи хранится как zigzag-varint
+ * разности с предыдущей записью (первая - с нулём), и записи читаются
+ * только последовательно.
+ */
+
+#ifndef MEDIAN_BINARY_HPP
+#define MEDIAN_BINARY_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace app::io::binary {
+
+constexpr char MAGIC[8] = {'M', 'E', 'D', 'I', 'A', 'N', 'B', '\0'};  ///< Сигнатура файла
+constexpr std::uint16_t VERSION = 1;                                ///< Версия формата
+constexpr std::uint16_t FLAG_DELTA_TIMESTAMPS = 1;                  ///< receive_ts как varint разности
+constexpr std::size_t FIXED_HEADER_SIZE = 20;                       ///< Заголовок без имён колонок
+constexpr std::size_t ALIGNMENT = 8;                                ///< Выравнивание начала записей
+
+// ==================== кодирование ====================
+
+/**
+ * \brief Дописывает беззнаковое число в little-endian
+ */
+template <std::unsigned_integral T>
+void put_le(std::string& out_, T value_)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out_ += static_cast<char>(static_cast<std::uint8_t>(value_ >> (8 * i)));
+    }
+}
+
+/**
+ * \brief Дописывает double как его 64-битное представление в little-endian
+ */
+inline void put_double(std::string& out_, double value_)
+{
+    put_le(out_, std::bit_cast<std::uint64_t>(value_));
+}
+
+/**
+ * \brief Дописывает знаковое число в zigzag-varint
+ */
+inline void put_varint(std::string& out_, std::int64_t value_)
+{
+    auto zigzag = (static_cast<std::uint64_t>(value_) << 1) ^ static_cast<std::uint64_t>(value_ >> 63);
+    while (zigzag >= 0x80) {
+        out_ += static_cast<char>(static_cast<std::uint8_t>(zigzag) | 0x80);
+        zigzag >>= 7;
+    }
+    out_ += static_cast<char>(static_cast<std::uint8_t>(zigzag));
+}
+
+/**
+ * \brief Дописывает заголовок файла
+ */
+inline void put_header(std::string& out_, const std::vector<std::string_view>& columns_, std::uint16_t flags_)
+{
+    const auto start = out_.size();
+    out_.append(MAGIC, sizeof(MAGIC));
+    put_le(out_, VERSION);
+    put_le(out_, flags_);
+    put_le(out_, static_cast<std::uint32_t>(columns_.size()));
+
+    std::size_t size = FIXED_HEADER_SIZE;
+    for (const auto column : columns_) {
+        size += sizeof(std::uint16_t) + column.size();
+    }
+    size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    put_le(out_, static_cast<std::uint32_t>(size));
+
+    for (const auto column : columns_) {
+        put_le(out_, static_cast<std::uint16_t>(column.size()));
+        out_ += column;
+    }
+    out_.resize(start + size, '\0');
+}
+
+// ==================== декодирование ====================
+
+/**
+ * \brief Читает беззнаковое число в little-endian
+ */
+template <std::unsigned_integral T>
+[[nodiscard]] T get_le(const std::byte* data_) noexcept
+{
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<T>(data_[i]) << (8 * i));
+    }
+    return value;
+}
+
+/**
+ * \brief Читает double из 64-битного little-endian представления
+ */
+[[nodiscard]] inline double get_double(const std::byte* data_) noexcept
+{
+    return std::bit_cast<double>(get_le<std::uint64_t>(data_));
+}
+
+/**
+ * \brief Одна запись ряда медиан
+ */
+struct record {
+    std::int64_t _timestamp{0};     ///< receive_ts
+    double _median{0.0};            ///< Медиана
+    std::vector<double> _values;    ///< Значения дополнительных колонок
+};
+
+/**
+ * \brief Просмотр двоичного файла медиан поверх готового буфера (например, mmap)
+ *
+ * Не владеет памятью. Без дельта-кодирования записи фиксированной длины
+ * и доступны по индексу; с ним - только последовательно через for_each.
+ */
+class median_view {
+public:
+    /**
+     * \brief Разбирает заголовок
+     * \throws std::runtime_error если буфер не является файлом медиан
+     */
+    explicit median_view(std::span<const std::byte> data_) noexcept(false)
+        : _data{data_}
+    {
+        if (_data.size() < FIXED_HEADER_SIZE || std::memcmp(_data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error{"Not a binary median file"};
+        }
+        if (get_le<std::uint16_t>(_data.data() + 8) != VERSION) {
+            throw std::runtime_error{"Unsupported binary median file version"};
+        }
+        _flags = get_le<std::uint16_t>(_data.data() + 10);
+        const auto columns = get_le<std::uint32_t>(_data.data() + 12);
+        _header_size = get_le<std::uint32_t>(_data.data() + 16);
+        if (_header_size > _data.size()) {
+            throw std::runtime_error{"Truncated binary median header"};
+        }
+
+        std::size_t offset = FIXED_HEADER_SIZE;
+        _columns.reserve(columns);
+        for (std::uint32_t i = 0; i < columns; ++i) {
+            if (offset + sizeof(std::uint16_t) > _header_size) {
+                throw std::runtime_error{"Truncated binary median header"};
+            }
+            const auto length = get_le<std::uint16_t>(_data.data() + offset);
+            offset += sizeof(std::uint16_t);
+            if (offset + length > _header_size) {
+                throw std::runtime_error{"Truncated binary median header"};
+            }
+            _columns.emplace_back(reinterpret_cast<const char*>(_data.data() + offset), length);
+            offset += length;
+        }
+    }
+
+    /**
+     * \brief Имена дополнительных колонок (без receive_ts и median)
+     */
+    [[nodiscard]] const std::vector<std::string>& columns() const noexcept { return _columns; }
+
+    /**
+     * \brief Хранится ли receive_ts разностями
+     */
+    [[nodiscard]] bool delta_timestamps() const noexcept { return _flags & FLAG_DELTA_TIMESTAMPS; }
+
+    /**
+     * \brief Размер записи фиксированной длины в байтах
+     */
+    [[nodiscard]] std::size_t record_size() const noexcept { return sizeof(double) * (2 + _columns.size()); }
+
+    /**
+     * \brief Количество полных записей (только без дельта-кодирования)
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return delta_timestamps() ? 0 : (_data.size() - _header_size) / record_size();
+    }
+
+    /**
+     * \brief receive_ts записи index_ (только без дельта-кодирования)
+     */
+    [[nodiscard]] std::int64_t timestamp(std::size_t index_) const noexcept
+    {
+        return static_cast<std::int64_t>(get_le<std::uint64_t>(at(index_)));
+    }
+
+    /**
+     * \brief Значение записи index_: 0 - медиана, i - колонка columns()[i - 1]
+     */
+    [[nodiscard]] double value(std::size_t index_, std::size_t column_) const noexcept
+    {
+        return get_double(at(index_) + sizeof(double) * (1 + column_));
+    }
+
+    /**
+     * \brief Вызывает func_(const record&) для каждой полной записи по порядку
+     */
+    template <typename Func>
+    void for_each(Func&& func_) const
+    {
+        record current;
+        current._values.resize(_columns.size());
+        const std::byte* position = _data.data() + _header_size;
+        const std::byte* const end = _data.data() + _data.size();
+        const std::size_t values_size = sizeof(double) * (1 + _columns.size());
+
+        while (position < end) {
+            if (delta_timestamps()) {
+                std::uint64_t zigzag = 0;
+                std::size_t shift = 0;
+                while (position < end && shift < 64) {
+                    const auto byte = static_cast<std::uint8_t>(*position++);
+                    zigzag |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                    shift += 7;
+                    if (!(byte & 0x80)) {
+                        break;
+                    }
+                }
+                current._timestamp += static_cast<std::int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+            } else {
+                if (static_cast<std::size_t>(end - position) < sizeof(std::uint64_t)) {
+                    return;
+                }
+                current._timestamp = static_cast<std::int64_t>(get_le<std::uint64_t>(position));
+                position += sizeof(std::uint64_t);
+            }
+
+            // Недописанный хвост (запись идёт прямо сейчас) пропускаем
+            if (static_cast<std::size_t>(end - position) < values_size) {
+                return;
+            }
+            current._median = get_double(position);
+            for (std::size_t i = 0; i < current._values.size(); ++i) {
+                current._values[i] = get_double(position + sizeof(double) * (1 + i));
+            }
+            position += values_size;
+            func_(static_cast<const record&>(current));
+        }
+    }
+
+private:
+    [[nodiscard]] const std::byte* at(std::size_t index_) const noexcept
+    {
+        return _data.data() + _header_size + index_ * record_size();
+    }
+
+private:
+    std::span<const std::byte> _data;       ///< Содержимое файла
+    std::uint16_t _flags{0};                ///< Флаги формата
+    std::size_t _header_size{0};            ///< Размер заголовка с выравниванием
+    std::vector<std::string> _columns;      ///< Имена дополнительных колонок
+};
+
+/**
+ * \brief Двоичный файл медиан, отображённый в память только для чтения
+ */
+class median_file {
+public:
+    /**
+     * \brief Отображает файл и разбирает заголовок
+     * \throws boost::interprocess::interprocess_exception если файл не открывается
+     * \throws std::runtime_error если файл не является файлом медиан
+     */
+    explicit median_file(const std::string& filename_) noexcept(false)
+        : _mapping{filename_.c_str(), boost::interprocess::read_only}
+        , _region{_mapping, boost::interprocess::read_only}
+        , _view{{static_cast<const std::byte*>(_region.get_address()), _region.get_size()}}
+    {}
+
+    // Запрет копирования (просмотр указывает в отображение)
+    median_file(const median_file&) = delete;
+    median_file& operator=(const median_file&) = delete;
+
+    /**
+     * \brief Просмотр содержимого
+     */
+    [[nodiscard]] const median_view& view() const noexcept { return _view; }
+
+private:
+    boost::interprocess::file_mapping _mapping;     ///< Отображение файла
+    boost::interprocess::mapped_region _region;     ///< Отображённая область
+    median_view _view;                              ///< Просмотр поверх _region
+};
+
+}  // namespace app::io::binary
+
+#endif  // MEDIAN_BINARY_HPP
@@ -1,6 +1,6 @@
 /**
  * \file median_calculator.hpp
- * \brief Вычисление медианы потока данных с использованием T-Digest
+ * \brief Вычисление медианы потока данных с использованием движков квантилей
  * \author github: Sobig-F
  * \date 2026-02-15
  * \version 1.0
@@ -10,77 +10,492 @@
 #define MEDIAN_CALCULATOR_HPP
 
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
+
+#include <boost/unordered/unordered_flat_map.hpp>
 
 #include "data_queue.hpp"
+#include "emission_policy.hpp"
 #include "file_streamer.hpp"
-#include "tdigest.hpp"
+#include "group_key.hpp"
+#include "memory_budget.hpp"
+#include "metric_expression.hpp"
+#include "quantile_engine.hpp"
+#include "quantile_estimator.hpp"
+#include "running_moments.hpp"
+#include "shm_publisher.hpp"
 
 namespace app::processing {
 
 /**
  * \brief Класс для вычисления медианы в реальном времени
  * 
- * Получает данные из очереди, обновляет T-Digest и выводит
- * медиану при её значительном изменении.
+ * Получает данные из очереди, обновляет движок квантилей и выводит
+ * медиану при её значительном изменении. Движок выбирается в конфиге
+ * и фиксируется типом наследника basic_median_calculator; виртуальны
+ * только управляющие методы, горячий цикл диспетчеризации не содержит.
  */
 class median_calculator {
 public:
     /**
-     * \brief Конструктор
-     * \param tasks_ очередь с входными данными
-     * \param digest_compression_ компрессия для T-Digest (по умолчанию 25)
-     */
-    explicit median_calculator(
-        std::shared_ptr<data_queue> tasks_,
-        std::vector<std::string> extra_values_ = {},
-        std::shared_ptr<app::io::file_streamer> file_streamer_ = nullptr,
-        std::size_t digest_compression_ = 25);
-    
-    /**
-     * \brief Деструктор - останавливает обработку
+     * \brief Деструктор
      */
-    ~median_calculator();
+    virtual ~median_calculator() = default;
     
     // Запрет копирования
     median_calculator(const median_calculator&) = delete;
     median_calculator& operator=(const median_calculator&) = delete;
     
-    // Разрешение перемещения
-    median_calculator(median_calculator&& other_) noexcept;
-    median_calculator& operator=(median_calculator&& other_) noexcept;
+    // Запрет перемещения (поток калькулятора захватывает this)
+    median_calculator(median_calculator&&) = delete;
+    median_calculator& operator=(median_calculator&&) = delete;
 
-    void stop() noexcept;
+    /**
+     * \brief Останавливает поток калькулятора
+     */
+    virtual void stop() noexcept = 0;
 
-private:
     /**
-     * \brief Внутренний метод обработки данных
+     * \brief Память, занимаемая движком квантилей (вызывать после stop())
      */
-    void calculating(std::stop_token stoken_) noexcept(false);
-    
+    [[nodiscard]] virtual std::size_t engine_memory() const noexcept = 0;
+
+    /**
+     * \brief Количество значений, прижатых движками к краю диапазона гистограммы (вызывать после stop())
+     */
+    [[nodiscard]] virtual std::uint64_t engine_clamped() const noexcept = 0;
+
+    /**
+     * \brief Подключает публикацию результатов в разделяемую память
+     *
+     * Публикуются строки без группировки; можно вызывать на работающем калькуляторе.
+     */
+    void publish_to(std::shared_ptr<app::io::shm_publisher> publisher_) noexcept;
+
+protected:
+    /**
+     * \brief Вид дополнительной выходной колонки
+     */
+    enum class stat_kind {
+        median,     ///< Медиана (для колонок метрик)
+        mean,       ///< Среднее значение по движку
+        quantile,   ///< Квантиль _quantile
+        count,      ///< Количество цен
+        sum,        ///< Сумма цен
+        min,        ///< Минимальная цена
+        max,        ///< Максимальная цена
+        variance,   ///< Дисперсия цены
+        stddev,     ///< Стандартное отклонение цены
+        vwap        ///< Средняя цена, взвешенная по объёму
+    };
+
+    /**
+     * \brief Дополнительная выходная колонка, разобранная из имени один раз
+     */
+    struct stat_column {
+        std::string _name;      ///< Имя колонки в заголовке
+        stat_kind _kind;        ///< Что считать
+        double _quantile{0.0};  ///< Квантиль для stat_kind::quantile
+        std::size_t _metric{0}; ///< 0 - цена, i - метрика _metrics[i - 1]
+    };
+
+    /**
+     * \brief Конструктор
+     * \param tasks_ очередь с входными данными
+     * \param extra_values_ имена дополнительных колонок (mean, pNN, count, sum, min, max, variance, stddev, vwap)
+     * \param file_streamer_ выходной поток (nullptr - вывод в консоль)
+     * \param metrics_ выражения дополнительных метрик (quantity, latency, price*quantity, ...)
+     * \param emission_settings_ политика вывода строк
+     * \throws std::invalid_argument при ошибке в выражении метрики
+     */
+    median_calculator(
+        std::shared_ptr<data_queue> tasks_,
+        std::vector<std::string> extra_values_,
+        std::shared_ptr<app::io::file_streamer> file_streamer_,
+        const std::vector<std::string>& metrics_,
+        const emission_settings& emission_settings_);
+
+    /**
+     * \brief Нужно ли отложить проверку вывода после строки batch_[index_]
+     *
+     * Откладывает внутри серии строк с одинаковым receive_ts и, при схлопывании,
+     * пока есть следующие строки в пачке или в очереди.
+     * \param batch_ текущая пачка строк
+     * \param index_ индекс только что обработанной строки
+     * \param burst_ счётчик схлопнутых строк (сбрасывается, когда проверка не откладывается)
+     */
+    [[nodiscard]] bool deferring(
+        const std::vector<std::unique_ptr<data>>& batch_,
+        std::size_t index_,
+        std::size_t& burst_) const noexcept;
+
     /**
      * \brief Выводит результат
+     * \param read_time_ момент чтения строки, вызвавшей вывод (для метрик задержки)
      */
     void output_result(
         std::int_fast64_t timestamp_,
         double median_,
-        std::vector<std::pair<std::string, double>> const extra_values_) noexcept(false);
+        std::vector<std::pair<std::string, double>> const extra_values_,
+        std::int_fast64_t read_time_) noexcept(false);
+
+    /**
+     * \brief Выводит результат группы
+     * \param read_time_ момент чтения строки, вызвавшей вывод (для метрик задержки)
+     */
+    void output_group_result(
+        std::int_fast64_t timestamp_,
+        std::string_view group_,
+        double median_,
+        std::vector<std::pair<std::string, double>> const& extra_values_,
+        std::int_fast64_t read_time_) noexcept(false);
+
+    /**
+     * \brief Обновляет учёт памяти движков раз в MEMORY_BATCHES пачек
+     *
+     * Вызывается потоком калькулятора, когда движки не меняют другие потоки.
+     * \param batches_ счётчик пачек потока калькулятора
+     */
+    void account_engines(std::size_t& batches_) noexcept;
+
+    /**
+     * \brief Передаёт число прижатых значений в метрики, при первом появлении - предупреждает
+     *
+     * Прижатые значения означают, что tick_size или max_pages не подходят к данным.
+     */
+    void report_clamped() noexcept;
+
+protected:
+    static constexpr std::size_t BATCH_SIZE = 1024;         ///< Предельный размер пачки из очереди
+    static constexpr std::size_t MEMORY_BATCHES = 64;       ///< Пачек между обновлениями учёта памяти движков
 
-private:
-    static constexpr double EPSILON = 1e-10;                ///< Порог изменения медианы
-    
-    std::unique_ptr<app::statistics::tdigest> _tdigest;     ///< T-Digest для оценки квантилей
     std::shared_ptr<data_queue> _tasks;                     ///< Входная очередь
     std::shared_ptr<app::io::file_streamer> _file_streamer; ///< Выходной поток
     std::mutex _output_mutex;                               ///< Мьютекс для вывода
-    std::vector<std::string> _extra_values_name;            ///< Вычисляемые values
-    std::jthread _calculating;                              ///< Поток калькулятора
-    mutable std::mutex _mutex;                              ///< Мьютекс для записи в файл
+    std::shared_ptr<app::io::shm_publisher> _publisher;     ///< Публикация в разделяемую память (под _output_mutex)
+    emission_settings _emission;                            ///< Политика вывода строк
+    std::vector<metric_expression> _metrics;                ///< Дополнительные метрики
+    std::vector<stat_column> _columns;                      ///< Дополнительные колонки
+    bool _with_moments{false};                              ///< Нужны ли колонки скользящих моментов
+    memory_account& _engines_memory;                        ///< Учёт памяти движков
+    bool _clamped_reported{false};                          ///< Предупреждение о прижатых значениях уже выведено
+};
+
+/**
+ * \brief Калькулятор медианы с движком, выбранным на этапе компиляции
+ */
+template <app::statistics::quantile_estimator Engine>
+class basic_median_calculator final : public median_calculator {
+public:
+    /**
+     * \brief Конструктор - создаёт движок и запускает поток калькулятора
+     * \param tasks_ очередь с входными данными
+     * \param extra_values_ имена дополнительных колонок
+     * \param file_streamer_ выходной поток (nullptr - вывод в консоль)
+     * \param engine_settings_ параметры движка квантилей
+     * \param metrics_ выражения дополнительных метрик
+     * \param emission_settings_ политика вывода строк
+     */
+    basic_median_calculator(
+        std::shared_ptr<data_queue> tasks_,
+        std::vector<std::string> extra_values_,
+        std::shared_ptr<app::io::file_streamer> file_streamer_,
+        const app::statistics::engine_settings& engine_settings_,
+        const std::vector<std::string>& metrics_ = {},
+        const emission_settings& emission_settings_ = {});
+
+    /**
+     * \brief Деструктор - останавливает обработку
+     */
+    ~basic_median_calculator() override;
+
+    void stop() noexcept override;
+
+    [[nodiscard]] std::size_t engine_memory() const noexcept override;
+
+    [[nodiscard]] std::uint64_t engine_clamped() const noexcept override;
+
+private:
+    /**
+     * \brief Внутренний метод обработки данных
+     */
+    void calculating(std::stop_token stoken_) noexcept(false);
+
+    /**
+     * \brief Выводит последнюю подавленную политикой медиану (конец потока или остановка)
+     */
+    void flush(emission_state& emission_, std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false);
+
+    /**
+     * \brief Значение дополнительной колонки по текущему состоянию движка
+     */
+    [[nodiscard]] double column_value(const stat_column& column_) const noexcept(false);
+
+private:
+    Engine _engine;                                         ///< Движок для оценки квантилей
+    std::vector<Engine> _metric_engines;                    ///< Движки метрик (по индексу _metrics)
+    app::statistics::running_moments _moments;              ///< Моменты цены по всему потоку
+    std::stop_source _stop_source;                          ///< Источник токена остановки потока калькулятора
+    std::jthread _calculating;                              ///< Поток калькулятора (последним: стартует после остальных полей)
+};
+
+/**
+ * \brief Калькулятор медиан по группам (сторона, файл-источник) за один проход
+ *
+ * Для каждого ключа группы хранит своё состояние в плоской хеш-таблице.
+ * Редкие ключи копят значения в маленьком точном буфере и получают
+ * полноценный движок только после _small_limit значений; для движков
+ * с временем (окно, затухание) движок создаётся сразу.
+ */
+template <app::statistics::quantile_estimator Engine>
+class grouped_median_calculator final : public median_calculator {
+public:
+    /**
+     * \brief Конструктор - запускает поток калькулятора
+     * \param tasks_ очередь с входными данными
+     * \param extra_values_ имена дополнительных колонок
+     * \param file_streamer_ выходной поток (nullptr - вывод в консоль)
+     * \param engine_settings_ параметры движка квантилей
+     * \param group_settings_ параметры группировки
+     * \param metrics_ выражения дополнительных метрик
+     * \param emission_settings_ политика вывода строк
+     */
+    grouped_median_calculator(
+        std::shared_ptr<data_queue> tasks_,
+        std::vector<std::string> extra_values_,
+        std::shared_ptr<app::io::file_streamer> file_streamer_,
+        const app::statistics::engine_settings& engine_settings_,
+        group_settings group_settings_,
+        const std::vector<std::string>& metrics_ = {},
+        const emission_settings& emission_settings_ = {});
+
+    /**
+     * \brief Деструктор - останавливает обработку
+     */
+    ~grouped_median_calculator() override;
+
+    void stop() noexcept override;
+
+    [[nodiscard]] std::size_t engine_memory() const noexcept override;
+
+    [[nodiscard]] std::uint64_t engine_clamped() const noexcept override;
+
+private:
+    /**
+     * \brief Распределение одной величины (цены или метрики) в группе
+     */
+    struct slot {
+        app::statistics::exact_quantiles _small;            ///< Значения, пока движка нет
+        std::unique_ptr<Engine> _engine;                    ///< Движок (создаётся для частых ключей)
+    };
+
+    /**
+     * \brief Состояние одной группы
+     */
+    struct group {
+        std::string _label;                                 ///< Имя группы для вывода
+        std::vector<slot> _slots;                           ///< Цена и метрики (индексы как у stat_column::_metric)
+        app::statistics::running_moments _moments;          ///< Моменты цены группы
+        emission_state _emission;                           ///< Состояние политики вывода группы
+        std::int_fast64_t _last_timestamp{0};               ///< receive_ts последней строки группы
+        std::int_fast64_t _last_read{0};                    ///< Момент чтения последней строки группы
+        bool _dirty{false};                                 ///< Обновлялась ли группа в текущей пачке
+    };
+
+    /**
+     * \brief Внутренний метод обработки данных
+     */
+    void calculating(std::stop_token stoken_) noexcept(false);
+
+    /**
+     * \brief Находит группу по ключу, создавая её при первом появлении ключа
+     * \return nullptr, если ключ новый, а бюджет памяти исчерпан движками
+     */
+    [[nodiscard]] group* find_group(std::uint64_t key_) noexcept(false);
+
+    /**
+     * \brief Выводит строку группы, если это разрешает политика вывода
+     */
+    void emit(group& group_, std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false);
+
+    /**
+     * \brief Выводит последние подавленные политикой медианы всех групп (конец потока или остановка)
+     */
+    void flush(std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false);
+
+    /**
+     * \brief Добавляет строку в группу
+     */
+    void add(group& group_, const data& row_) noexcept(false);
+
+    /**
+     * \brief Добавляет значение в распределение группы
+     * \param settings_ параметры движка этого распределения (для переноса из точного буфера)
+     */
+    void add(
+        slot& slot_,
+        const app::statistics::engine_settings& settings_,
+        double value_,
+        std::int_fast64_t timestamp_) noexcept(false);
+
+    /**
+     * \brief Вызывает func_ с текущим хранилищем распределения (движок или точный буфер)
+     */
+    template <typename Func>
+    static decltype(auto) visit(const slot& slot_, Func&& func_)
+    {
+        return slot_._engine ? func_(*slot_._engine) : func_(slot_._small);
+    }
+
+    /**
+     * \brief Значение дополнительной колонки группы
+     */
+    [[nodiscard]] double column_value(const group& group_, const stat_column& column_) const noexcept(false);
+
+private:
+    /// Маленький точный буфер нельзя переиграть в движок с временем
+    static constexpr bool SMALL_GROUPS = !app::statistics::timed_estimator<Engine>;
+
+    std::vector<app::statistics::engine_settings> _slot_settings; ///< Параметры движков по слотам (цена, затем метрики)
+    group_settings _group_settings;                         ///< Параметры группировки
+    boost::unordered_flat_map<std::uint64_t, group> _groups;///< Состояния групп по ключу
     std::stop_source _stop_source;                          ///< Источник токена остановки потока калькулятора
+    std::jthread _calculating;                              ///< Поток калькулятора (последним: стартует после остальных полей)
+};
+
+/**
+ * \brief Калькулятор медианы, распределяющий пачки по нескольким потокам
+ *
+ * Поток-координатор раздаёт пачки из очереди по кругу N шардам, у каждого
+ * свои движки и свой поток. В точке вывода (после полного круга или когда
+ * очередь опустела) координатор дожидается шардов, сливает их движки
+ * и выводит глобальную медиану - метки времени на выходе упорядочены.
+ */
+template <app::statistics::mergeable_estimator Engine>
+class sharded_median_calculator final : public median_calculator {
+public:
+    /**
+     * \brief Конструктор - создаёт шарды и запускает потоки
+     * \param tasks_ очередь с входными данными
+     * \param extra_values_ имена дополнительных колонок
+     * \param file_streamer_ выходной поток (nullptr - вывод в консоль)
+     * \param engine_settings_ параметры движка квантилей
+     * \param shards_ количество шардов (потоков вставки)
+     * \param metrics_ выражения дополнительных метрик
+     * \param emission_settings_ политика вывода строк
+     */
+    sharded_median_calculator(
+        std::shared_ptr<data_queue> tasks_,
+        std::vector<std::string> extra_values_,
+        std::shared_ptr<app::io::file_streamer> file_streamer_,
+        const app::statistics::engine_settings& engine_settings_,
+        std::size_t shards_,
+        const std::vector<std::string>& metrics_ = {},
+        const emission_settings& emission_settings_ = {});
+
+    /**
+     * \brief Деструктор - останавливает обработку
+     */
+    ~sharded_median_calculator() override;
+
+    void stop() noexcept override;
+
+    [[nodiscard]] std::size_t engine_memory() const noexcept override;
+
+    [[nodiscard]] std::uint64_t engine_clamped() const noexcept override;
+
+private:
+    using batch_type = std::vector<std::unique_ptr<data>>;
+
+    /**
+     * \brief Шард: свои движки и поток, вставляющий отданные ему пачки
+     */
+    struct shard {
+        std::vector<Engine> _engines;                       ///< Цена и метрики (индексы как у stat_column::_metric)
+        std::mutex _mutex;                                  ///< Мьютекс очереди пачек шарда
+        std::condition_variable_any _condition;             ///< Появление пачки / завершение обработки
+        std::vector<batch_type> _pending;                   ///< Пачки, ожидающие вставки
+        std::size_t _submitted{0};                          ///< Отдано пачек
+        std::size_t _done{0};                               ///< Вставлено пачек
+        std::jthread _thread;                               ///< Поток шарда
+    };
+
+    /**
+     * \brief Поток шарда: вставляет пачки в движки шарда
+     */
+    void inserting(shard& shard_, std::stop_token stoken_) noexcept(false);
+
+    /**
+     * \brief Поток координатора: раздаёт пачки и выводит результат
+     */
+    void calculating(std::stop_token stoken_) noexcept(false);
+
+    /**
+     * \brief Отдаёт пачку шарду
+     */
+    void submit(shard& shard_, batch_type batch_) noexcept(false);
+
+    /**
+     * \brief Дожидается всех шардов и сливает их движки в _merged
+     */
+    void merge_shards() noexcept(false);
+
+    /**
+     * \brief Выводит последнюю подавленную политикой медиану (конец потока или остановка)
+     * \param timestamp_ receive_ts последней отданной шардам пачки
+     * \param unmerged_ есть пачки, не попавшие в _merged (сбрасывается после слияния)
+     */
+    void flush(
+        emission_state& emission_,
+        std::int_fast64_t timestamp_,
+        bool& unmerged_,
+        std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false);
+
+    /**
+     * \brief Значение дополнительной колонки по слитым движкам
+     */
+    [[nodiscard]] double column_value(const stat_column& column_) const noexcept(false);
+
+private:
+    static constexpr std::size_t MAX_PENDING = 4;           ///< Предельное число невставленных пачек у шарда
+
+    app::statistics::engine_settings _engine_settings;      ///< Параметры движков
+    std::vector<std::unique_ptr<shard>> _shards;            ///< Шарды
+    std::vector<Engine> _merged;                            ///< Слитые движки последней точки вывода
+    app::statistics::running_moments _moments;              ///< Моменты цены по всему потоку
+    std::stop_source _stop_source;                          ///< Источник токена остановки координатора
+    std::jthread _calculating;                              ///< Поток координатора (последним: стартует после остальных полей)
 };
 
+/**
+ * \brief Создаёт калькулятор с движком из параметров
+ * \param tasks_ очередь с входными данными
+ * \param extra_values_ имена дополнительных колонок
+ * \param file_streamer_ выходной поток (nullptr - вывод в консоль)
+ * \param engine_settings_ параметры движка квантилей (по умолчанию T-Digest с компрессией 100)
+ * \param group_settings_ параметры группировки (по умолчанию без группировки)
+ * \param metrics_ выражения дополнительных метрик (по умолчанию только цена)
+ * \param emission_settings_ политика вывода строк (по умолчанию - при каждом изменении медианы)
+ * \param shards_ количество потоков вставки (больше 1 - только для сливаемых движков без группировки)
+ * \throws std::invalid_argument при некорректных параметрах движка или выражении метрики
+ */
+[[nodiscard]] std::unique_ptr<median_calculator> make_median_calculator(
+    std::shared_ptr<data_queue> tasks_,
+    std::vector<std::string> extra_values_ = {},
+    std::shared_ptr<app::io::file_streamer> file_streamer_ = nullptr,
+    const app::statistics::engine_settings& engine_settings_ = {},
+    group_settings group_settings_ = {},
+    const std::vector<std::string>& metrics_ = {},
+    const emission_settings& emission_settings_ = {},
+    std::size_t shards_ = 1) noexcept(false);
+
 }  // namespace app::processing
 
 #endif  // MEDIAN_CALCULATOR_HPP
\ No newline at end of file
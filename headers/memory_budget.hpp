@@ -0,0 +1,213 @@
+/**
+ * \file memory_budget.hpp
+ * \brief Учёт памяти по подсистемам и жёсткий бюджет с обратным давлением
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Каждая подсистема (очереди строк, движки квантилей, буферы записи,
+ * кольцо разделяемой памяти, отображения входных файлов) сообщает свой
+ * объём в именованный счётчик. Очереди не считаются поштучно: их объём -
+ * глубина, умноженная на стоимость строки, и читается без блокировок.
+ *
+ * При заданном бюджете ридеры перед очередной порцией строк вызывают
+ * admit(): пока очереди занимают больше, чем остаётся от бюджета после
+ * остальных подсистем, ридер ждёт, а не наращивает очередь. Данные при
+ * этом не теряются - непрочитанные строки остаются в файле.
+ *
+ * Память уже созданных движков бюджет не ограничивает: если движки сами
+ * заняли бюджет, калькулятор с группировкой перестаёт заводить новые
+ * группы и отбрасывает их строки (exhausted(), shed()).
+ */
+
+#ifndef MEMORY_BUDGET_HPP
+#define MEMORY_BUDGET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "data_queue.hpp"
+
+namespace app::processing {
+
+/**
+ * \brief Параметры бюджета памяти (секция [memory] конфига)
+ */
+struct memory_settings {
+    std::size_t _budget{0};                         ///< Жёсткий бюджет, байт (0 - без ограничения)
+
+    /**
+     * \brief Задан ли бюджет
+     */
+    [[nodiscard]] bool limited() const noexcept { return _budget > 0; }
+};
+
+/**
+ * \brief Счётчик памяти одной подсистемы
+ */
+class memory_account {
+public:
+    /**
+     * \param name_ имя подсистемы в статистике
+     * \param charged_ учитывается ли в бюджете
+     */
+    memory_account(std::string name_, bool charged_) noexcept
+        : _name{std::move(name_)}
+        , _charged{charged_}
+    {}
+
+    // Запрет копирования
+    memory_account(const memory_account&) = delete;
+    memory_account& operator=(const memory_account&) = delete;
+
+    /**
+     * \brief Задаёт текущий объём (для подсистем с одним писателем)
+     */
+    void set(std::size_t bytes_) noexcept
+    {
+        _bytes.store(bytes_, std::memory_order_relaxed);
+        raise_peak(bytes_);
+    }
+
+    /**
+     * \brief Изменяет объём на delta_ байт (для подсистем с несколькими писателями)
+     */
+    void add(std::int64_t delta_) noexcept
+    {
+        const auto bytes = _bytes.fetch_add(static_cast<std::size_t>(delta_), std::memory_order_relaxed)
+            + static_cast<std::size_t>(delta_);
+        raise_peak(bytes);
+    }
+
+    [[nodiscard]] const std::string& name() const noexcept { return _name; }
+    [[nodiscard]] bool charged() const noexcept { return _charged; }
+    [[nodiscard]] std::size_t bytes() const noexcept { return _bytes.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t peak() const noexcept { return _peak.load(std::memory_order_relaxed); }
+
+private:
+    void raise_peak(std::size_t bytes_) noexcept
+    {
+        auto peak = _peak.load(std::memory_order_relaxed);
+        while (bytes_ > peak && !_peak.compare_exchange_weak(peak, bytes_, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    std::string _name;                              ///< Имя подсистемы
+    bool _charged;                                  ///< Учитывается в бюджете
+    std::atomic<std::size_t> _bytes{0};             ///< Текущий объём, байт
+    std::atomic<std::size_t> _peak{0};              ///< Наибольший объём, байт
+};
+
+/**
+ * \brief Учёт памяти процесса и соблюдение бюджета
+ *
+ * Один на процесс, как pipeline_metrics. Счётчики и очереди
+ * регистрируются при создании подсистем; адреса счётчиков стабильны.
+ */
+class memory_budget {
+public:
+    /**
+     * \brief Оценка памяти одной строки в очереди: объект data, указатель в деке и заголовок блока кучи
+     */
+    static constexpr std::size_t ROW_BYTES = sizeof(data) + sizeof(std::unique_ptr<data>) + 16;
+
+    /**
+     * \brief Экземпляр процесса
+     */
+    [[nodiscard]] static memory_budget& instance() noexcept;
+
+    // Запрет копирования
+    memory_budget(const memory_budget&) = delete;
+    memory_budget& operator=(const memory_budget&) = delete;
+
+    /**
+     * \brief Задаёт бюджет
+     */
+    void configure(const memory_settings& settings_) noexcept;
+
+    /**
+     * \brief Счётчик подсистемы; повторный вызов с тем же именем возвращает тот же счётчик
+     * \param charged_ учитывается ли в бюджете (отображения файлов - нет: их страницы вытесняемы)
+     */
+    [[nodiscard]] memory_account& account(const std::string& name_, bool charged_ = true) noexcept(false);
+
+    /**
+     * \brief Учитывает очередь строк
+     */
+    void track_queue(std::shared_ptr<const data_queue> queue_) noexcept(false);
+
+    /**
+     * \brief Объём строк во всех очередях, байт
+     */
+    [[nodiscard]] std::size_t queued_bytes() const noexcept;
+
+    /**
+     * \brief Объём всех учитываемых в бюджете подсистем, кроме очередей, байт
+     */
+    [[nodiscard]] std::size_t charged_bytes() const noexcept;
+
+    /**
+     * \brief Ждёт, пока очереди не уложатся в свою долю бюджета
+     *
+     * Без бюджета возвращается сразу. Если остальные подсистемы сами
+     * превысили бюджет, очередям остаётся MIN_QUEUE_BYTES, чтобы конвейер
+     * не встал; об этом один раз пишется предупреждение.
+     */
+    void admit(std::stop_token stoken_) noexcept;
+
+    /**
+     * \brief Заняли ли подсистемы без очередей бюджет (очередям остаётся меньше MIN_QUEUE_BYTES)
+     *
+     * Без бюджета всегда false. Калькулятор не заводит новых групп, пока бюджет исчерпан.
+     */
+    [[nodiscard]] bool exhausted() const noexcept;
+
+    /**
+     * \brief Учитывает строки, отброшенные из-за исчерпания бюджета
+     */
+    void shed(std::uint64_t rows_ = 1) noexcept { _shed.fetch_add(rows_, std::memory_order_relaxed); }
+
+    /**
+     * \brief Фрагмент статистики в JSON (объект без завершающего перевода строки)
+     */
+    [[nodiscard]] std::string to_json() const noexcept(false);
+
+    /**
+     * \brief Пишет итог учёта памяти в лог
+     */
+    void log() const noexcept;
+
+private:
+    memory_budget() = default;
+
+    /**
+     * \brief Доля бюджета, оставшаяся очередям, байт
+     */
+    [[nodiscard]] std::size_t queue_allowance() noexcept;
+
+private:
+    /// Доля очередей, ниже которой бюджет их не ограничивает (~12 тыс. строк)
+    static constexpr std::size_t MIN_QUEUE_BYTES = std::size_t{1} << 20;
+
+    mutable std::mutex _mutex;                          ///< Мьютекс регистрации
+    std::deque<memory_account> _accounts;               ///< Счётчики подсистем (адреса стабильны)
+    std::vector<std::shared_ptr<const data_queue>> _queues; ///< Учитываемые очереди
+    memory_settings _settings;                          ///< Бюджет
+    std::atomic<std::size_t> _queued_peak{0};           ///< Наибольший замеченный объём очередей
+    std::atomic<std::uint64_t> _throttled{0};           ///< Ожиданий ридеров из-за бюджета
+    std::atomic<std::uint64_t> _throttled_ns{0};        ///< Суммарное время ожиданий, нс
+    std::atomic<std::uint64_t> _shed{0};                ///< Строк отброшено из-за исчерпания бюджета
+    std::atomic<bool> _overrun_reported{false};         ///< Предупреждение о превышении без очередей выдано
+};
+
+}  // namespace app::processing
+
+#endif  // MEMORY_BUDGET_HPP
@@ -0,0 +1,129 @@
+/**
+ * \file merging_digest.hpp
+ * \brief Merging T-Digest с буферизацией вставок
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Вариант T-Digest по Даннингу: новые значения копятся в буфере и
+ * вливаются в центроиды одним проходом после сортировки, а размер
+ * центроидов ограничивает масштабная функция k1 (арксинус).
+ */
+
+#ifndef MERGING_DIGEST_HPP
+#define MERGING_DIGEST_HPP
+
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace app::statistics {
+
+/**
+ * \brief Merging T-Digest
+ *
+ * Вставка — амортизированно O(log compression) (сортировка буфера),
+ * квантиль — O(compression): центроиды и отсортированный буфер обходятся
+ * слиянием, а сжатие буфера остаётся за вставкой.
+ */
+class merging_digest {
+public:
+    /**
+     * \brief Конструктор
+     * \param compression_ параметр компрессии (ориентировочное число центроидов)
+     * \throws std::invalid_argument если compression_ == 0
+     */
+    explicit merging_digest(std::size_t compression_ = 100);
+
+    /**
+     * \brief Добавляет значение в буфер (слияние при заполнении буфера)
+     * \param value_ значение для добавления
+     */
+    void add(double value_) noexcept;
+
+    /**
+     * \brief Вливает центроиды и буфер другого дигеста (с той же компрессией)
+     */
+    void merge(const merging_digest& other_) noexcept(false);
+
+    /**
+     * \brief Вычисляет квантиль распределения
+     * \param q_ квантиль от 0 до 1
+     * \throws std::invalid_argument если q_ вне [0,1]
+     * \throws std::runtime_error если дигест пуст
+     */
+    [[nodiscard]] double quantile(double q_) const noexcept(false);
+
+    /**
+     * \brief Вычисляет медиану распределения
+     */
+    [[nodiscard]] double median() const noexcept(false) { return quantile(0.5); }
+
+    /**
+     * \brief Вычисляет mean (точное, по исходным значениям)
+     */
+    [[nodiscard]] double mean() const noexcept;
+
+    /**
+     * \brief Возвращает количество добавленных элементов
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _total_count; }
+
+    /**
+     * \brief Проверяет, пуст ли дигест
+     */
+    [[nodiscard]] bool empty() const noexcept { return _total_count == 0; }
+
+    /**
+     * \brief Занимаемая память в байтах (центроиды и буфер)
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+private:
+    /**
+     * \brief Центроид - кластер близких значений
+     */
+    struct centroid {
+        double _mean;       ///< Среднее значение
+        double _weight;     ///< Вес кластера
+    };
+
+    /**
+     * \brief Вливает буфер в центроиды
+     */
+    void flush() noexcept;
+
+    /**
+     * \brief Досортировывает добавленные в буфер после последнего запроса значения
+     */
+    void sort_buffer() const noexcept;
+
+    /**
+     * \brief Масштабная функция k1: квантиль -> индекс
+     */
+    [[nodiscard]] double q_to_k(double q_) const noexcept;
+
+    /**
+     * \brief Обратная масштабная функция k1: индекс -> квантиль
+     */
+    [[nodiscard]] double k_to_q(double k_) const noexcept;
+
+private:
+    static constexpr double MAX_DOUBLE = std::numeric_limits<double>::max();
+    static constexpr std::size_t BUFFER_FACTOR = 5;     ///< Размер буфера в единицах компрессии
+
+    std::size_t _compression;                   ///< Параметр компрессии
+    std::vector<centroid> _centroids;           ///< Центроиды, отсортированные по _mean
+    mutable std::vector<centroid> _buffer;      ///< Ещё не влитые значения (префикс отсортирован)
+    mutable std::size_t _buffer_sorted{0};      ///< Длина отсортированного префикса буфера
+    std::vector<centroid> _scratch;             ///< Рабочий буфер слияния
+    std::size_t _total_count{0};                ///< Общее количество точек
+    double _sum{0.0};                           ///< Сумма значений
+    double _min_value{MAX_DOUBLE};              ///< Минимальное значение
+    double _max_value{-MAX_DOUBLE};             ///< Максимальное значение
+};
+
+}  // namespace app::statistics
+
+#endif  // MERGING_DIGEST_HPP
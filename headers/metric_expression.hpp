@@ -0,0 +1,120 @@
+/**
+ * \file metric_expression.hpp
+ * \brief Метрики: числовые колонки строки и выражения над ними
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef METRIC_EXPRESSION_HPP
+#define METRIC_EXPRESSION_HPP
+
+#include <string>
+#include <string_view>
+
+#include "types.hpp"
+
+namespace app::processing {
+
+/**
+ * \brief Выражение над колонками строки: операнд или "операнд оп операнд"
+ *
+ * Операнд - имя колонки (price, quantity, receive_ts, exchange_ts,
+ * latency = receive_ts - exchange_ts) или числовая константа;
+ * операция - одна из + - * /. Разбирается один раз при старте,
+ * вычисление на строке - пара ветвлений без аллокаций.
+ */
+class metric_expression {
+public:
+    /**
+     * \brief Разбирает выражение
+     * \param text_ текст выражения ("latency", "price*quantity", "quantity / 1000")
+     * \throws std::invalid_argument при синтаксической ошибке или неизвестной колонке
+     */
+    explicit metric_expression(std::string_view text_) noexcept(false);
+
+    /**
+     * \brief Значение метрики на строке
+     */
+    [[nodiscard]] double value(const data& row_) const noexcept
+    {
+        const double lhs = operand_value(_lhs, row_);
+        switch (_operation) {
+            case operation::none:     return lhs;
+            case operation::add:      return lhs + operand_value(_rhs, row_);
+            case operation::subtract: return lhs - operand_value(_rhs, row_);
+            case operation::multiply: return lhs * operand_value(_rhs, row_);
+            case operation::divide:   return lhs / operand_value(_rhs, row_);
+        }
+        return lhs;
+    }
+
+    /**
+     * \brief Имя метрики для заголовка (текст выражения без пробелов)
+     */
+    [[nodiscard]] const std::string& name() const noexcept { return _name; }
+
+private:
+    /**
+     * \brief Источник значения операнда
+     */
+    enum class column {
+        constant,       ///< Числовая константа _constant
+        price,          ///< Цена
+        quantity,       ///< Объём
+        receive_ts,     ///< Временная метка получения
+        exchange_ts,    ///< Временная метка биржи
+        latency         ///< receive_ts - exchange_ts
+    };
+
+    /**
+     * \brief Операция между операндами
+     */
+    enum class operation {
+        none,       ///< Выражение из одного операнда
+        add,        ///< +
+        subtract,   ///< -
+        multiply,   ///< *
+        divide      ///< /
+    };
+
+    /**
+     * \brief Операнд выражения
+     */
+    struct operand {
+        column _column{column::constant};   ///< Колонка
+        double _constant{0.0};              ///< Значение для column::constant
+    };
+
+    /**
+     * \brief Разбирает операнд
+     * \throws std::invalid_argument при неизвестной колонке
+     */
+    [[nodiscard]] static operand parse_operand(std::string_view text_) noexcept(false);
+
+    /**
+     * \brief Значение операнда на строке
+     */
+    [[nodiscard]] static double operand_value(const operand& operand_, const data& row_) noexcept
+    {
+        switch (operand_._column) {
+            case column::constant:    return operand_._constant;
+            case column::price:       return row_.price;
+            case column::quantity:    return row_.quantity;
+            case column::receive_ts:  return static_cast<double>(row_.receive_ts);
+            case column::exchange_ts: return static_cast<double>(row_.exchange_ts);
+            case column::latency:     return static_cast<double>(row_.receive_ts - row_.exchange_ts);
+        }
+        return 0.0;
+    }
+
+private:
+    std::string _name;                          ///< Имя метрики
+    operand _lhs;                               ///< Левый операнд
+    operation _operation{operation::none};      ///< Операция
+    operand _rhs;                               ///< Правый операнд
+};
+
+}  // namespace app::processing
+
+#endif  // METRIC_EXPRESSION_HPP
@@ -0,0 +1,200 @@
+/**
+ * \file pipeline_metrics.hpp
+ * \brief Метрики конвейера: счётчики стадий, глубины очередей и задержки
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef PIPELINE_METRICS_HPP
+#define PIPELINE_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data_queue.hpp"
+#include "latency_histogram.hpp"
+
+namespace app::processing {
+
+/**
+ * \brief Параметры выгрузки метрик (секция [stats] конфига)
+ */
+struct stats_settings {
+    std::filesystem::path _file;                    ///< JSON-файл статистики (пусто - только лог)
+    std::chrono::milliseconds _interval{0};         ///< Период выгрузки (0 - только в конце работы)
+};
+
+/**
+ * \brief Счётчик с единственным писателем
+ *
+ * Писатель обновляет его обычной загрузкой и сохранением без атомарного
+ * RMW; читатели видят значение с небольшой задержкой.
+ */
+class stage_counter {
+public:
+    /**
+     * \brief Прибавляет value_ (только поток-владелец)
+     */
+    void add(std::uint64_t value_ = 1) noexcept
+    {
+        _value.store(_value.load(std::memory_order_relaxed) + value_, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Текущее значение (из любого потока)
+     */
+    [[nodiscard]] std::uint64_t load() const noexcept { return _value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> _value{0};           ///< Значение
+};
+
+/**
+ * \brief Счётчики одного ридера (пишет только его поток)
+ */
+struct alignas(64) reader_counters {
+    std::string _name;                              ///< Имя файла
+    stage_counter _parsed;                          ///< Разобрано строк
+    stage_counter _rejected;                        ///< Отброшено строк с ошибкой разбора
+};
+
+/**
+ * \brief Метрики всего конвейера ридеры → воронка → калькулятор → вывод
+ *
+ * Одна на процесс. Каждая стадия пишет только в свои счётчики, лежащие
+ * на отдельной кеш-линии, поэтому учёт не создаёт конкуренции между
+ * потоками. Снимок выгружается в JSON-файл и лог фоновым потоком.
+ */
+class pipeline_metrics {
+public:
+    /**
+     * \brief Экземпляр метрик процесса
+     */
+    [[nodiscard]] static pipeline_metrics& instance() noexcept;
+
+    // Запрет копирования
+    pipeline_metrics(const pipeline_metrics&) = delete;
+    pipeline_metrics& operator=(const pipeline_metrics&) = delete;
+
+    /**
+     * \brief Текущее время steady_clock в наносекундах (метка чтения строки)
+     */
+    [[nodiscard]] static std::int_fast64_t now() noexcept;
+
+    /**
+     * \brief Регистрирует ридер; ссылка действительна до конца процесса
+     */
+    [[nodiscard]] reader_counters& register_reader(std::string name_) noexcept(false);
+
+    /**
+     * \brief Добавляет очередь, глубина которой попадёт в снимок
+     */
+    void watch_queue(std::string name_, std::shared_ptr<const data_queue> queue_) noexcept(false);
+
+    /**
+     * \brief Воронка: строка передана калькулятору
+     */
+    void forwarded() noexcept { _forwarded.add(); }
+
+    /**
+     * \brief Воронка: строка отброшена, потому что пришла раньше уже переданной
+     */
+    void dropped() noexcept { _dropped.add(); }
+
+    /**
+     * \brief Калькулятор: обработано rows_ строк
+     */
+    void calculated(std::size_t rows_) noexcept { _calculated.add(rows_); }
+
+    /**
+     * \brief Калькулятор: выведена строка результата по строке, прочитанной в read_time_
+     */
+    void emitted(std::int_fast64_t read_time_) noexcept;
+
+    /**
+     * \brief Самый ранний момент чтения среди выведенных строк (now(), 0 - вывода не было)
+     */
+    [[nodiscard]] std::int_fast64_t first_read() const noexcept { return _first_read.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Момент последнего вывода (now(), 0 - вывода не было)
+     */
+    [[nodiscard]] std::int_fast64_t last_emitted() const noexcept { return _last_emitted.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Калькулятор: всего values_ значений прижато к краю диапазона гистограммы
+     */
+    void clamped(std::uint64_t values_) noexcept { _clamped.store(values_, std::memory_order_relaxed); }
+
+    /**
+     * \brief Снимок метрик в JSON
+     */
+    [[nodiscard]] std::string to_json() const noexcept(false);
+
+    /**
+     * \brief Выводит сводку в лог
+     */
+    void log() const noexcept;
+
+    /**
+     * \brief Запускает периодическую выгрузку
+     */
+    void start_export(const stats_settings& settings_) noexcept(false);
+
+    /**
+     * \brief Останавливает выгрузку и выгружает итоговый снимок
+     */
+    void stop_export() noexcept;
+
+private:
+    pipeline_metrics() = default;
+
+    /**
+     * \brief Записывает снимок в файл (через временный файл и переименование)
+     */
+    void write_file() const noexcept;
+
+    /**
+     * \brief Поток выгрузки
+     */
+    void exporting(std::stop_token stoken_) noexcept;
+
+private:
+    /**
+     * \brief Наблюдаемая очередь
+     */
+    struct watched_queue {
+        std::string _name;                              ///< Имя в снимке
+        std::shared_ptr<const data_queue> _queue;       ///< Очередь
+    };
+
+    const std::chrono::steady_clock::time_point _start{std::chrono::steady_clock::now()};  ///< Начало работы
+    mutable std::mutex _mutex;                          ///< Мьютекс регистрации и выгрузки
+    std::deque<reader_counters> _readers;               ///< Счётчики ридеров (адреса стабильны)
+    std::vector<watched_queue> _queues;                 ///< Наблюдаемые очереди
+    alignas(64) stage_counter _forwarded;               ///< Воронка: передано строк
+    stage_counter _dropped;                             ///< Воронка: отброшено строк не по порядку
+    alignas(64) stage_counter _calculated;              ///< Калькулятор: обработано строк
+    stage_counter _emitted;                             ///< Калькулятор: выведено строк
+    std::atomic<std::uint64_t> _clamped{0};             ///< Калькулятор: значений прижато к краю гистограммы
+    std::atomic<std::int_fast64_t> _first_read{0};      ///< Калькулятор: самый ранний момент чтения выведенной строки
+    std::atomic<std::int_fast64_t> _last_emitted{0};    ///< Калькулятор: момент последнего вывода
+    alignas(64) latency_histogram _latency;             ///< Задержка чтение → вывод, нс
+    stats_settings _settings;                           ///< Параметры выгрузки
+    std::condition_variable_any _condition;             ///< Пробуждение потока выгрузки
+    std::jthread _exporting;                            ///< Поток выгрузки
+};
+
+}  // namespace app::processing
+
+#endif  // PIPELINE_METRICS_HPP
@@ -0,0 +1,124 @@
+/**
+ * \file quantile_engine.hpp
+ * \brief Выбор движка оценки квантилей для калькулятора
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef QUANTILE_ENGINE_HPP
+#define QUANTILE_ENGINE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "decayed_tdigest.hpp"
+#include "exact_quantiles.hpp"
+#include "merging_digest.hpp"
+#include "quantile_estimator.hpp"
+#include "sliding_window.hpp"
+#include "tdigest.hpp"
+#include "tick_histogram.hpp"
+
+namespace app::statistics {
+
+/**
+ * \brief Доступные движки квантилей
+ */
+enum class engine_kind {
+    tdigest,    ///< T-Digest (приближённый, ограниченная память)
+    histogram,  ///< Гистограмма по тикам (точный на сетке тиков)
+    window,     ///< Гистограмма по скользящему окну receive_ts
+    decayed,    ///< T-Digest с экспоненциальным затуханием по receive_ts
+    merging,    ///< Merging T-Digest с буферизацией вставок
+    exact       ///< Точные квантили по всем значениям (эталон, память O(n))
+};
+
+/**
+ * \brief Параметры движка квантилей (секция [calculator] конфига)
+ */
+struct engine_settings {
+    engine_kind _kind{engine_kind::tdigest};                        ///< Выбранный движок
+    std::size_t _compression{100};                                  ///< Компрессия T-Digest
+    double _tick_size{0.01};                                        ///< Шаг ценовой сетки гистограммы
+    std::size_t _max_pages{tick_histogram::DEFAULT_MAX_PAGES};      ///< Предельная ширина диапазона гистограммы
+    double _window_seconds{60.0};                                   ///< Ширина скользящего окна в секундах
+    double _half_life_seconds{300.0};                               ///< Период полураспада затухания в секундах
+    std::int_fast64_t _ts_per_second{1'000'000};                    ///< Единиц receive_ts в секунде (микросекунды)
+    std::vector<std::pair<std::string, double>> _metric_ticks;      ///< Шаг сетки гистограммы по имени метрики
+};
+
+/**
+ * \brief Параметры движка метрики: те же, что у цены, но со своим шагом сетки
+ * \param settings_ параметры движка цены
+ * \param metric_ имя метрики (metric_expression::name())
+ * \throws std::invalid_argument если движку с сеткой (histogram, window) не задан шаг метрики
+ *
+ * Метрики другого масштаба (receive_ts, quantity) на сетке цены
+ * округлялись бы или прижимались к краю диапазона.
+ */
+[[nodiscard]] engine_settings metric_settings(const engine_settings& settings_, std::string_view metric_) noexcept(false);
+
+/**
+ * \brief Преобразует имя движка из конфига в engine_kind
+ * \param name_ имя движка ("tdigest", "histogram", "window", "decayed", "merging" или "exact")
+ * \throws std::invalid_argument при неизвестном имени
+ */
+[[nodiscard]] engine_kind parse_engine_kind(std::string_view name_) noexcept(false);
+
+/**
+ * \brief Имя движка для логов
+ */
+[[nodiscard]] std::string_view engine_name(engine_kind kind_) noexcept;
+
+/**
+ * \brief Создаёт движок заданного типа по параметрам
+ * \throws std::invalid_argument при некорректных параметрах
+ */
+template <quantile_estimator Engine>
+[[nodiscard]] Engine make_engine(const engine_settings& settings_) noexcept(false)
+{
+    const auto per_second = static_cast<double>(settings_._ts_per_second);
+
+    if constexpr (std::is_same_v<Engine, tick_histogram>) {
+        return Engine{settings_._tick_size, settings_._max_pages};
+    } else if constexpr (std::is_same_v<Engine, sliding_window>) {
+        return Engine{std::llround(settings_._window_seconds * per_second),
+                      settings_._tick_size, settings_._max_pages};
+    } else if constexpr (std::is_same_v<Engine, decayed_tdigest>) {
+        return Engine{settings_._half_life_seconds * per_second, settings_._compression};
+    } else if constexpr (std::is_same_v<Engine, exact_quantiles>) {
+        return Engine{};
+    } else {
+        return Engine{settings_._compression};
+    }
+}
+
+/**
+ * \brief Вызывает func_ с типом движка, соответствующим kind_
+ *
+ * func_ получает std::type_identity<Engine>; единственная точка,
+ * где выбор движка из конфига превращается в тип.
+ */
+template <typename Func>
+decltype(auto) with_engine(engine_kind kind_, Func&& func_)
+{
+    switch (kind_) {
+        case engine_kind::histogram: return func_(std::type_identity<tick_histogram>{});
+        case engine_kind::window:    return func_(std::type_identity<sliding_window>{});
+        case engine_kind::decayed:   return func_(std::type_identity<decayed_tdigest>{});
+        case engine_kind::merging:   return func_(std::type_identity<merging_digest>{});
+        case engine_kind::exact:     return func_(std::type_identity<exact_quantiles>{});
+        case engine_kind::tdigest:   break;
+    }
+    return func_(std::type_identity<tdigest>{});
+}
+
+}  // namespace app::statistics
+
+#endif  // QUANTILE_ENGINE_HPP
@@ -0,0 +1,65 @@
+/**
+ * \file quantile_estimator.hpp
+ * \brief Концепт движка оценки квантилей
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef QUANTILE_ESTIMATOR_HPP
+#define QUANTILE_ESTIMATOR_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace app::statistics {
+
+/**
+ * \brief Движок, которому для вставки нужна временная метка (окно, затухание)
+ */
+template <typename T>
+concept timed_estimator = requires(T& engine_, double value_, std::int_fast64_t timestamp_) {
+    engine_.add(value_, timestamp_);
+};
+
+/**
+ * \brief Движок оценки квантилей
+ *
+ * Калькулятор параметризуется движком на этапе компиляции,
+ * поэтому вызовы в горячем цикле не проходят через виртуальную диспетчеризацию.
+ */
+template <typename T>
+concept quantile_estimator = requires(T& engine_, const T& const_engine_, double value_) {
+    { const_engine_.quantile(value_) } -> std::convertible_to<double>;
+    { const_engine_.median() } -> std::convertible_to<double>;
+    { const_engine_.mean() } -> std::convertible_to<double>;
+    { const_engine_.size() } -> std::convertible_to<std::size_t>;
+    { const_engine_.empty() } -> std::convertible_to<bool>;
+    { const_engine_.memory_bytes() } -> std::convertible_to<std::size_t>;
+} && (timed_estimator<T> || requires(T& engine_, double value_) { engine_.add(value_); });
+
+/**
+ * \brief Движок, состояние которого можно слить с другим (шардированный калькулятор)
+ */
+template <typename T>
+concept mergeable_estimator = quantile_estimator<T> && requires(T& engine_, const T& other_) {
+    engine_.merge(other_);
+};
+
+/**
+ * \brief Добавляет значение в движок, передавая метку только тем, кому она нужна
+ */
+template <quantile_estimator Engine>
+void insert(Engine& engine_, double value_, std::int_fast64_t timestamp_)
+{
+    if constexpr (timed_estimator<Engine>) {
+        engine_.add(value_, timestamp_);
+    } else {
+        engine_.add(value_);
+    }
+}
+
+}  // namespace app::statistics
+
+#endif  // QUANTILE_ESTIMATOR_HPP
@@ -9,6 +9,7 @@
 #ifndef READERS_MANAGER_HPP
 #define READERS_MANAGER_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <thread>
@@ -18,6 +19,7 @@
 
 #include "csv_reader.hpp"
 #include "data_queue.hpp"
+#include "wait_strategy.hpp"
 
 namespace app::io {
 
@@ -52,10 +54,11 @@ public:
     /**
      * \brief Добавляет новый CSV файл для чтения и запускает поток для чтения
      * \param filename_ путь к CSV файлу
+     * \param source_ индекс источника строк (индекс файла в group_settings::_sources)
      * \throws std::invalid_argument если файл не существует
      * \throws std::runtime_error если не удалось создать читатель
      */
-    void add_csv_file(std::string filename_) noexcept(false);
+    void add_csv_file(std::string filename_, std::uint32_t source_) noexcept(false);
 
     /**
      * \brief Возвращает количество обработанных задач
@@ -67,6 +70,11 @@ public:
      */
     void run() noexcept;
 
+    /**
+     * \brief Задаёт способ ожидания воронки, когда у ридеров нет строк (до run())
+     */
+    void set_funnel_wait(app::processing::wait_strategy strategy_) noexcept { _funnel_wait = strategy_; }
+
     /**
      * \brief Останавливает всех reader, выключает "воронку" и закрывает очередь
      */
@@ -106,6 +114,8 @@ private:
     std::jthread _redirecting_tasks;                        ///< Поток "воронки" задач
     std::stop_source _readers_stoken;                       ///< Источник токена остановки reader
     std::stop_source _stoken_redirecting;                   ///< Источник токена остановки "воронки"
+    std::shared_ptr<app::processing::wake_signal> _arrivals{std::make_shared<app::processing::wake_signal>()}; ///< Сигнал о строках в локальных очередях
+    app::processing::wait_strategy _funnel_wait{app::processing::wait_strategy::spin_park}; ///< Ожидание воронки
 };
 
 }  // namespace app::io
@@ -0,0 +1,114 @@
+/**
+ * \file running_moments.hpp
+ * \brief Скользящие моменты потока цен (Boost.Accumulators)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef RUNNING_MOMENTS_HPP
+#define RUNNING_MOMENTS_HPP
+
+#include <cstddef>
+
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/count.hpp>
+#include <boost/accumulators/statistics/max.hpp>
+#include <boost/accumulators/statistics/mean.hpp>
+#include <boost/accumulators/statistics/min.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/sum.hpp>
+#include <boost/accumulators/statistics/variance.hpp>
+#include <boost/accumulators/statistics/weighted_sum.hpp>
+
+namespace app::statistics {
+
+/**
+ * \brief Count, sum, min, max, дисперсия и VWAP по всему потоку
+ *
+ * Все статистики обновляются инкрементально за O(1) на вставку
+ * и читаются за O(1) - без обхода центроидов или значений.
+ * Дисперсия - генеральная (делитель n), VWAP взвешен объёмом сделки.
+ */
+class running_moments {
+public:
+    /**
+     * \brief Конструктор
+     */
+    running_moments() = default;
+
+    /**
+     * \brief Добавляет цену с объёмом сделки
+     * \param price_ цена
+     * \param quantity_ объём (строки с нулевым объёмом не влияют на VWAP)
+     */
+    void add(double price_, double quantity_ = 0.0) noexcept;
+
+    /**
+     * \brief Количество цен
+     */
+    [[nodiscard]] std::size_t count() const noexcept;
+
+    /**
+     * \brief Сумма цен
+     */
+    [[nodiscard]] double sum() const noexcept;
+
+    /**
+     * \brief Минимальная цена (0 для пустого потока)
+     */
+    [[nodiscard]] double min() const noexcept;
+
+    /**
+     * \brief Максимальная цена (0 для пустого потока)
+     */
+    [[nodiscard]] double max() const noexcept;
+
+    /**
+     * \brief Средняя цена
+     */
+    [[nodiscard]] double mean() const noexcept;
+
+    /**
+     * \brief Генеральная дисперсия цены
+     */
+    [[nodiscard]] double variance() const noexcept;
+
+    /**
+     * \brief Стандартное отклонение цены
+     */
+    [[nodiscard]] double stddev() const noexcept;
+
+    /**
+     * \brief Средняя цена, взвешенная по объёму (0, если объёмов не было)
+     */
+    [[nodiscard]] double vwap() const noexcept;
+
+    /**
+     * \brief Проверяет, пуст ли поток
+     */
+    [[nodiscard]] bool empty() const noexcept { return count() == 0; }
+
+private:
+    using price_stats = boost::accumulators::accumulator_set<double,
+        boost::accumulators::stats<
+            boost::accumulators::tag::count,
+            boost::accumulators::tag::sum,
+            boost::accumulators::tag::min,
+            boost::accumulators::tag::max,
+            boost::accumulators::tag::mean,
+            boost::accumulators::tag::variance>>;
+
+    using volume_stats = boost::accumulators::accumulator_set<double,
+        boost::accumulators::stats<
+            boost::accumulators::tag::weighted_sum,
+            boost::accumulators::tag::sum_of_weights>,
+        double>;
+
+    price_stats _prices;        ///< Моменты цены
+    volume_stats _volumes;      ///< Сумма цена*объём и сумма объёмов для VWAP
+};
+
+}  // namespace app::statistics
+
+#endif  // RUNNING_MOMENTS_HPP
@@ -0,0 +1,91 @@
+/**
+ * \file segment_writer.hpp
+ * \brief Запись сегмента выходного файла через memory-mapped file
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef SEGMENT_WRITER_HPP
+#define SEGMENT_WRITER_HPP
+
+#include <cstddef>
+#include <filesystem>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace app::io {
+
+/**
+ * \brief Писатель одного сегмента вывода
+ *
+ * Файл сегмента создаётся сразу с заданным размером (на Linux место
+ * выделяется posix_fallocate, на Windows - SetEndOfFile через resize_file)
+ * и пишется копированием в отображение. Если данных больше, файл
+ * расширяется вдвое и отображается заново. При закрытии (seal) файл
+ * обрезается до реальной длины.
+ */
+class segment_writer {
+public:
+    /**
+     * \brief Создаёт и отображает файл сегмента
+     * \param path_ путь к файлу (перезаписывается)
+     * \param preallocate_ начальный размер файла в байтах
+     * \throws std::filesystem::filesystem_error или boost::interprocess::interprocess_exception
+     */
+    segment_writer(std::filesystem::path path_, std::size_t preallocate_) noexcept(false);
+
+    /**
+     * \brief Деструктор - закрывает сегмент, если это ещё не сделано
+     */
+    ~segment_writer();
+
+    // Запрет копирования
+    segment_writer(const segment_writer&) = delete;
+    segment_writer& operator=(const segment_writer&) = delete;
+
+    // Запрет перемещения (отображение привязано к файлу сегмента)
+    segment_writer(segment_writer&&) = delete;
+    segment_writer& operator=(segment_writer&&) = delete;
+
+    /**
+     * \brief Дописывает данные в сегмент
+     * \throws std::filesystem::filesystem_error или boost::interprocess::interprocess_exception
+     */
+    void write(const char* data_, std::size_t size_) noexcept(false);
+
+    /**
+     * \brief Снимает отображение и обрезает файл до записанной длины
+     * \throws std::filesystem::filesystem_error
+     */
+    void seal() noexcept(false);
+
+    /**
+     * \brief Записано байт
+     */
+    [[nodiscard]] std::size_t length() const noexcept { return _length; }
+
+    /**
+     * \brief Путь к файлу сегмента
+     */
+    [[nodiscard]] const std::filesystem::path& path() const noexcept { return _path; }
+
+private:
+    /**
+     * \brief Задаёт размер файла и отображает его заново
+     */
+    void map(std::size_t capacity_) noexcept(false);
+
+private:
+    std::filesystem::path _path;                    ///< Путь к файлу сегмента
+    std::size_t _capacity{0};                       ///< Размер файла и отображения
+    std::size_t _length{0};                         ///< Записано байт
+    boost::interprocess::file_mapping _mapping;     ///< Отображение файла
+    boost::interprocess::mapped_region _region;     ///< Отображённая область
+    bool _sealed{false};                            ///< Сегмент закрыт
+};
+
+}  // namespace app::io
+
+#endif  // SEGMENT_WRITER_HPP
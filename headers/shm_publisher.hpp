@@ -0,0 +1,99 @@
+/**
+ * \file shm_publisher.hpp
+ * \brief Публикация результатов в кольцевой буфер в разделяемой памяти
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef SHM_PUBLISHER_HPP
+#define SHM_PUBLISHER_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "shm_ring.hpp"
+
+namespace app::io {
+
+/**
+ * \brief Параметры публикации (секция [publisher] конфига)
+ */
+struct publisher_settings {
+    std::string _name;                  ///< Имя сегмента разделяемой памяти (пусто - публикация выключена)
+    std::size_t _capacity{4096};        ///< Число ячеек кольца (округляется до степени двойки)
+
+    /**
+     * \brief Включена ли публикация
+     */
+    [[nodiscard]] bool enabled() const noexcept { return !_name.empty(); }
+};
+
+/**
+ * \brief Единственный писатель кольца результатов в разделяемой памяти
+ *
+ * Создаёт сегмент (пересоздаёт, если он остался от прошлого запуска)
+ * и удаляет его при разрушении. Читатели - app::io::shm::consumer.
+ * Потокобезопасность должна обеспечиваться вызывающим кодом.
+ */
+class shm_publisher {
+public:
+    /**
+     * \brief Конструктор - создаёт сегмент
+     * \throws boost::interprocess::interprocess_exception если сегмент не создаётся
+     */
+    explicit shm_publisher(const publisher_settings& settings_) noexcept(false);
+
+    /**
+     * \brief Деструктор - удаляет сегмент
+     */
+    ~shm_publisher();
+
+    // Запрет копирования
+    shm_publisher(const shm_publisher&) = delete;
+    shm_publisher& operator=(const shm_publisher&) = delete;
+
+    // Запрет перемещения (сегмент принадлежит одному писателю)
+    shm_publisher(shm_publisher&&) = delete;
+    shm_publisher& operator=(shm_publisher&&) = delete;
+
+    /**
+     * \brief Публикует результат
+     * \param timestamp_ временная метка
+     * \param median_ медианное значение
+     * \param extra_values_ дополнительные колонки (используются первые shm::MAX_COLUMNS)
+     */
+    void publish(
+        std::int_fast64_t timestamp_,
+        double median_,
+        std::vector<std::pair<std::string, double>> const& extra_values_) noexcept;
+
+    /**
+     * \brief Количество опубликованных записей
+     */
+    [[nodiscard]] std::uint64_t published() const noexcept { return _sequence; }
+
+private:
+    /**
+     * \brief Заполняет заголовок именами колонок (при первой публикации)
+     */
+    void write_header(std::vector<std::pair<std::string, double>> const& extra_values_) noexcept;
+
+private:
+    std::string _name;                                  ///< Имя сегмента
+    boost::interprocess::shared_memory_object _memory;  ///< Сегмент разделяемой памяти
+    boost::interprocess::mapped_region _region;         ///< Отображение сегмента
+    shm::ring_header* _header{nullptr};                 ///< Заголовок
+    shm::ring_slot* _slots{nullptr};                    ///< Ячейки кольца
+    std::uint32_t _mask{0};                             ///< capacity - 1
+    std::uint64_t _sequence{0};                         ///< Номер последней записи
+};
+
+}  // namespace app::io
+
+#endif  // SHM_PUBLISHER_HPP
@@ -0,0 +1,206 @@
+/**
+ * \file shm_ring.hpp
+ * \brief Кольцевой буфер результатов в разделяемой памяти и его читатель (header-only)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Один писатель (калькулятор) и любое число читателей в других процессах.
+ * Запись n (с единицы) лежит в ячейке (n - 1) & (capacity - 1). Ячейка
+ * защищена счётчиком-seqlock: на время записи в нём 2n - 1, после - 2n.
+ * Читатель копирует ячейку и сверяет счётчик до и после копирования;
+ * если писатель успел перезаписать ячейку, запись считается потерянной.
+ */
+
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+namespace app::io::shm {
+
+constexpr std::uint64_t MAGIC = 0x4D454449414E5231;     ///< "MEDIANR1": раскладка заполнена
+constexpr std::uint32_t VERSION = 1;                    ///< Версия раскладки
+constexpr std::size_t MAX_COLUMNS = 32;                 ///< Предельное число дополнительных колонок
+constexpr std::size_t NAME_SIZE = 32;                   ///< Длина имени колонки с завершающим нулём
+constexpr std::size_t CACHE_LINE = 64;                  ///< Размер кеш-линии
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared ring needs lock-free 64-bit atomics");
+
+/**
+ * \brief Заголовок сегмента
+ */
+struct ring_header {
+    std::atomic<std::uint64_t> _magic;                      ///< MAGIC, когда раскладка заполнена (остальные поля - после него)
+    std::uint32_t _version;                                 ///< VERSION
+    std::uint32_t _capacity;                                ///< Число ячеек (степень двойки)
+    std::uint32_t _columns;                                 ///< Число дополнительных колонок
+    char _names[MAX_COLUMNS][NAME_SIZE];                    ///< Имена дополнительных колонок
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> _published; ///< Номер последней опубликованной записи
+};
+
+/**
+ * \brief Ячейка кольца: receive_ts, медиана и колонки как биты double
+ */
+struct alignas(CACHE_LINE) ring_slot {
+    std::atomic<std::uint64_t> _sequence;                   ///< 2n - 1 во время записи n, 2n после
+    std::atomic<std::uint64_t> _payload[2 + MAX_COLUMNS];   ///< receive_ts, median, колонки
+};
+
+/**
+ * \brief Размер сегмента для capacity_ ячеек
+ */
+[[nodiscard]] constexpr std::size_t segment_size(std::size_t capacity_) noexcept
+{
+    return (sizeof(ring_header) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE + capacity_ * sizeof(ring_slot);
+}
+
+/**
+ * \brief Ячейки кольца сразу за заголовком
+ */
+[[nodiscard]] inline ring_slot* slots(void* segment_) noexcept
+{
+    return reinterpret_cast<ring_slot*>(static_cast<char*>(segment_)
+        + (sizeof(ring_header) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+}
+
+/**
+ * \brief Прочитанная запись
+ */
+struct record {
+    std::uint64_t _sequence{0};                             ///< Номер записи (с единицы)
+    std::int64_t _timestamp{0};                             ///< receive_ts
+    double _median{0.0};                                    ///< Медиана
+    std::array<double, MAX_COLUMNS> _values{};              ///< Дополнительные колонки (первые columns())
+};
+
+/**
+ * \brief Читатель кольца в разделяемой памяти
+ *
+ * Не блокирует писателя: чтение - это копирование ячейки и две проверки
+ * счётчика. Медленный читатель теряет записи, а не тормозит калькулятор.
+ * Сегмент открывается только на чтение.
+ */
+class consumer {
+public:
+    /**
+     * \brief Открывает сегмент, созданный калькулятором
+     * \throws boost::interprocess::interprocess_exception если сегмента нет
+     * \throws std::runtime_error если калькулятор ещё не заполнил раскладку
+     *         (попытку можно повторить) или раскладка не совпадает
+     */
+    explicit consumer(const std::string& name_) noexcept(false)
+        : _memory{boost::interprocess::open_only, name_.c_str(), boost::interprocess::read_only}
+        , _region{_memory, boost::interprocess::read_only}
+        , _header{static_cast<const ring_header*>(_region.get_address())}
+        , _slots{slots(_region.get_address())}
+    {
+        // Остальным полям заголовка можно верить только после magic
+        if (_region.get_size() < sizeof(ring_header) || _header->_magic.load(std::memory_order_acquire) != MAGIC) {
+            throw std::runtime_error{"Shared ring is not initialized yet: " + name_};
+        }
+        if (_header->_version != VERSION || !std::has_single_bit(_header->_capacity)
+            || _region.get_size() < segment_size(_header->_capacity)) {
+            throw std::runtime_error{"Shared ring layout mismatch: " + name_};
+        }
+        _mask = _header->_capacity - 1;
+    }
+
+    // Запрет копирования (указатели смотрят в отображение)
+    consumer(const consumer&) = delete;
+    consumer& operator=(const consumer&) = delete;
+
+    /**
+     * \brief Число дополнительных колонок (известно после первой записи: published() > 0)
+     */
+    [[nodiscard]] std::size_t columns() const noexcept { return _header->_columns; }
+
+    /**
+     * \brief Имя дополнительной колонки (после первой записи)
+     */
+    [[nodiscard]] std::string_view column_name(std::size_t index_) const noexcept
+    {
+        const char* name = _header->_names[index_];
+        return {name, static_cast<std::size_t>(std::find(name, name + NAME_SIZE, '\0') - name)};
+    }
+
+    /**
+     * \brief Число ячеек кольца: записи старше published() - capacity() уже перезаписаны
+     */
+    [[nodiscard]] std::size_t capacity() const noexcept { return std::size_t{_mask} + 1; }
+
+    /**
+     * \brief Номер последней опубликованной записи (0 - записей ещё нет)
+     */
+    [[nodiscard]] std::uint64_t published() const noexcept
+    {
+        return _header->_published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Читает запись sequence_
+     * \return false, если записи ещё нет или она уже перезаписана
+     */
+    [[nodiscard]] bool read(std::uint64_t sequence_, record& record_) const noexcept
+    {
+        if (sequence_ == 0) {
+            return false;
+        }
+        const auto& slot = _slots[(sequence_ - 1) & _mask];
+        const auto expected = 2 * sequence_;
+
+        if (slot._sequence.load(std::memory_order_acquire) != expected) {
+            return false;
+        }
+        record_._sequence = sequence_;
+        record_._timestamp = static_cast<std::int64_t>(slot._payload[0].load(std::memory_order_relaxed));
+        record_._median = std::bit_cast<double>(slot._payload[1].load(std::memory_order_relaxed));
+        const auto count = _header->_columns;
+        for (std::size_t i = 0; i < count; ++i) {
+            record_._values[i] = std::bit_cast<double>(slot._payload[2 + i].load(std::memory_order_relaxed));
+        }
+
+        // Писатель не трогал ячейку за время копирования
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot._sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    /**
+     * \brief Читает самую свежую запись
+     * \return false, если записей ещё нет
+     */
+    [[nodiscard]] bool latest(record& record_) const noexcept
+    {
+        while (true) {
+            const auto sequence = published();
+            if (sequence == 0) {
+                return false;
+            }
+            if (read(sequence, record_)) {
+                return true;
+            }
+        }
+    }
+
+private:
+    boost::interprocess::shared_memory_object _memory;      ///< Сегмент разделяемой памяти
+    boost::interprocess::mapped_region _region;             ///< Отображение сегмента
+    const ring_header* _header;                             ///< Заголовок
+    const ring_slot* _slots;                                ///< Ячейки кольца
+    std::uint32_t _mask{0};                                 ///< capacity - 1 (проверено при открытии)
+};
+
+}  // namespace app::io::shm
+
+#endif  // SHM_RING_HPP
@@ -0,0 +1,140 @@
+/**
+ * \file sliding_window.hpp
+ * \brief Медиана по скользящему окну receive_ts
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ */
+
+#ifndef SLIDING_WINDOW_HPP
+#define SLIDING_WINDOW_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "tick_histogram.hpp"
+
+namespace app::statistics {
+
+/**
+ * \brief Квантили по значениям за последние N единиц receive_ts
+ *
+ * Значения окна лежат в гистограмме по тикам, а окно делится по receive_ts
+ * на SLICES срезов. Срез хранит не строки, а число значений на каждом тике
+ * и сумму исходных значений, поэтому память зависит от числа различных тиков,
+ * а не от потока строк. Срез целиком вычитается из гистограммы, когда
+ * выходит за окно: окно покрывает от N до N + N / SLICES единиц receive_ts.
+ */
+class sliding_window {
+public:
+    static constexpr std::int_fast64_t SLICES = 60;     ///< Срезов на ширину окна (при 60 с - по секунде)
+
+    /**
+     * \brief Конструктор
+     * \param span_ ширина окна в единицах receive_ts
+     * \param tick_size_ шаг ценовой сетки гистограммы
+     * \param max_pages_ предельная ширина диапазона гистограммы в страницах
+     * \throws std::invalid_argument если span_ <= 0
+     */
+    explicit sliding_window(
+        std::int_fast64_t span_,
+        double tick_size_ = 0.01,
+        std::size_t max_pages_ = tick_histogram::DEFAULT_MAX_PAGES);
+
+    /**
+     * \brief Добавляет значение и вытесняет устаревшие
+     * \param value_ значение для добавления
+     * \param timestamp_ receive_ts значения (не убывает от вызова к вызову)
+     */
+    void add(double value_, std::int_fast64_t timestamp_) noexcept(false);
+
+    /**
+     * \brief Вычисляет квантиль по значениям окна
+     * \param q_ квантиль от 0 до 1
+     * \throws std::invalid_argument если q_ вне [0,1]
+     * \throws std::runtime_error если окно пусто
+     */
+    [[nodiscard]] double quantile(double q_) const noexcept(false) { return _histogram.quantile(q_); }
+
+    /**
+     * \brief Вычисляет медиану окна
+     */
+    [[nodiscard]] double median() const noexcept(false) { return _histogram.median(); }
+
+    /**
+     * \brief Вычисляет mean по значениям окна
+     *
+     * Сумма окна пересчитывается по суммам срезов при каждой смене среза,
+     * поэтому ошибка округления не накапливается за время работы.
+     */
+    [[nodiscard]] double mean() const noexcept;
+
+    /**
+     * \brief Вычисляет extra_values (mean, p90, p95, p99) по значениям окна
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, double>> extra_values(std::vector<std::string> const values_name_) const noexcept(false);
+
+    /**
+     * \brief Количество значений в окне
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _histogram.size(); }
+
+    /**
+     * \brief Проверяет, пусто ли окно
+     */
+    [[nodiscard]] bool empty() const noexcept { return _histogram.empty(); }
+
+    /**
+     * \brief Количество значений, прижатых к краю диапазона гистограммы
+     */
+    [[nodiscard]] std::size_t clamped() const noexcept { return _histogram.clamped(); }
+
+    /**
+     * \brief Занимаемая память в байтах (окно и гистограмма)
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+private:
+    /**
+     * \brief Закрытый срез окна
+     */
+    struct slice {
+        std::int_fast64_t _index;                                   ///< Номер среза (receive_ts / _slice)
+        std::vector<std::pair<std::int64_t, std::uint32_t>> _ticks; ///< Тики среза и число значений на каждом
+        double _sum;                                                ///< Сумма исходных значений среза
+    };
+
+    /**
+     * \brief Переносит открытый срез в закрытые
+     */
+    void close_slice() noexcept(false);
+
+    /**
+     * \brief Вычитает из гистограммы срезы, целиком вышедшие за окно
+     */
+    void expire(std::int_fast64_t timestamp_) noexcept;
+
+    /**
+     * \brief Пересчитывает сумму закрытых срезов
+     */
+    void resum() noexcept;
+
+private:
+    std::int_fast64_t _span;                                        ///< Ширина окна
+    std::int_fast64_t _slice;                                       ///< Ширина среза
+    tick_histogram _histogram;                                      ///< Распределение значений окна
+    std::deque<slice> _slices;                                      ///< Закрытые срезы в порядке времени
+    boost::unordered_flat_map<std::int64_t, std::uint32_t> _open;   ///< Тики открытого среза
+    std::int_fast64_t _open_index{0};                               ///< Номер открытого среза
+    double _open_sum{0.0};                                          ///< Сумма значений открытого среза
+    double _closed_sum{0.0};                                        ///< Сумма значений закрытых срезов
+};
+
+}  // namespace app::statistics
+
+#endif  // SLIDING_WINDOW_HPP
@@ -0,0 +1,129 @@
+/**
+ * \file thread_placement.hpp
+ * \brief Привязка потоков стадий конвейера к процессорам и их приоритет
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Каждая стадия (ридеры, воронка, калькулятор, шарды, запись) может быть
+ * закреплена за набором процессоров и получить свой приоритет. Поток
+ * применяет размещение сам, первым действием после старта.
+ */
+
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace app::processing {
+
+/**
+ * \brief Стадия конвейера
+ */
+enum class pipeline_stage {
+    readers,        ///< Потоки ридеров
+    funnel,         ///< Воронка readers_manager
+    calculator,     ///< Калькулятор (координатор при шардах)
+    shards,         ///< Потоки шардов
+    writer          ///< Поток записи file_streamer
+};
+
+inline constexpr std::size_t STAGE_COUNT = 5;   ///< Количество стадий
+
+/**
+ * \brief Приоритет потоков стадии
+ */
+enum class thread_priority {
+    unchanged,      ///< Не менять
+    low,            ///< Ниже обычного
+    normal,         ///< Обычный
+    high,           ///< Выше обычного (на Linux нужен CAP_SYS_NICE)
+    realtime        ///< Реального времени (SCHED_FIFO / TIME_CRITICAL)
+};
+
+/**
+ * \brief Размещение потоков одной стадии
+ */
+struct stage_placement {
+    std::vector<unsigned> _cpus;                    ///< Процессоры (пусто - без привязки)
+    thread_priority _priority{thread_priority::unchanged}; ///< Приоритет
+};
+
+/**
+ * \brief Параметры размещения (секции [threads.<стадия>] конфига)
+ */
+struct placement_settings {
+    std::array<stage_placement, STAGE_COUNT> _stages;   ///< Размещение по стадиям
+    bool _isolate_calculator{false};                    ///< Убрать процессоры калькулятора из наборов остальных стадий
+
+    /**
+     * \brief Задано ли хоть что-то
+     */
+    [[nodiscard]] bool enabled() const noexcept;
+};
+
+/**
+ * \brief Имя стадии в конфиге и логе
+ */
+[[nodiscard]] std::string_view stage_name(pipeline_stage stage_) noexcept;
+
+/**
+ * \brief Разбирает приоритет: "low", "normal", "high", "realtime"
+ * \throws std::invalid_argument при неизвестном имени
+ */
+[[nodiscard]] thread_priority parse_priority(std::string_view name_) noexcept(false);
+
+/**
+ * \brief Разбирает список процессоров вида "0-3,6,8-9"
+ * \throws std::invalid_argument при ошибке формата или номере процессора
+ *         больше, чем помещается в маску привязки
+ */
+[[nodiscard]] std::vector<unsigned> parse_cpu_list(std::string_view list_) noexcept(false);
+
+/**
+ * \brief Размещение потоков процесса
+ *
+ * Один на процесс. configure() вызывается до запуска потоков конвейера,
+ * apply() - каждым потоком стадии для самого себя.
+ */
+class thread_placement {
+public:
+    /**
+     * \brief Экземпляр процесса
+     */
+    [[nodiscard]] static thread_placement& instance() noexcept;
+
+    // Запрет копирования
+    thread_placement(const thread_placement&) = delete;
+    thread_placement& operator=(const thread_placement&) = delete;
+
+    /**
+     * \brief Принимает размещение, применяет изоляцию калькулятора и пишет итог в лог
+     * \throws std::invalid_argument если процессор стадии недоступен процессу
+     *         (маска sched_getaffinity / GetProcessAffinityMask)
+     *         или изоляция оставила стадию без процессоров
+     */
+    void configure(const placement_settings& settings_) noexcept(false);
+
+    /**
+     * \brief Закрепляет текущий поток за процессорами стадии и задаёт его приоритет
+     *
+     * Ошибки системы не прерывают работу: поток остаётся на прежнем месте,
+     * в лог пишется предупреждение.
+     */
+    void apply(pipeline_stage stage_) const noexcept;
+
+private:
+    thread_placement() = default;
+
+private:
+    placement_settings _settings;                   ///< Итоговое размещение
+};
+
+}  // namespace app::processing
+
+#endif  // THREAD_PLACEMENT_HPP
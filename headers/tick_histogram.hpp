@@ -0,0 +1,207 @@
+/**
+ * \file tick_histogram.hpp
+ * \brief Гистограмма по ценовым тикам для точной оценки квантилей
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Цены сделок лежат на фиксированной сетке тиков внутри ограниченного
+ * диапазона, поэтому распределение можно хранить как счётчики по тикам.
+ * Счётчики разбиты на страницы, страницы выделяются лениво, а поиск
+ * квантиля идёт спуском по деревьям Фенвика (по страницам и внутри страницы).
+ */
+
+#ifndef TICK_HISTOGRAM_HPP
+#define TICK_HISTOGRAM_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace app::statistics {
+
+/**
+ * \brief Гистограмма счётчиков по тикам цены
+ *
+ * Добавление — O(log PAGE_TICKS + log P), где P — число страниц в диапазоне,
+ * то есть ограниченная константа. Квантиль — O(log PAGE_TICKS + log P).
+ * Для цен, лежащих на сетке тиков, квантили точные; иначе ошибка
+ * не превышает половины тика.
+ */
+class tick_histogram {
+public:
+    static constexpr std::size_t PAGE_TICKS = 1024;             ///< Тиков на странице
+    /// Предельная ширина диапазона в страницах: ~8 КБ на страницу, до ~33 МБ при
+    /// полном диапазоне (при шаге 0.01 это ~42 тыс. единиц цены) - в пределах цели < 50 МБ
+    static constexpr std::size_t DEFAULT_MAX_PAGES = 1 << 12;
+
+    /**
+     * \brief Конструктор
+     * \param tick_size_ шаг ценовой сетки
+     * \param max_pages_ предельная ширина диапазона в страницах
+     * \throws std::invalid_argument если tick_size_ <= 0 или max_pages_ == 0
+     */
+    explicit tick_histogram(
+        double tick_size_ = 0.01,
+        std::size_t max_pages_ = DEFAULT_MAX_PAGES);
+
+    // Запрет копирования (страницы принадлежат гистограмме)
+    tick_histogram(const tick_histogram&) = delete;
+    tick_histogram& operator=(const tick_histogram&) = delete;
+
+    // Разрешение перемещения
+    tick_histogram(tick_histogram&&) noexcept = default;
+    tick_histogram& operator=(tick_histogram&&) noexcept = default;
+
+    /**
+     * \brief Добавляет значение в распределение
+     * \param value_ значение для добавления
+     *
+     * При выходе цены за текущий диапазон диапазон расширяется.
+     * Значения за пределами max_pages_ прижимаются к краю диапазона.
+     */
+    void add(double value_) noexcept(false);
+
+    /**
+     * \brief Удаляет из распределения count_ значений, добавленных ранее на тик tick_
+     * \param tick_ номер тика значений (to_tick() от значения, переданного в add())
+     * \param count_ сколько значений удалить
+     *
+     * После удалений границы q = 0 и q = 1 берутся по тикам,
+     * а не по точным min/max за всю историю. Сумма для mean() не меняется:
+     * исходные значения удалённых неизвестны, среднее по окну ведёт sliding_window.
+     */
+    void remove(std::int64_t tick_, std::uint64_t count_) noexcept;
+
+    /**
+     * \brief Переводит значение в номер тика
+     */
+    [[nodiscard]] std::int64_t to_tick(double value_) const noexcept;
+
+    /**
+     * \brief Вычисляет квантиль распределения
+     * \param q_ квантиль от 0 до 1
+     * \return значение квантиля
+     * \throws std::invalid_argument если q_ вне [0,1]
+     * \throws std::runtime_error если гистограмма пуста
+     */
+    [[nodiscard]] double quantile(double q_) const noexcept(false);
+
+    /**
+     * \brief Вычисляет медиану распределения
+     * \return медианное значение
+     */
+    [[nodiscard]] double median() const noexcept(false) { return quantile(0.5); }
+
+    /**
+     * \brief Вычисляет mean
+     * \return среднее значение (по исходным, не округлённым значениям)
+     */
+    [[nodiscard]] double mean() const noexcept;
+
+    /**
+     * \brief Вычисляет extra_values (mean, p90, p95, p99)
+     * \return extra_values (mean, p90, p95, p99)
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, double>> extra_values(std::vector<std::string> const values_name_) const noexcept(false);
+
+    /**
+     * \brief Возвращает количество добавленных элементов
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _total_count; }
+
+    /**
+     * \brief Проверяет, пуста ли гистограмма
+     */
+    [[nodiscard]] bool empty() const noexcept { return _total_count == 0; }
+
+    /**
+     * \brief Количество значений, прижатых к краю диапазона
+     */
+    [[nodiscard]] std::size_t clamped() const noexcept { return _clamped; }
+
+    /**
+     * \brief Занимаемая память в байтах (страницы и каталог)
+     */
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+private:
+    /**
+     * \brief Страница счётчиков - дерево Фенвика по PAGE_TICKS тикам
+     */
+    struct page {
+        std::array<std::uint64_t, PAGE_TICKS + 1> _tree{};  ///< Дерево Фенвика (1-индексация)
+        std::uint64_t _total{0};                            ///< Сумма счётчиков страницы
+
+        /**
+         * \brief Увеличивает счётчик тика
+         */
+        void add(std::size_t tick_) noexcept;
+
+        /**
+         * \brief Уменьшает счётчик тика на count_
+         */
+        void remove(std::size_t tick_, std::uint64_t count_) noexcept;
+
+        /**
+         * \brief Находит тик с заданным рангом внутри страницы
+         * \param rank_ ранг от 0 до _total - 1
+         */
+        [[nodiscard]] std::size_t select(std::uint64_t rank_) const noexcept;
+    };
+
+    /**
+     * \brief Расширяет каталог страниц так, чтобы он покрывал page_
+     * \return номер страницы внутри каталога (с учётом прижатия к краю)
+     */
+    [[nodiscard]] std::size_t ensure_page(std::int64_t page_) noexcept(false);
+
+    /**
+     * \brief Положение значения в каталоге
+     */
+    struct position {
+        std::size_t _page;  ///< Номер страницы в каталоге
+        std::size_t _tick;  ///< Тик внутри страницы
+        bool _clamped;      ///< Значение прижато к краю диапазона
+    };
+
+    /**
+     * \brief Находит страницу и тик внутри неё для номера тика
+     */
+    [[nodiscard]] position locate(std::int64_t tick_) noexcept(false);
+
+    /**
+     * \brief Перестраивает дерево Фенвика по страницам
+     */
+    void rebuild_page_tree() noexcept;
+
+    /**
+     * \brief Находит значение с заданным рангом
+     * \param rank_ ранг от 0 до size() - 1
+     */
+    [[nodiscard]] double select(std::uint64_t rank_) const noexcept;
+
+private:
+    static constexpr double MAX_DOUBLE = std::numeric_limits<double>::max();
+    static constexpr std::size_t INITIAL_PAGES = 16;
+
+    double _tick_size;                              ///< Шаг ценовой сетки
+    std::size_t _max_pages;                         ///< Предельная ширина диапазона
+    std::int64_t _first_page{0};                    ///< Номер первой страницы каталога
+    std::vector<std::unique_ptr<page>> _pages;      ///< Каталог страниц (выделяются лениво)
+    std::vector<std::uint64_t> _page_tree;          ///< Дерево Фенвика по страницам (1-индексация)
+    std::size_t _allocated_pages{0};                ///< Количество выделенных страниц
+    std::size_t _total_count{0};                    ///< Общее количество точек
+    std::size_t _clamped{0};                        ///< Прижатые к краю значения
+    bool _has_removals{false};                      ///< Были ли удаления (min/max устарели)
+    double _sum{0.0};                               ///< Сумма исходных значений
+    double _min_value{MAX_DOUBLE};                  ///< Минимальное значение
+    double _max_value{-MAX_DOUBLE};                 ///< Максимальное значение
+};
+
+}  // namespace app::statistics
+
+#endif  // TICK_HISTOGRAM_HPP
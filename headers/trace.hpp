@@ -0,0 +1,268 @@
+/**
+ * \file trace.hpp
+ * \brief Трассировка активности потоков в формате Chrome trace (Perfetto)
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Интервалы чтения, воронки, движка, вывода и записи на диск пишутся в
+ * кольцо событий своего потока без блокировок и выгружаются в JSON,
+ * который открывается в ui.perfetto.dev и chrome://tracing.
+ *
+ * Запись событий собирается только с определённым CSV_MEDIAN_TRACE
+ * (cmake -DCSV_MEDIAN_TRACE=ON). Без него trace_span, trace_batch и
+ * trace_thread - пустые встраиваемые заглушки и в горячих циклах ничего
+ * не стоят.
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace app::processing {
+
+#ifdef CSV_MEDIAN_TRACE
+inline constexpr bool TRACE_COMPILED = true;        ///< Запись событий собрана
+#else
+inline constexpr bool TRACE_COMPILED = false;       ///< Запись событий собрана
+#endif
+
+/**
+ * \brief Параметры трассировки (секция [trace] конфига)
+ */
+struct trace_settings {
+    std::filesystem::path _file;                    ///< JSON-файл трассы (пусто - трассировка выключена)
+    std::size_t _events_per_thread{1 << 16};        ///< Последних событий, хранимых на поток
+
+    /**
+     * \brief Включена ли трассировка
+     */
+    [[nodiscard]] bool enabled() const noexcept { return !_file.empty(); }
+};
+
+/**
+ * \brief Завершённый интервал
+ */
+struct trace_event {
+    const char* _name;                              ///< Имя (строковый литерал)
+    std::uint64_t _start;                           ///< Начало, нс от старта трассировки
+    std::uint64_t _end;                             ///< Конец, нс от старта трассировки
+};
+
+/**
+ * \brief Сборщик событий всех потоков
+ *
+ * Один на процесс. Каждый поток при первом событии получает своё кольцо
+ * (регистрация под мьютексом, один раз); дальше запись - без блокировок и
+ * атомарных RMW, переполнение затирает самые старые события. Выгрузка
+ * выполняется после остановки конвейера.
+ */
+class tracer {
+public:
+    /**
+     * \brief Экземпляр процесса
+     */
+    [[nodiscard]] static tracer& instance() noexcept;
+
+    // Запрет копирования
+    tracer(const tracer&) = delete;
+    tracer& operator=(const tracer&) = delete;
+
+    /**
+     * \brief Текущее время steady_clock в наносекундах
+     */
+    [[nodiscard]] static std::uint64_t now() noexcept
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * \brief Включает запись событий
+     *
+     * Без CSV_MEDIAN_TRACE только предупреждает, что трассировка не собрана.
+     */
+    void start(const trace_settings& settings_) noexcept(false);
+
+    /**
+     * \brief Выключает запись и выгружает трассу в файл
+     */
+    void stop() noexcept;
+
+    /**
+     * \brief Идёт ли запись
+     */
+    [[nodiscard]] bool enabled() const noexcept { return _enabled.load(std::memory_order_acquire); }
+
+    /**
+     * \brief Записывает интервал текущего потока
+     * \param name_ строковый литерал: указатель хранится до выгрузки
+     */
+    void record(const char* name_, std::uint64_t start_, std::uint64_t end_) noexcept;
+
+    /**
+     * \brief Задаёт имя текущего потока в трассе
+     */
+    static void name_thread(std::string name_) noexcept;
+
+    /**
+     * \brief Трасса в формате Chrome trace JSON
+     */
+    [[nodiscard]] std::string to_json() const noexcept(false);
+
+private:
+    tracer() = default;
+
+    /**
+     * \brief Кольцо событий одного потока (пишет только владелец)
+     */
+    struct thread_buffer {
+        std::string _name;                          ///< Имя потока
+        std::uint32_t _tid{0};                      ///< Номер потока в трассе
+        std::vector<trace_event> _events;           ///< Кольцо событий
+        std::atomic<std::uint64_t> _written{0};     ///< Записано событий всего
+    };
+
+    /**
+     * \brief Кольцо текущего потока; создаётся при первом обращении
+     * \return nullptr, если выделить кольцо не удалось
+     */
+    [[nodiscard]] thread_buffer* local() noexcept;
+
+private:
+    std::atomic<bool> _enabled{false};                  ///< Идёт запись
+    mutable std::mutex _mutex;                          ///< Мьютекс регистрации потоков и выгрузки
+    std::deque<thread_buffer> _buffers;                 ///< Кольца потоков (адреса стабильны)
+    trace_settings _settings;                           ///< Параметры
+    std::uint64_t _origin{0};                           ///< Время start() - ноль шкалы трассы
+};
+
+#ifdef CSV_MEDIAN_TRACE
+
+/**
+ * \brief Интервал на время жизни объекта
+ */
+class trace_span {
+public:
+    /**
+     * \param name_ строковый литерал
+     */
+    explicit trace_span(const char* name_) noexcept
+        : _name{tracer::instance().enabled() ? name_ : nullptr}
+        , _start{_name ? tracer::now() : 0}
+    {}
+
+    ~trace_span()
+    {
+        if (_name) {
+            tracer::instance().record(_name, _start, tracer::now());
+        }
+    }
+
+    // Запрет копирования
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+
+private:
+    const char* _name;                              ///< Имя или nullptr, если запись выключена
+    std::uint64_t _start;                           ///< Начало, нс
+};
+
+/**
+ * \brief Один интервал на каждые limit_ единиц поштучной работы
+ *
+ * Для циклов, где интервал на каждую строку сам стал бы нагрузкой:
+ * tick() после каждой строки, close() - перед ожиданием.
+ */
+class trace_batch {
+public:
+    /**
+     * \param name_ строковый литерал
+     * \param limit_ единиц работы в одном интервале
+     */
+    trace_batch(const char* name_, std::uint32_t limit_) noexcept
+        : _name{name_}
+        , _limit{limit_}
+    {}
+
+    ~trace_batch() { close(); }
+
+    // Запрет копирования
+    trace_batch(const trace_batch&) = delete;
+    trace_batch& operator=(const trace_batch&) = delete;
+
+    /**
+     * \brief Отмечает единицу работы
+     */
+    void tick() noexcept
+    {
+        if (_count == 0) {
+            if (!tracer::instance().enabled()) {
+                return;
+            }
+            _start = tracer::now();
+        }
+        if (++_count >= _limit) {
+            close();
+        }
+    }
+
+    /**
+     * \brief Закрывает текущий интервал
+     */
+    void close() noexcept
+    {
+        if (_count) {
+            tracer::instance().record(_name, _start, tracer::now());
+            _count = 0;
+        }
+    }
+
+private:
+    const char* _name;                              ///< Имя
+    std::uint32_t _limit;                           ///< Единиц работы в интервале
+    std::uint32_t _count{0};                        ///< Единиц в текущем интервале
+    std::uint64_t _start{0};                        ///< Начало текущего интервала, нс
+};
+
+/**
+ * \brief Задаёт имя текущего потока в трассе
+ */
+inline void trace_thread(std::string name_) noexcept
+{
+    tracer::name_thread(std::move(name_));
+}
+
+#else  // CSV_MEDIAN_TRACE
+
+class trace_span {
+public:
+    explicit trace_span(const char*) noexcept {}
+};
+
+class trace_batch {
+public:
+    trace_batch(const char*, std::uint32_t) noexcept {}
+    void tick() noexcept {}
+    void close() noexcept {}
+};
+
+inline void trace_thread(const char*) noexcept {}
+inline void trace_thread(const std::string&) noexcept {}
+
+#endif  // CSV_MEDIAN_TRACE
+
+}  // namespace app::processing
+
+#endif  // TRACE_HPP
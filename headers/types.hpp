@@ -11,24 +11,44 @@
 
 #include <cstdint>
 
+/**
+ * \brief Сторона заявки (колонка side)
+ */
+enum class trade_side : std::uint8_t {
+    unknown,    ///< Колонки нет или значение не распознано
+    bid,        ///< Покупка
+    ask         ///< Продажа
+};
+
 /**
  * \brief Структура для хранения данных из CSV
  * 
- * Содержит временную метку и цену из CSV файла.
+ * Содержит временные метки, цену, объём и сторону из CSV файла,
+ * а также индекс файла-источника.
  */
 class data {
 public:
     std::int_fast64_t receive_ts;   ///< Временная метка получения
     double price;                   ///< Цена
+    double quantity;                ///< Объём сделки (0, если колонки нет)
+    trade_side side;                ///< Сторона заявки
+    std::uint32_t source{0};        ///< Индекс файла-источника (порядок добавления в readers_manager)
+    std::int_fast64_t exchange_ts{0};   ///< Временная метка биржи (0, если колонки нет)
+    std::int_fast64_t read_time{0};     ///< Момент чтения строки (steady_clock, нс) для метрик задержки
     
     /**
      * \brief Конструктор
      * \param time_ временная метка
      * \param price_ цена
+     * \param quantity_ объём
+     * \param side_ сторона заявки
      */
-    data(std::int_fast64_t time_, double price_) noexcept:
+    data(std::int_fast64_t time_, double price_, double quantity_ = 0.0,
+         trade_side side_ = trade_side::unknown) noexcept:
         receive_ts{time_},
-        price{price_}
+        price{price_},
+        quantity{quantity_},
+        side{side_}
     {}
 };
 
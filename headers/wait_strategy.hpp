@@ -0,0 +1,165 @@
+/**
+ * \file wait_strategy.hpp
+ * \brief Стратегии ожидания потребителей очередей
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ * \version 1.0
+ *
+ * Потребитель, которому нечего брать, ждёт одним из способов - от
+ * постоянного опроса (меньше всего задержка, ядро занято целиком) до
+ * засыпания в ядре (задержка пробуждения, но простой не тратит CPU).
+ * Производители сообщают о новых данных через wake_signal.
+ */
+
+#ifndef WAIT_STRATEGY_HPP
+#define WAIT_STRATEGY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace app::processing {
+
+/**
+ * \brief Способ ожидания данных
+ */
+enum class wait_strategy {
+    blocking,       ///< Сразу засыпать (condition variable / futex)
+    busy_spin,      ///< Опрашивать непрерывно, не отдавая ядро
+    spin_yield,     ///< Опрашивать, затем уступать ядро через yield
+    spin_park       ///< Опрашивать, затем засыпать на futex (atomic::wait)
+};
+
+/**
+ * \brief Стратегии ожидания стадий (секция [wait] конфига)
+ */
+struct wait_settings {
+    wait_strategy _funnel{wait_strategy::spin_park};    ///< Воронка - ожидание строк ридеров
+    wait_strategy _calculator{wait_strategy::blocking}; ///< Калькулятор - ожидание общей очереди
+};
+
+/**
+ * \brief Имя стратегии в конфиге и отчётах
+ */
+[[nodiscard]] constexpr std::string_view wait_strategy_name(wait_strategy strategy_) noexcept
+{
+    switch (strategy_) {
+        case wait_strategy::blocking: return "blocking";
+        case wait_strategy::busy_spin: return "busy_spin";
+        case wait_strategy::spin_yield: return "spin_yield";
+        case wait_strategy::spin_park: return "spin_park";
+    }
+    return "unknown";
+}
+
+/**
+ * \brief Разбирает имя стратегии
+ * \return false, если имя неизвестно
+ */
+[[nodiscard]] constexpr bool parse_wait_strategy(std::string_view name_, wait_strategy& strategy_) noexcept
+{
+    for (const auto candidate : {wait_strategy::blocking, wait_strategy::busy_spin,
+                                 wait_strategy::spin_yield, wait_strategy::spin_park}) {
+        if (name_ == wait_strategy_name(candidate)) {
+            strategy_ = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief Подсказка процессору внутри цикла опроса
+ */
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#endif
+}
+
+/**
+ * \brief Сигнал о новых данных для одного или нескольких потребителей
+ *
+ * Производитель после публикации данных вызывает notify(). Потребитель
+ * запоминает epoch() до проверки данных и, если их нет, вызывает wait()
+ * с этим значением: уведомление после запоминания не теряется, так как
+ * меняет эпоху. Системный вызов пробуждения делается, только если кто-то
+ * спит.
+ */
+class wake_signal {
+public:
+    static constexpr std::uint32_t SPIN_LIMIT = 2000;   ///< Итераций опроса до yield / засыпания
+
+    wake_signal() = default;
+
+    // Запрет копирования
+    wake_signal(const wake_signal&) = delete;
+    wake_signal& operator=(const wake_signal&) = delete;
+
+    /**
+     * \brief Текущая эпоха - запоминается до проверки данных
+     */
+    [[nodiscard]] std::uint32_t epoch() const noexcept { return _epoch.load(); }
+
+    /**
+     * \brief Сообщает о новых данных или остановке
+     */
+    void notify() noexcept
+    {
+        _epoch.fetch_add(1);
+        if (_sleepers.load()) {
+            _epoch.notify_all();
+        }
+    }
+
+    /**
+     * \brief Ждёт смены эпохи seen_ выбранным способом
+     *
+     * blocking засыпает сразу, без опроса.
+     */
+    void wait(wait_strategy strategy_, std::uint32_t seen_) noexcept
+    {
+        if (strategy_ != wait_strategy::blocking) {
+            for (std::uint32_t i = 0; i < SPIN_LIMIT; ++i) {
+                if (_epoch.load(std::memory_order_acquire) != seen_) {
+                    return;
+                }
+                cpu_relax();
+            }
+        }
+
+        switch (strategy_) {
+            case wait_strategy::busy_spin:
+                while (_epoch.load(std::memory_order_acquire) == seen_) {
+                    cpu_relax();
+                }
+                return;
+            case wait_strategy::spin_yield:
+                while (_epoch.load(std::memory_order_acquire) == seen_) {
+                    std::this_thread::yield();
+                }
+                return;
+            case wait_strategy::blocking:
+            case wait_strategy::spin_park:
+                // Счётчик спящих виден notify() раньше, чем мы проверим эпоху в wait
+                _sleepers.fetch_add(1);
+                _epoch.wait(seen_);
+                _sleepers.fetch_sub(1);
+                return;
+        }
+    }
+
+private:
+    std::atomic<std::uint32_t> _epoch{0};           ///< Номер последнего уведомления
+    std::atomic<std::uint32_t> _sleepers{0};        ///< Потоков, спящих в wait
+};
+
+}  // namespace app::processing
+
+#endif  // WAIT_STRATEGY_HPP
@@ -16,20 +16,23 @@ namespace app::statistics {
 
 // ==================== centroid implementation ====================
 
-tdigest::centroid::centroid(double mean_, std::size_t count_) noexcept
+tdigest::centroid::centroid(double mean_, double count_) noexcept
     : _mean(mean_)
     , _count(count_)
 {}
 
-void tdigest::centroid::add(double value_) noexcept
+void tdigest::centroid::add(double value_, double weight_) noexcept
 {
-    _mean = (_mean * _count + value_) / (_count + 1);
-    ++_count;
+    _mean = (_mean * _count + value_ * weight_) / (_count + weight_);
+    _count += weight_;
 }
 
 void tdigest::centroid::merge(const centroid& other_) noexcept
 {
     const auto total = _count + other_._count;
+    if (total <= 0.0) {
+        return;
+    }
     _mean = (_mean * _count + other_._mean * other_._count) / total;
     _count = total;
 }
@@ -38,6 +41,7 @@ void tdigest::centroid::merge(const centroid& other_) noexcept
 
 tdigest::tdigest(std::size_t compression_)
     : _compression(compression_)
+    , _compress_at(compression_ * 2)
 {
     if (_compression == 0) {
         throw std::invalid_argument{"Compression parameter must be positive"};
@@ -47,7 +51,9 @@ tdigest::tdigest(std::size_t compression_)
 
 double tdigest::max_weight(double q_) const noexcept
 {
-    return WEIGHT_MULTIPLIER * _compression * q_ * (1.0 - q_);
+    // Предел веса центроида пропорционален общему весу: число центроидов
+    // ограничено порядка компрессии и не растёт вместе с потоком
+    return WEIGHT_MULTIPLIER * _total_weight * q_ * (1.0 - q_) / static_cast<double>(_compression);
 }
 
 std::size_t tdigest::find_nearest_centroid(double value_) const noexcept
@@ -77,44 +83,111 @@ std::size_t tdigest::total_count() const noexcept
     return _total_count;
 }
 
-void tdigest::add(double value_) noexcept
+void tdigest::add_weighted(double value_, double weight_) noexcept
 {
     if (value_ < _min_value) _min_value = value_;
     if (value_ > _max_value) _max_value = value_;
     
+    _unit_weight = weight_;
+    
     if (_centroids.empty()) {
-        _centroids.emplace_back(value_, 1);
+        _centroids.emplace_back(value_, weight_);
         _total_count = 1;
+        _total_weight = weight_;
+        _weighted_sum = value_ * weight_;
+        _median_index = 0;
+        _median_before = 0.0;
         return;
     }
     
     const std::size_t best_idx = find_nearest_centroid(value_);
-    
-    double cumulative = 0.0;
-    for (std::size_t i = 0; i < best_idx; ++i) {
-        cumulative += _centroids[i]._count;
-    }
+    const double cumulative = weight_before(best_idx);
     
     const double q = (cumulative + _centroids[best_idx]._count / 2.0) / 
-                     static_cast<double>(_total_count + 1);
+                     (_total_weight + weight_);
     
-    if (_centroids[best_idx]._count + 1 <= max_weight(q)) {
-        _centroids[best_idx].add(value_);
+    if (_centroids[best_idx]._count + weight_ <= max_weight(q)) {
+        _centroids[best_idx].add(value_, weight_);
+        if (best_idx < _median_index) {
+            _median_before += weight_;
+        }
     } else {
-        _centroids.emplace_back(value_, 1);
-        std::sort(_centroids.begin(), _centroids.end(),
-                    [](const centroid& a_, const centroid& b_) {
-                        return a_._mean < b_._mean;
-                    });
+        // Вставка на место вместо пересортировки всего вектора
+        const auto pos = std::upper_bound(_centroids.begin(), _centroids.end(), value_,
+            [](double val_, const centroid& c_) {
+                return val_ < c_._mean;
+            });
+        const auto index = static_cast<std::size_t>(pos - _centroids.begin());
+        _centroids.emplace(pos, value_, weight_);
+        if (index <= _median_index) {
+            ++_median_index;
+            _median_before += weight_;
+        }
     }
     
     ++_total_count;
+    _total_weight += weight_;
+    _weighted_sum += value_ * weight_;
     
-    if (_centroids.size() > _compression * 2) {
+    if (_centroids.size() > _compress_at) {
         compress();
+    } else {
+        seek_median();
+    }
+}
+
+double tdigest::weight_before(std::size_t index_) const noexcept
+{
+    // Идём от ближайшей опоры: начала, медианного центроида или конца
+    const std::size_t size = _centroids.size();
+    const std::size_t from_median = index_ > _median_index ? index_ - _median_index : _median_index - index_;
+    double cumulative = 0.0;
+
+    if (index_ <= from_median) {
+        for (std::size_t i = 0; i < index_; ++i) {
+            cumulative += _centroids[i]._count;
+        }
+    } else if (size - index_ <= from_median) {
+        cumulative = _total_weight;
+        for (std::size_t i = index_; i < size; ++i) {
+            cumulative -= _centroids[i]._count;
+        }
+    } else if (index_ >= _median_index) {
+        cumulative = _median_before;
+        for (std::size_t i = _median_index; i < index_; ++i) {
+            cumulative += _centroids[i]._count;
+        }
+    } else {
+        cumulative = _median_before;
+        for (std::size_t i = index_; i < _median_index; ++i) {
+            cumulative -= _centroids[i]._count;
+        }
+    }
+    return cumulative;
+}
+
+void tdigest::seek_median() noexcept
+{
+    // Медиана сдвигается на половину веса вставки - обычно не дальше соседнего центроида
+    const double target = 0.5 * _total_weight;
+    while (_median_index > 0 && target < _median_before) {
+        --_median_index;
+        _median_before -= _centroids[_median_index]._count;
+    }
+    while (_median_index + 1 < _centroids.size()
+           && target >= _median_before + _centroids[_median_index]._count) {
+        _median_before += _centroids[_median_index]._count;
+        ++_median_index;
     }
 }
 
+void tdigest::reset_median() noexcept
+{
+    _median_index = 0;
+    _median_before = 0.0;
+    seek_median();
+}
+
 void tdigest::compress()
 {
     if (_centroids.size() <= 1) return;
@@ -130,6 +203,11 @@ void tdigest::compress()
     double cumulative = 0.0;
     
     for (const auto& c : _centroids) {
+        // Полностью затухшие центроиды больше не влияют на квантили
+        if (c._count <= 0.0) {
+            continue;
+        }
+        
         if (compressed.empty()) {
             compressed.push_back(c);
             cumulative += c._count;
@@ -137,7 +215,7 @@ void tdigest::compress()
         }
         
         auto& last = compressed.back();
-        const double q = cumulative / static_cast<double>(_total_count);
+        const double q = cumulative / _total_weight;
         
         if (last._count + c._count <= max_weight(q)) {
             last.merge(c);
@@ -149,6 +227,11 @@ void tdigest::compress()
     }
     
     _centroids = std::move(compressed);
+    reset_median();
+
+    // У хвостов предел веса мал, и после сжатия центроидов может остаться больше
+    // 2 * компрессии; следующее сжатие - после удвоения, а не на каждой вставке
+    _compress_at = std::max(_compression * 2, _centroids.size() * 2);
 }
 
 double tdigest::quantile(double q_) const noexcept(false)
@@ -166,27 +249,15 @@ double tdigest::quantile(double q_) const noexcept(false)
     if (q_ == 0.0) return _min_value;
     if (q_ == 1.0) return _max_value;
     
-    const double target = q_ * static_cast<double>(_total_count);
+    const double target = q_ * _total_weight;
     double cumulative = 0.0;
     
     for (std::size_t i = 0; i < _centroids.size(); ++i) {
         const auto& c = _centroids[i];
-        const double next = cumulative + static_cast<double>(c._count);
+        const double next = cumulative + c._count;
         
         if (target < next) {
-            if (c._count == 1) {
-                return c._mean;
-            }
-            
-            const double left_bound = (i > 0) ? _centroids[i - 1]._mean : _min_value;
-            const double right_bound = (i < _centroids.size() - 1) ? 
-                                        _centroids[i + 1]._mean : _max_value;
-            
-            const double left_quantile = cumulative / static_cast<double>(_total_count);
-            const double right_quantile = next / static_cast<double>(_total_count);
-            const double t = (q_ - left_quantile) / (right_quantile - left_quantile);
-            
-            return left_bound + (right_bound - left_bound) * t;
+            return interpolate(i, cumulative, q_);
         }
         
         cumulative = next;
@@ -195,13 +266,39 @@ double tdigest::quantile(double q_) const noexcept(false)
     return _centroids.back()._mean;
 }
 
-double tdigest::mean() const noexcept
+double tdigest::median() const noexcept(false)
+{
+    if (_centroids.empty()) {
+        throw std::runtime_error{"Cannot compute quantile from empty digest"};
+    }
+    // Медианный центроид и вес левее него поддерживаются при вставке
+    return interpolate(_median_index, _median_before, 0.5);
+}
+
+double tdigest::interpolate(std::size_t index_, double before_, double q_) const noexcept
 {
-    double mean_centroids_sum{0};
-    for (auto& centroid : _centroids) {
-        mean_centroids_sum += centroid._mean;
+    const auto& c = _centroids[index_];
+    
+    // Одиночная точка (или центроид не тяжелее одной свежей точки)
+    if (c._count <= _unit_weight) {
+        return c._mean;
     }
-    return mean_centroids_sum / _total_count;
+    
+    const double left_bound = (index_ > 0) ? _centroids[index_ - 1]._mean : _min_value;
+    const double right_bound = (index_ < _centroids.size() - 1) ? 
+                                _centroids[index_ + 1]._mean : _max_value;
+    
+    const double left_quantile = before_ / _total_weight;
+    const double right_quantile = (before_ + c._count) / _total_weight;
+    const double t = (q_ - left_quantile) / (right_quantile - left_quantile);
+    
+    return left_bound + (right_bound - left_bound) * t;
+}
+
+double tdigest::mean() const noexcept
+{
+    // Взвешенная сумма ведётся при вставке - центроиды не обходим
+    return _total_weight > 0.0 ? _weighted_sum / _total_weight : 0.0;
 }
 
 std::vector<std::pair<std::string, double>> tdigest::extra_values(std::vector<std::string> const values_name_) const noexcept
@@ -224,4 +321,38 @@ std::vector<std::pair<std::string, double>> tdigest::extra_values(std::vector<st
     return _result;
 }
 
+void tdigest::merge(const tdigest& other_) noexcept(false)
+{
+    if (other_._centroids.empty()) {
+        return;
+    }
+
+    _centroids.insert(_centroids.end(), other_._centroids.begin(), other_._centroids.end());
+    _total_count += other_._total_count;
+    _total_weight += other_._total_weight;
+    _weighted_sum += other_._weighted_sum;
+    _unit_weight = std::max(_unit_weight, other_._unit_weight);
+    _min_value = std::min(_min_value, other_._min_value);
+    _max_value = std::max(_max_value, other_._max_value);
+
+    // compress() сортирует центроиды и заново находит медиану
+    compress();
+}
+
+void tdigest::scale(double factor_) noexcept
+{
+    for (auto& c : _centroids) {
+        c._count *= factor_;
+    }
+    _total_weight *= factor_;
+    _weighted_sum *= factor_;
+    _median_before *= factor_;
+    _unit_weight *= factor_;
+}
+
+std::size_t tdigest::memory_bytes() const noexcept
+{
+    return sizeof(*this) + _centroids.capacity() * sizeof(centroid);
+}
+
 }  // namespace app::statistics
\ No newline at end of file
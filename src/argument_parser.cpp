@@ -18,10 +18,18 @@ namespace {
     constexpr std::string_view HELP_OPTION = "help";
     constexpr std::string_view DEFAULT_CONFIG = "config.toml";
     constexpr std::string_view STREAMING_MODE = "streaming-mode";
+    constexpr std::string_view CALIBRATE = "calibrate";
     constexpr std::string_view MEAN_VALUE = "mean";
     constexpr std::string_view P90_VALUE = "p90";
     constexpr std::string_view P95_VALUE = "p95";
     constexpr std::string_view P99_VALUE = "p99";
+    constexpr std::string_view COUNT_VALUE = "count";
+    constexpr std::string_view SUM_VALUE = "sum";
+    constexpr std::string_view MIN_VALUE = "min";
+    constexpr std::string_view MAX_VALUE = "max";
+    constexpr std::string_view VARIANCE_VALUE = "variance";
+    constexpr std::string_view STDDEV_VALUE = "stddev";
+    constexpr std::string_view VWAP_VALUE = "vwap";
     
     /**
      * \brief Кастомный парсер для флага -cfg
@@ -69,10 +77,18 @@ boost::program_options::options_description create_options_description() noexcep
              std::string{DEFAULT_CONFIG}),
          "Path to configuration file (can use -config, -cfg or -cfg=FILE)")
         (std::string{STREAMING_MODE}.c_str(), "Enable streaming mode (flag, no arguments needed)")
+        (std::string{CALIBRATE}.c_str(), "Pick digest compression on a sample of the input, print the report and exit")
         (std::string{MEAN_VALUE}.c_str(), "Enable mean value calculate")
         (std::string{P90_VALUE}.c_str(), "Enable p90 quantile calculate")
         (std::string{P95_VALUE}.c_str(), "Enable p95 quantile calculate")
-        (std::string{P99_VALUE}.c_str(), "Enable p99 quantile calculate");
+        (std::string{P99_VALUE}.c_str(), "Enable p99 quantile calculate")
+        (std::string{COUNT_VALUE}.c_str(), "Enable price count output")
+        (std::string{SUM_VALUE}.c_str(), "Enable price sum output")
+        (std::string{MIN_VALUE}.c_str(), "Enable min price output")
+        (std::string{MAX_VALUE}.c_str(), "Enable max price output")
+        (std::string{VARIANCE_VALUE}.c_str(), "Enable price variance calculate")
+        (std::string{STDDEV_VALUE}.c_str(), "Enable price standard deviation calculate")
+        (std::string{VWAP_VALUE}.c_str(), "Enable volume-weighted average price calculate");
     return desc;
 }
 
@@ -100,6 +116,10 @@ parsing_result parse_arguments(int argc_, char* argv_[]) noexcept(false) {
         if (result._variables.count(std::string{STREAMING_MODE})) {
             result._streaming_mode = true;
         }
+
+        if (result._variables.count(std::string{CALIBRATE})) {
+            result._calibrate = true;
+        }
         
     } catch (const boost::program_options::error& e_) {
         throw std::invalid_argument{
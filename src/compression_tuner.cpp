@@ -0,0 +1,162 @@
+/**
+ * \file compression_tuner.cpp
+ * \brief Реализация подбора компрессии T-Digest
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "compression_tuner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace app::statistics {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t CHECKPOINTS = 4;                  ///< Точек проверки ошибки на выборке (последняя - её конец)
+
+/**
+ * \brief Ошибка ранга оценки value_ квантиля q_ по отсортированной выборке
+ */
+[[nodiscard]] double rank_error(const std::vector<double>& sorted_, double q_, double value_) noexcept
+{
+    const auto size = static_cast<double>(sorted_.size());
+    const auto low = static_cast<double>(std::lower_bound(sorted_.begin(), sorted_.end(), value_) - sorted_.begin()) / size;
+    const auto high = static_cast<double>(std::upper_bound(sorted_.begin(), sorted_.end(), value_) - sorted_.begin()) / size;
+    if (q_ < low) {
+        return low - q_;
+    }
+    return q_ > high ? q_ - high : 0.0;
+}
+
+/**
+ * \brief Прогоняет движок Engine с компрессией compression_ по выборке
+ * \param prefixes_ отсортированные начала выборки - точки проверки ошибки
+ */
+template <quantile_estimator Engine>
+[[nodiscard]] tuning_result evaluate(
+    const std::vector<double>& sample_,
+    const std::vector<std::vector<double>>& prefixes_,
+    engine_settings engine_,
+    const tuning_settings& settings_,
+    std::size_t compression_)
+{
+    engine_._compression = compression_;
+    auto engine = make_engine<Engine>(engine_);
+
+    tuning_result result;
+    result._compression = compression_;
+    result._rank_errors.assign(settings_._quantiles.size(), 0.0);
+
+    // Калькулятор выводит квантили на всём потоке, поэтому ошибка проверяется не только в конце
+    std::chrono::duration<double> elapsed{0.0};
+    std::size_t inserted = 0;
+    for (const auto& sorted : prefixes_) {
+        const auto start = clock_type::now();
+        for (; inserted < sorted.size(); ++inserted) {
+            engine.add(sample_[inserted]);
+        }
+        elapsed += clock_type::now() - start;
+
+        for (std::size_t i = 0; i < settings_._quantiles.size(); ++i) {
+            const auto q = settings_._quantiles[i];
+            result._rank_errors[i] = std::max(result._rank_errors[i], rank_error(sorted, q, engine.quantile(q)));
+        }
+    }
+    result._met = std::all_of(result._rank_errors.begin(), result._rank_errors.end(),
+        [&settings_](double error_) { return error_ <= settings_._max_rank_error; });
+    result._memory_bytes = engine.memory_bytes();
+    result._inserts_per_sec = elapsed.count() > 0.0 ? static_cast<double>(sample_.size()) / elapsed.count() : 0.0;
+    result._sample_rows = sample_.size();
+    return result;
+}
+
+/**
+ * \brief Поиск наименьшей прошедшей компрессии для движка Engine
+ */
+template <quantile_estimator Engine>
+[[nodiscard]] tuning_result search(
+    const std::vector<double>& sample_,
+    const engine_settings& engine_,
+    const tuning_settings& settings_)
+{
+    std::vector<std::vector<double>> prefixes;
+    for (std::size_t i = 1; i <= CHECKPOINTS; ++i) {
+        const auto size = sample_.size() * i / CHECKPOINTS;
+        if (size == 0 || (!prefixes.empty() && prefixes.back().size() == size)) {
+            continue;
+        }
+        auto& sorted = prefixes.emplace_back(sample_.begin(), sample_.begin() + static_cast<std::ptrdiff_t>(size));
+        std::sort(sorted.begin(), sorted.end());
+    }
+
+    std::size_t evaluations = 0;
+    const auto run = [&](std::size_t compression_) {
+        ++evaluations;
+        return evaluate<Engine>(sample_, prefixes, engine_, settings_, compression_);
+    };
+
+    // Удвоение до первого прошедшего значения
+    std::size_t failed = 0;
+    auto best = run(settings_._min_compression);
+    while (!best._met && best._compression < settings_._max_compression) {
+        failed = best._compression;
+        best = run(std::min(best._compression * 2, settings_._max_compression));
+    }
+
+    // Бинарный поиск в (failed, best._compression]
+    if (best._met) {
+        auto low = failed;
+        while (best._compression - low > 1) {
+            const auto middle = low + (best._compression - low) / 2;
+            auto candidate = run(middle);
+            if (candidate._met) {
+                best = std::move(candidate);
+            } else {
+                low = middle;
+            }
+        }
+    }
+
+    best._evaluations = evaluations;
+    return best;
+}
+
+} // unnamed namespace
+
+tuning_result tune_compression(
+    const std::vector<double>& sample_,
+    const engine_settings& engine_,
+    const tuning_settings& settings_) noexcept(false)
+{
+    if (sample_.empty()) {
+        throw std::invalid_argument{"Compression tuning needs a non-empty sample"};
+    }
+    if (settings_._min_compression == 0 || settings_._min_compression > settings_._max_compression) {
+        throw std::invalid_argument{"Compression tuning bounds must satisfy 0 < min <= max"};
+    }
+    if (settings_._quantiles.empty() || settings_._max_rank_error <= 0.0) {
+        throw std::invalid_argument{"Compression tuning needs quantiles and a positive error bound"};
+    }
+    for (const double q : settings_._quantiles) {
+        if (q < 0.0 || q > 1.0) {
+            throw std::invalid_argument{"Quantile must be in [0, 1]"};
+        }
+    }
+
+    switch (engine_._kind) {
+        case engine_kind::tdigest: return search<tdigest>(sample_, engine_, settings_);
+        case engine_kind::merging: return search<merging_digest>(sample_, engine_, settings_);
+        default: break;
+    }
+    throw std::invalid_argument{
+        "Compression tuning supports tdigest and merging engines, not " + std::string{engine_name(engine_._kind)}
+    };
+}
+
+}  // namespace app::statistics
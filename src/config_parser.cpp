@@ -11,11 +11,14 @@
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
 
 #include <boost/regex.hpp>
 #include <toml++/toml.hpp>
 
 #include "logger.hpp"
+#include "metric_expression.hpp"
 
 namespace app::config {
 
@@ -40,6 +43,336 @@ namespace {
         return result;
     }
     
+    /**
+     * \brief Извлекает параметры движка квантилей из секции [calculator]
+     */
+    [[nodiscard]] app::statistics::engine_settings extract_engine_settings(const toml::table& tbl_) {
+        app::statistics::engine_settings result;
+
+        const auto calculator = tbl_["calculator"];
+        if (!calculator.is_table()) {
+            return result;
+        }
+
+        result._kind = app::statistics::parse_engine_kind(
+            calculator["engine"].value_or(std::string{"tdigest"}));
+        result._compression = calculator["compression"].value_or(result._compression);
+        result._tick_size = calculator["tick_size"].value_or(result._tick_size);
+        result._max_pages = calculator["max_pages"].value_or(result._max_pages);
+        result._window_seconds = calculator["window_seconds"].value_or(result._window_seconds);
+        result._half_life_seconds = calculator["half_life_seconds"].value_or(result._half_life_seconds);
+        result._ts_per_second = calculator["ts_per_second"].value_or(result._ts_per_second);
+
+        // Шаг сетки метрики: ключ - выражение метрики без пробелов
+        if (const auto* ticks = calculator["metric_ticks"].as_table()) {
+            for (const auto& [metric, tick] : *ticks) {
+                result._metric_ticks.emplace_back(std::string{metric.str()}, tick.value_or(0.0));
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает параметры подбора компрессии из секции [calibration]
+     *
+     * Проверяются медиана и запрошенные в командной строке p90/p95/p99.
+     */
+    [[nodiscard]] app::statistics::tuning_settings extract_tuning_settings(
+        const toml::table& tbl_,
+        const std::vector<std::string>& extra_values_) {
+        app::statistics::tuning_settings result;
+
+        constexpr std::pair<std::string_view, double> QUANTILE_COLUMNS[] = {
+            {"p90", 0.90}, {"p95", 0.95}, {"p99", 0.99},
+        };
+        for (const auto& [column, q] : QUANTILE_COLUMNS) {
+            if (std::find(extra_values_.begin(), extra_values_.end(), column) != extra_values_.end()) {
+                result._quantiles.push_back(q);
+            }
+        }
+
+        const auto calibration = tbl_["calibration"];
+        if (!calibration.is_table()) {
+            return result;
+        }
+
+        result._max_rank_error = calibration["max_rank_error"].value_or(result._max_rank_error);
+        result._sample_rows = std::max<std::size_t>(calibration["sample_rows"].value_or(result._sample_rows), 1);
+        result._min_compression = std::max<std::size_t>(calibration["min_compression"].value_or(result._min_compression), 1);
+        result._max_compression = std::max(calibration["max_compression"].value_or(result._max_compression),
+                                           result._min_compression);
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает параметры группировки из секции [calculator]
+     *
+     * group_by задаётся строкой ("side") или массивом (["side", "file"]).
+     */
+    [[nodiscard]] app::processing::group_settings extract_group_settings(const toml::table& tbl_) {
+        app::processing::group_settings result;
+
+        const auto calculator = tbl_["calculator"];
+        if (!calculator.is_table()) {
+            return result;
+        }
+
+        const auto group_by = calculator["group_by"];
+        if (const auto* dimensions = group_by.as_array()) {
+            for (const auto& dimension : *dimensions) {
+                app::processing::add_group_dimension(result, dimension.value_or(std::string{}));
+            }
+        } else if (const auto dimension = group_by.value<std::string>(); dimension && *dimension != "none") {
+            app::processing::add_group_dimension(result, *dimension);
+        }
+        result._small_limit = calculator["group_small_limit"].value_or(result._small_limit);
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает выражения дополнительных метрик из секции [calculator]
+     * \throws std::invalid_argument при ошибке в выражении или без шага сетки метрики у histogram/window
+     */
+    [[nodiscard]] std::vector<std::string> extract_metrics(
+        const toml::table& tbl_,
+        const app::statistics::engine_settings& engine_settings_) {
+        std::vector<std::string> result;
+
+        const auto* metrics = tbl_["calculator"]["metrics"].as_array();
+        if (!metrics) {
+            return result;
+        }
+
+        for (const auto& metric : *metrics) {
+            auto text = metric.value_or(std::string{});
+            // Проверяем выражение сразу, чтобы ошибка не всплыла при старте калькулятора
+            const app::processing::metric_expression expression{text};
+            (void)app::statistics::metric_settings(engine_settings_, expression.name());
+            spdlog::info("Метрика: " ANSI_BLUE "{}" ANSI_RESET, text);
+            result.push_back(std::move(text));
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает параметры буферизации вывода из секции [output]
+     */
+    [[nodiscard]] app::io::output_settings extract_output_settings(const toml::table& tbl_) {
+        app::io::output_settings result;
+
+        const auto output = tbl_["output"];
+        if (!output.is_table()) {
+            return result;
+        }
+
+        result._format = app::io::parse_output_format(output["format"].value_or(std::string{"csv"}));
+        result._delta_timestamps = output["delta_timestamps"].value_or(result._delta_timestamps);
+        result._buffer_size = std::max<std::size_t>(output["buffer_size"].value_or(result._buffer_size), 1);
+        result._flush_interval = std::chrono::milliseconds{
+            std::max<std::int64_t>(output["flush_interval_ms"].value_or(result._flush_interval.count()), 1)
+        };
+        result._rotate_size = output["rotate_size"].value_or(result._rotate_size);
+        result._rotate_interval = std::chrono::seconds{
+            std::max<std::int64_t>(output["rotate_interval"].value_or(result._rotate_interval.count()), 0)
+        };
+
+        spdlog::info("Вывод в " ANSI_BLUE "{}" ANSI_RESET ", буфер " ANSI_BLUE "{}" ANSI_RESET
+                     " байт, сброс не реже раза в " ANSI_BLUE "{}" ANSI_RESET " мс",
+                     app::io::output_filename(result._format), result._buffer_size, result._flush_interval.count());
+        if (result.rotating()) {
+            spdlog::info("Ротация вывода: сегмент до " ANSI_BLUE "{}" ANSI_RESET " байт / "
+                         ANSI_BLUE "{}" ANSI_RESET " с (0 - без ограничения)",
+                         result._rotate_size, result._rotate_interval.count());
+        }
+        return result;
+    }
+
+    /**
+     * \brief Извлекает параметры публикации в разделяемую память из секции [publisher]
+     */
+    [[nodiscard]] app::io::publisher_settings extract_publisher_settings(const toml::table& tbl_) {
+        app::io::publisher_settings result;
+
+        const auto publisher = tbl_["publisher"];
+        if (!publisher.is_table()) {
+            return result;
+        }
+
+        result._name = publisher["name"].value_or(std::string{});
+        result._capacity = publisher["capacity"].value_or(result._capacity);
+
+        if (result.enabled()) {
+            spdlog::info("Публикация в разделяемую память " ANSI_YELLOW "{}" ANSI_RESET
+                         ", ячеек " ANSI_BLUE "{}" ANSI_RESET, result._name, result._capacity);
+        }
+        return result;
+    }
+
+    /**
+     * \brief Извлекает параметры выгрузки метрик конвейера из секции [stats]
+     * \param output_dir_ выходная директория, относительно которой задан файл
+     */
+    [[nodiscard]] app::processing::stats_settings extract_stats_settings(
+        const toml::table& tbl_,
+        const std::filesystem::path& output_dir_) {
+        app::processing::stats_settings result;
+
+        const auto stats = tbl_["stats"];
+        if (!stats.is_table()) {
+            return result;
+        }
+
+        const std::string file = stats["file"].value_or(std::string{});
+        if (!file.empty()) {
+            result._file = output_dir_ / file;
+        }
+        result._interval = std::chrono::milliseconds{
+            std::max<std::int64_t>(stats["interval_ms"].value_or(result._interval.count()), 0)
+        };
+
+        spdlog::info("Метрики конвейера: файл " ANSI_YELLOW "{}" ANSI_RESET ", период " ANSI_BLUE "{}" ANSI_RESET " мс",
+                     result._file.empty() ? std::string{"-"} : result._file.string(), result._interval.count());
+        return result;
+    }
+
+    /**
+     * \brief Извлекает параметры трассировки из секции [trace]
+     * \param output_dir_ выходная директория, относительно которой задан файл
+     */
+    [[nodiscard]] app::processing::trace_settings extract_trace_settings(
+        const toml::table& tbl_,
+        const std::filesystem::path& output_dir_) {
+        app::processing::trace_settings result;
+
+        const auto trace = tbl_["trace"];
+        if (!trace.is_table()) {
+            return result;
+        }
+
+        const std::string file = trace["file"].value_or(std::string{});
+        if (!file.empty()) {
+            result._file = output_dir_ / file;
+        }
+        result._events_per_thread = std::max<std::size_t>(
+            trace["events_per_thread"].value_or(result._events_per_thread), 1);
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает бюджет памяти из секции [memory]
+     */
+    [[nodiscard]] app::processing::memory_settings extract_memory_settings(const toml::table& tbl_) {
+        app::processing::memory_settings result;
+
+        const auto memory = tbl_["memory"];
+        if (!memory.is_table()) {
+            return result;
+        }
+
+        const double budget_mb = memory["budget_mb"].value_or(0.0);
+        if (budget_mb < 0.0) {
+            throw std::invalid_argument{"memory.budget_mb must not be negative"};
+        }
+        result._budget = static_cast<std::size_t>(budget_mb * 1024.0 * 1024.0);
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает размещение потоков из секций [threads] и [threads.<стадия>]
+     */
+    [[nodiscard]] app::processing::placement_settings extract_placement_settings(const toml::table& tbl_) {
+        app::processing::placement_settings result;
+
+        const auto threads = tbl_["threads"];
+        if (!threads.is_table()) {
+            return result;
+        }
+
+        result._isolate_calculator = threads["isolate_calculator"].value_or(false);
+        for (std::size_t i = 0; i < app::processing::STAGE_COUNT; ++i) {
+            const auto stage_name = app::processing::stage_name(static_cast<app::processing::pipeline_stage>(i));
+            const auto stage = threads[stage_name];
+            if (!stage.is_table()) {
+                continue;
+            }
+            auto& placement = result._stages[i];
+
+            // cpus = "0-3,6" или cpus = [0, 1, 2, 3]
+            if (const auto* list = stage["cpus"].as_array()) {
+                for (const auto& cpu : *list) {
+                    placement._cpus.push_back(static_cast<unsigned>(cpu.value_or(0)));
+                }
+                std::sort(placement._cpus.begin(), placement._cpus.end());
+                placement._cpus.erase(std::unique(placement._cpus.begin(), placement._cpus.end()), placement._cpus.end());
+            } else {
+                placement._cpus = app::processing::parse_cpu_list(stage["cpus"].value_or(std::string{}));
+            }
+            if (const auto priority = stage["priority"].value<std::string>()) {
+                placement._priority = app::processing::parse_priority(*priority);
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает стратегии ожидания стадий из секции [wait]
+     */
+    [[nodiscard]] app::processing::wait_settings extract_wait_settings(const toml::table& tbl_) {
+        app::processing::wait_settings result;
+
+        const auto wait = tbl_["wait"];
+        if (!wait.is_table()) {
+            return result;
+        }
+
+        const auto read = [&wait](const char* key_, app::processing::wait_strategy& strategy_) {
+            if (const auto name = wait[key_].value<std::string>()) {
+                if (!app::processing::parse_wait_strategy(*name, strategy_)) {
+                    throw std::invalid_argument{"Unknown wait strategy for " + std::string{key_} + ": " + *name};
+                }
+            }
+        };
+        read("funnel", result._funnel);
+        read("calculator", result._calculator);
+
+        return result;
+    }
+
+    /**
+     * \brief Извлекает политику вывода из секции [emission]
+     */
+    [[nodiscard]] app::processing::emission_settings extract_emission_settings(const toml::table& tbl_) {
+        app::processing::emission_settings result;
+
+        const auto emission = tbl_["emission"];
+        if (!emission.is_table()) {
+            return result;
+        }
+
+        result._min_interval = emission["min_interval"].value_or(result._min_interval);
+        result._abs_threshold = emission["abs_threshold"].value_or(result._abs_threshold);
+        result._rel_threshold = emission["rel_threshold"].value_or(result._rel_threshold);
+        result._every = std::max<std::size_t>(emission["every"].value_or(result._every), 1);
+        result._coalesce_timestamps = emission["coalesce_timestamps"].value_or(result._coalesce_timestamps);
+        result._conflate = emission["conflate"].value_or(result._conflate);
+        result._conflate_limit = std::max<std::size_t>(emission["conflate_limit"].value_or(result._conflate_limit), 1);
+
+        spdlog::info("Вывод: интервал " ANSI_BLUE "{}" ANSI_RESET ", порог " ANSI_BLUE "{}" ANSI_RESET
+                     "/" ANSI_BLUE "{}" ANSI_RESET ", каждое " ANSI_BLUE "{}" ANSI_RESET
+                     "-е, схлопывание " ANSI_BLUE "{}" ANSI_RESET,
+                     result._min_interval, result._abs_threshold, result._rel_threshold,
+                     result._every, result._conflate);
+
+        return result;
+    }
+
     /**
      * \brief Находит CSV файлы по маскам в директории
      */
@@ -102,17 +435,15 @@ parsing_result parse_configuration(
     
     config._config_file = config_path;
 
-    if (vm_.contains("mean")) {
-        config._extra_values_name.push_back("mean");
-    }
-    if (vm_.contains("p90")) {
-        config._extra_values_name.push_back("p90");
-    }
-    if (vm_.contains("p95")) {
-        config._extra_values_name.push_back("p95");
-    }
-    if (vm_.contains("p99")) {
-        config._extra_values_name.push_back("p99");
+    // Дополнительные колонки - в порядке вывода
+    constexpr std::string_view EXTRA_COLUMNS[] = {
+        "mean", "p90", "p95", "p99",
+        "count", "sum", "min", "max", "variance", "stddev", "vwap",
+    };
+    for (const auto column : EXTRA_COLUMNS) {
+        if (vm_.contains(std::string{column})) {
+            config._extra_values_name.emplace_back(column);
+        }
     }
     
     try {
@@ -151,6 +482,33 @@ parsing_result parse_configuration(
         spdlog::info("Выходная директория: " ANSI_YELLOW "{}" ANSI_RESET, config._output_dir.string());
         
         config._csv_filename_mask = extract_filename_masks(toml_file);
+        config._engine_settings = extract_engine_settings(toml_file);
+        spdlog::info("Движок квантилей: " ANSI_BLUE "{}" ANSI_RESET,
+                     app::statistics::engine_name(config._engine_settings._kind));
+        config._tuning_settings = extract_tuning_settings(toml_file, config._extra_values_name);
+        config._auto_compression = toml_file["calculator"]["compression"].value_or(std::string{}) == "auto";
+        config._group_settings = extract_group_settings(toml_file);
+        config._metrics = extract_metrics(toml_file, config._engine_settings);
+        config._emission_settings = extract_emission_settings(toml_file);
+        config._output_settings = extract_output_settings(toml_file);
+        config._publisher_settings = extract_publisher_settings(toml_file);
+        config._stats_settings = extract_stats_settings(toml_file, config._output_dir);
+        config._trace_settings = extract_trace_settings(toml_file, config._output_dir);
+        config._memory_settings = extract_memory_settings(toml_file);
+        config._placement_settings = extract_placement_settings(toml_file);
+        config._wait_settings = extract_wait_settings(toml_file);
+        if (config._output_settings._format == app::io::output_format::binary && config._group_settings.enabled()) {
+            spdlog::warn("Двоичный вывод не поддерживает группировку, используется " ANSI_BLUE "csv" ANSI_RESET);
+            config._output_settings._format = app::io::output_format::csv;
+        }
+        config._shards = std::max<std::size_t>(toml_file["calculator"]["shards"].value_or(config._shards), 1);
+        if (config._shards > 1) {
+            spdlog::info("Шардов: " ANSI_BLUE "{}" ANSI_RESET, config._shards);
+        }
+        if (config._group_settings.enabled()) {
+            spdlog::info("Группировка: сторона " ANSI_BLUE "{}" ANSI_RESET ", файл " ANSI_BLUE "{}" ANSI_RESET,
+                         config._group_settings._by_side, config._group_settings._by_file);
+        }
         
         if (!config._input_dir.empty()) {
             spdlog::info("Поиск " ANSI_MAGENTA "*.csv" ANSI_RESET " файлов...");
@@ -159,6 +517,8 @@ parsing_result parse_configuration(
                 config._csv_filename_mask
             );
             spdlog::info("Найдено файлов: " ANSI_GREEN "{}" ANSI_RESET, config._csv_files.size());
+            // Индекс источника строки - индекс файла в этом списке (передаётся в add_csv_file)
+            config._group_settings._sources = config._csv_files;
         } else {
             spdlog::critical("Директория " ANSI_YELLOW "{}" ANSI_RESET " пуста", config._input_dir.string());
             return config;
@@ -9,8 +9,8 @@
 
 #include <algorithm>
 #include <chrono>
-#include <iostream>
-#include <mutex>
+#include <fstream>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -20,6 +20,8 @@
 #include "data_queue.hpp"
 #include "types.hpp"
 #include "logger.hpp"
+#include "thread_placement.hpp"
+#include "trace.hpp"
 
 namespace app::io {
 
@@ -27,10 +29,12 @@ namespace {
     // Константы для парсинга
     constexpr char CSV_DELIMITER = ';';
     constexpr std::size_t TIMESTAMP_INDEX = 0;
+    constexpr std::size_t EXCHANGE_TS_INDEX = 1;
     constexpr std::size_t PRICE_INDEX = 2;
-    
-    // Мьютекс для синхронизации вывода (можно вынести в отдельный логгер)
-    std::mutex g_cout_mutex;
+    constexpr std::size_t QUANTITY_INDEX = 3;
+    constexpr std::size_t SIDE_INDEX = 4;
+    constexpr std::uint32_t TRACE_LINES = 1024;     ///< Строк в одном интервале трассы
+    constexpr std::uint32_t ADMIT_LINES = 256;      ///< Строк между проверками бюджета памяти
     
     /**
      * \brief Безопасно парсит строку в int64_t
@@ -58,11 +62,44 @@ namespace {
         }
     }
     
+    /**
+     * \brief Разбирает сторону заявки
+     */
+    [[nodiscard]] trade_side parse_side(const std::string& str_) noexcept
+    {
+        if (str_ == "bid") {
+            return trade_side::bid;
+        }
+        if (str_ == "ask") {
+            return trade_side::ask;
+        }
+        return trade_side::unknown;
+    }
+
+    /**
+     * \brief Файл выборки и его первая ещё не взятая строка
+     */
+    struct sample_source {
+        std::ifstream _file;                            ///< Входной файл
+        std::unique_ptr<data> _row;                     ///< Следующая строка (nullptr - файл кончился)
+    };
+
+    /**
+     * \brief Читает следующую распознанную строку файла выборки
+     */
+    void advance(sample_source& source_, std::string& line_) noexcept(false)
+    {
+        source_._row = nullptr;
+        while (!source_._row && std::getline(source_._file, line_)) {
+            source_._row = csv_reader::parse_line(line_);
+        }
+    }
+    
 } // unnamed namespace
 
 // ==================== csv_reader implementation ====================
 
-csv_reader::csv_reader(path_string filename_, data_queue_ptr tasks_, bool streamin_mode_)
+csv_reader::csv_reader(path_string filename_, data_queue_ptr tasks_, bool streamin_mode_, std::uint32_t source_)
     : _mapping{filename_.c_str(), boost::interprocess::read_only}
     , _region{_mapping, boost::interprocess::read_only}
     , _data{static_cast<const char*>(_region.get_address())}
@@ -71,8 +108,20 @@ csv_reader::csv_reader(path_string filename_, data_queue_ptr tasks_, bool stream
     , _filename{std::move(filename_)}
     , _tasks{std::move(tasks_)}
     , _streaming_mode{streamin_mode_}
+    , _source{source_}
 {
     _local_queue = std::make_shared<app::processing::data_queue>();
+    _counters = &app::processing::pipeline_metrics::instance().register_reader(_filename);
+    // Страницы отображения вытесняемы, поэтому в бюджет не входят, только в отчёт
+    _mappings = &app::processing::memory_budget::instance().account("mappings", false);
+    _mappings->add(static_cast<std::int64_t>(_size));
+}
+
+csv_reader::~csv_reader()
+{
+    if (_mappings) {
+        _mappings->add(-static_cast<std::int64_t>(_size));
+    }
 }
 
 csv_reader::csv_reader(csv_reader&& other_) noexcept
@@ -83,6 +132,10 @@ csv_reader::csv_reader(csv_reader&& other_) noexcept
     , _position{other_._position}
     , _filename{std::move(other_._filename)}
     , _tasks{std::move(other_._tasks)}
+    , _source{other_._source}
+    , _local_queue{std::move(other_._local_queue)}
+    , _counters{other_._counters}
+    , _mappings{other_._mappings}
 {
     other_._data = nullptr;
     other_._size = 0;
@@ -92,6 +145,9 @@ csv_reader::csv_reader(csv_reader&& other_) noexcept
 csv_reader& csv_reader::operator=(csv_reader&& other_) noexcept
 {
     if (this != &other_) {
+        if (_mappings) {
+            _mappings->add(-static_cast<std::int64_t>(_size));
+        }
         _mapping = std::move(other_._mapping);
         _region = std::move(other_._region);
         _data = other_._data;
@@ -99,6 +155,10 @@ csv_reader& csv_reader::operator=(csv_reader&& other_) noexcept
         _position = other_._position;
         _filename = std::move(other_._filename);
         _tasks = std::move(other_._tasks);
+        _source = other_._source;
+        _local_queue = std::move(other_._local_queue);
+        _counters = other_._counters;
+        _mappings = other_._mappings;
         
         other_._data = nullptr;
         other_._size = 0;
@@ -130,12 +190,25 @@ std::unique_ptr<data> csv_reader::parse_line(
             return nullptr;  // Ошибка парсинга чисел
         }
         
-        return std::make_unique<data>(*timestamp, *price);
+        // Объём необязателен: без него строка остаётся валидной для медианы
+        double quantity = 0.0;
+        if (split_line.size() > QUANTITY_INDEX) {
+            quantity = safe_parse_double(split_line[QUANTITY_INDEX]).value_or(0.0);
+        }
+        
+        trade_side side = trade_side::unknown;
+        if (split_line.size() > SIDE_INDEX) {
+            boost::trim_right(split_line[SIDE_INDEX]);
+            side = parse_side(split_line[SIDE_INDEX]);
+        }
+        
+        auto row = std::make_unique<data>(*timestamp, *price, quantity, side);
+        row->exchange_ts = safe_parse_int(split_line[EXCHANGE_TS_INDEX]).value_or(0);
+        return row;
         
     } catch (const std::exception& e_) {
-        // Логируем ошибку, но не прерываем выполнение
-        std::lock_guard<std::mutex> lock{g_cout_mutex};
-        spdlog::error("Parse error in line '{}': ", e_.what());
+        // Логируем ошибку, но не прерываем выполнение; битый файл не должен забить лог
+        LOG_LIMITED(spdlog::level::err, "Ошибка разбора строки '{}': {}", line_, e_.what());
         return nullptr;
     }
 }
@@ -145,6 +218,7 @@ void csv_reader::refresh(std::size_t position_) noexcept(false)
     _mapping = file_mapping{_filename.c_str(), boost::interprocess::read_only};
     _region = mapped_region{_mapping, boost::interprocess::read_only};
     _data = static_cast<const char*>(_region.get_address());
+    _mappings->add(static_cast<std::int64_t>(_region.get_size()) - static_cast<std::int64_t>(_size));
     _size = _region.get_size();
     _position = position_;
 }
@@ -154,6 +228,11 @@ void csv_reader::read_file(std::stop_token stoken_) noexcept(false)
     using namespace std::chrono_literals;
     
     std::string current_line;
+    app::processing::thread_placement::instance().apply(app::processing::pipeline_stage::readers);
+    app::processing::trace_thread("reader " + _filename);
+    app::processing::trace_batch parsing{"parse", TRACE_LINES};
+    auto& budget = app::processing::memory_budget::instance();
+    std::uint32_t admitted = 0;
     
     // Пропускаем заголовок (первую строку)
     while (_position < _size && _data[_position] != '\n') {
@@ -169,14 +248,31 @@ void csv_reader::read_file(std::stop_token stoken_) noexcept(false)
                 current_line += _data[_position++];
             }
             
+            // Строка без '\n' в потоковом режиме может быть дописана не до конца:
+            // она остаётся в current_line до следующего обновления файла
+            const bool complete = _position < _size || !_streaming_mode;
+
             // Обрабатываем прочитанную строку
-            if (!current_line.empty()) {
+            if (complete && !current_line.empty()) {
                 if (auto data = parse_line(current_line)) {
+                    data->source = _source;
+                    data->read_time = app::processing::pipeline_metrics::now();
                     _local_queue->push(std::move(data));
+                    _counters->_parsed.add();
+                } else {
+                    _counters->_rejected.add();
                 }
+                parsing.tick();
                 current_line.clear();
+                // Очереди разбухли сверх бюджета - ждём калькулятор, а не читаем дальше
+                if (++admitted == ADMIT_LINES) {
+                    admitted = 0;
+                    budget.admit(stoken_);
+                }
+            }
+            if (_position < _size) {
+                ++_position;  // Пропускаем '\n'
             }
-            ++_position;  // Пропускаем '\n'
             
             // Проверяем, не вышли ли за границы файла
             if (_position >= _size) {
@@ -187,11 +283,16 @@ void csv_reader::read_file(std::stop_token stoken_) noexcept(false)
                     _existing_data_has_been_processed = false;
                 }
 
+                parsing.close();
                 const auto previous_size = _size;
-                refresh(_position);
+                {
+                    app::processing::trace_span span{"refresh"};
+                    refresh(_position);
+                }
                 
                 // Если файл не вырос - ждём
                 if (_size <= previous_size) {
+                    app::processing::trace_span span{"sleep"};
                     std::this_thread::sleep_for(100ms);
                 } else {
                     _existing_data_has_been_processed = true;
@@ -202,15 +303,56 @@ void csv_reader::read_file(std::stop_token stoken_) noexcept(false)
             
             
         } catch (const std::exception& e_) {
-            std::lock_guard<std::mutex> lock{g_cout_mutex};
-            std::cerr << "Error reading file " << _filename << ": " 
-                      << e_.what() << std::endl;
+            LOG_LIMITED(spdlog::level::err, "Ошибка чтения файла {}: {}", _filename, e_.what());
             
             // Пытаемся восстановиться
             current_line.clear();
             std::this_thread::sleep_for(1s);
         }
     }
+
+    // Итог по файлу вместо сообщения на каждую строку
+    if (const auto rejected = _counters->_rejected.load()) {
+        spdlog::warn("Отброшено строк с ошибкой разбора: " ANSI_YELLOW "{}" ANSI_RESET " в {}", rejected, _filename);
+    }
+}
+
+std::vector<double> read_price_sample(
+    const std::vector<std::string>& files_,
+    std::size_t rows_) noexcept(false)
+{
+    std::vector<double> result;
+    if (files_.empty()) {
+        return result;
+    }
+    result.reserve(rows_);
+
+    std::string line;
+    std::vector<sample_source> sources;
+    sources.reserve(files_.size());
+    for (const auto& filename : files_) {
+        auto& source = sources.emplace_back(sample_source{std::ifstream{filename, std::ios::binary}, nullptr});
+        if (!source._file) {
+            throw std::runtime_error{"Failed to open " + filename};
+        }
+        advance(source, line);
+    }
+
+    // Слияние по receive_ts, как в воронке ридеров: выборка - начало потока калькулятора
+    while (result.size() < rows_) {
+        sample_source* earliest = nullptr;
+        for (auto& source : sources) {
+            if (source._row && (!earliest || source._row->receive_ts < earliest->_row->receive_ts)) {
+                earliest = &source;
+            }
+        }
+        if (!earliest) {
+            break;
+        }
+        result.push_back(earliest->_row->price);
+        advance(*earliest, line);
+    }
+    return result;
 }
 
 }  // namespace app::io
@@ -19,7 +19,10 @@ data_queue::data_queue(data_queue&& other_) noexcept
 {
     std::lock_guard<std::mutex> lock{other_._mutex};
     _tasks = std::move(other_._tasks);
+    _depth.store(_tasks.size());
+    other_._depth.store(0);
     _stopped.store(other_._stopped.load());
+    _strategy = other_._strategy;
 }
 
 data_queue& data_queue::operator=(data_queue&& other_) noexcept
@@ -27,7 +30,10 @@ data_queue& data_queue::operator=(data_queue&& other_) noexcept
     if (this != &other_) {
         std::scoped_lock lock{_mutex, other_._mutex};
         _tasks = std::move(other_._tasks);
+        _depth.store(_tasks.size());
+        other_._depth.store(0);
         _stopped.store(other_._stopped.load());
+        _strategy = other_._strategy;
     }
     return *this;
 }
@@ -36,18 +42,29 @@ data_queue& data_queue::operator=(data_queue&& other_) noexcept
 
 void data_queue::push(std::unique_ptr<data> task_) noexcept(false)
 {
+    bool was_empty = false;
     {
         std::lock_guard<std::mutex> lock{_mutex};
+        was_empty = _tasks.empty();
         _tasks.push(std::move(task_));
+        _depth.store(_tasks.size(), std::memory_order_relaxed);
+        if (_tasks.size() > _high_water.load(std::memory_order_relaxed)) {
+            _high_water.store(_tasks.size(), std::memory_order_relaxed);
+        }
     }
     
     // Уведомляем один ожидающий поток
     _condition.notify_one();
+    // Потребитель ждёт сигнала только на пустой очереди
+    if (was_empty) {
+        _signal->notify();
+    }
 }
 
 //изменить на pop() без ожидания (все потребители будут ожидать самостоятельно)
 std::unique_ptr<data> data_queue::pop() noexcept(false)
 {
+    await_tasks();
     std::unique_lock<std::mutex> lock{_mutex}; 
     // Ждём пока появятся данные или не будет остановки
     _condition.wait(lock, [this] {
@@ -63,11 +80,46 @@ std::unique_ptr<data> data_queue::pop() noexcept(false)
     if (!_tasks.empty()) {
         result = std::move(_tasks.front());
         _tasks.pop();
+        _depth.store(_tasks.size(), std::memory_order_relaxed);
         ++_total_count;
     }
     return result;
 }
 
+std::size_t data_queue::pop_batch(std::vector<std::unique_ptr<data>>& batch_, std::size_t max_) noexcept(false)
+{
+    await_tasks();
+    std::unique_lock<std::mutex> lock{_mutex};
+    _condition.wait(lock, [this] {
+        return !_tasks.empty() || _stopped.load();
+    });
+
+    std::size_t count = 0;
+    while (!_tasks.empty() && count < max_) {
+        batch_.push_back(std::move(_tasks.front()));
+        _tasks.pop();
+        ++count;
+    }
+    _depth.store(_tasks.size(), std::memory_order_relaxed);
+    _total_count += count;
+    return count;
+}
+
+void data_queue::await_tasks() noexcept
+{
+    if (_strategy == wait_strategy::blocking) {
+        return;
+    }
+    // Эпоха берётся до проверки: push после неё не потеряется
+    for (;;) {
+        const auto seen = _signal->epoch();
+        if (_depth.load(std::memory_order_acquire) > 0 || _stopped.load()) {
+            return;
+        }
+        _signal->wait(_strategy, seen);
+    }
+}
+
 bool data_queue::empty() const noexcept
 {
     std::lock_guard<std::mutex> lock{_mutex};
@@ -78,6 +130,7 @@ void data_queue::stop() noexcept
 {
     _stopped.store(true);
     _condition.notify_all();  // Будим все ожидающие потоки
+    _signal->notify();
 }
 
 std::atomic<bool> data_queue::is_stopped() noexcept
@@ -0,0 +1,43 @@
+/**
+ * \file decayed_tdigest.cpp
+ * \brief Реализация T-Digest с экспоненциальным затуханием
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "decayed_tdigest.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace app::statistics {
+
+decayed_tdigest::decayed_tdigest(double half_life_, std::size_t compression_)
+    : _digest{compression_}
+    , _half_life{half_life_}
+{
+    if (!(_half_life > 0.0)) {
+        throw std::invalid_argument{"Half-life must be positive"};
+    }
+}
+
+void decayed_tdigest::add(double value_, std::int_fast64_t timestamp_) noexcept
+{
+    if (!_has_landmark) {
+        _landmark = timestamp_;
+        _has_landmark = true;
+    }
+
+    double exponent = static_cast<double>(timestamp_ - _landmark) / _half_life;
+
+    // Веса растут экспоненциально - переносим опорную метку и перенормируем
+    if (exponent > RESCALE_EXPONENT) {
+        _digest.scale(std::exp2(-exponent));
+        _landmark = timestamp_;
+        exponent = 0.0;
+    }
+
+    _digest.add_weighted(value_, std::exp2(exponent));
+}
+
+}  // namespace app::statistics
@@ -0,0 +1,71 @@
+/**
+ * \file emission_policy.cpp
+ * \brief Реализация политики вывода строк результата
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "emission_policy.hpp"
+
+#include <cmath>
+
+namespace app::processing {
+
+bool emission_state::should_emit(
+    const emission_settings& settings_,
+    std::int_fast64_t timestamp_,
+    double median_) noexcept
+{
+    ++_updates;
+
+    // Подавленное значение ждёт следующей строки или flush()
+    _pending_timestamp = timestamp_;
+    _pending_median = median_;
+    _pending = true;
+
+    // Первое значение выводим всегда
+    if (_emitted) {
+        if (_updates < settings_._every) {
+            return false;
+        }
+        if (timestamp_ - _last_timestamp < settings_._min_interval) {
+            return false;
+        }
+        const double change = std::abs(median_ - _last_median);
+        if (change <= settings_._abs_threshold) {
+            return false;
+        }
+        if (settings_._rel_threshold > 0.0 && change <= settings_._rel_threshold * std::abs(_last_median)) {
+            return false;
+        }
+    }
+
+    _last_timestamp = timestamp_;
+    _last_median = median_;
+    _updates = 0;
+    _pending = false;
+    _emitted = true;
+    return true;
+}
+
+bool emission_state::flush(std::int_fast64_t& timestamp_, double& median_) noexcept
+{
+    if (!_pending) {
+        return false;
+    }
+    _pending = false;
+
+    // Потребители уже знают это значение
+    if (_pending_median == _last_median) {
+        return false;
+    }
+
+    _last_timestamp = _pending_timestamp;
+    _last_median = _pending_median;
+    _updates = 0;
+    timestamp_ = _pending_timestamp;
+    median_ = _pending_median;
+    return true;
+}
+
+}  // namespace app::processing
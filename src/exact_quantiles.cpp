@@ -0,0 +1,168 @@
+/**
+ * \file exact_quantiles.cpp
+ * \brief Реализация точных квантилей
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "exact_quantiles.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+namespace app::statistics {
+
+void exact_quantiles::add(double value_) noexcept(false)
+{
+    _sum += value_;
+    ++_size;
+
+    if (_blocks.empty()) {
+        _blocks.emplace_back().push_back(value_);
+        _tree.assign(2, 1);
+        return;
+    }
+
+    // Последний блок, первое значение которого не больше value_
+    const auto found = std::upper_bound(_blocks.begin(), _blocks.end(), value_,
+        [](double val_, const std::vector<double>& block_) {
+            return val_ < block_.front();
+        });
+    const auto index = static_cast<std::size_t>(std::max<std::ptrdiff_t>(found - _blocks.begin(), 1) - 1);
+
+    auto& block = _blocks[index];
+    block.insert(std::upper_bound(block.begin(), block.end(), value_), value_);
+
+    if (block.size() < 2 * BLOCK_SIZE) {
+        for (std::size_t i = index + 1; i < _tree.size(); i += i & (~i + 1)) {
+            ++_tree[i];
+        }
+        return;
+    }
+
+    // Блок переполнен - делим пополам; деление раз в BLOCK_SIZE вставок,
+    // поэтому перестроение дерева за O(число блоков) амортизируется
+    std::vector<double> upper(block.begin() + BLOCK_SIZE, block.end());
+    block.resize(BLOCK_SIZE);
+    _blocks.insert(_blocks.begin() + static_cast<std::ptrdiff_t>(index) + 1, std::move(upper));
+    rebuild_tree();
+}
+
+void exact_quantiles::merge(const exact_quantiles& other_) noexcept(false)
+{
+    for (const auto& block : other_._blocks) {
+        for (const double value : block) {
+            add(value);
+        }
+    }
+}
+
+void exact_quantiles::rebuild_tree() noexcept
+{
+    const std::size_t count = _blocks.size();
+    _tree.assign(count + 1, 0);
+
+    for (std::size_t i = 1; i <= count; ++i) {
+        _tree[i] += _blocks[i - 1].size();
+        const std::size_t parent = i + (i & (~i + 1));
+        if (parent <= count) {
+            _tree[parent] += _tree[i];
+        }
+    }
+}
+
+std::size_t exact_quantiles::count_before(std::size_t blocks_) const noexcept
+{
+    std::size_t count = 0;
+    for (std::size_t i = blocks_; i > 0; i -= i & (~i + 1)) {
+        count += _tree[i];
+    }
+    return count;
+}
+
+double exact_quantiles::select(std::size_t rank_) const noexcept
+{
+    const std::size_t count = _blocks.size();
+    std::size_t pos = 0;
+    for (std::size_t step = std::bit_floor(count); step > 0; step >>= 1) {
+        if (pos + step <= count && _tree[pos + step] <= rank_) {
+            pos += step;
+            rank_ -= _tree[pos];
+        }
+    }
+    return _blocks[pos][rank_];
+}
+
+double exact_quantiles::quantile(double q_) const noexcept(false)
+{
+    if (q_ < 0.0 || q_ > 1.0) {
+        throw std::invalid_argument{
+            "Quantile must be in range [0, 1], got: " + std::to_string(q_)
+        };
+    }
+
+    if (_size == 0) {
+        throw std::runtime_error{"Cannot compute quantile from empty set"};
+    }
+
+    const double position = q_ * static_cast<double>(_size - 1);
+    const auto lower = static_cast<std::size_t>(position);
+    const double fraction = position - static_cast<double>(lower);
+
+    const double value = select(lower);
+    if (lower + 1 >= _size || fraction == 0.0) {
+        return value;
+    }
+    return value + (select(lower + 1) - value) * fraction;
+}
+
+double exact_quantiles::mean() const noexcept
+{
+    return _size == 0 ? 0.0 : _sum / static_cast<double>(_size);
+}
+
+double exact_quantiles::rank(double value_) const noexcept
+{
+    if (_size == 0) {
+        return 0.0;
+    }
+
+    // Блоки левее последнего блока, начинающегося не больше value_, целиком не больше value_
+    const auto found = std::upper_bound(_blocks.begin(), _blocks.end(), value_,
+        [](double val_, const std::vector<double>& block_) {
+            return val_ < block_.front();
+        });
+    const auto index = static_cast<std::size_t>(found - _blocks.begin());
+    if (index == 0) {
+        return 0.0;
+    }
+
+    const auto& block = _blocks[index - 1];
+    const auto within = static_cast<std::size_t>(std::upper_bound(block.begin(), block.end(), value_) - block.begin());
+    return static_cast<double>(count_before(index - 1) + within) / static_cast<double>(_size);
+}
+
+std::vector<double> exact_quantiles::values() const noexcept(false)
+{
+    std::vector<double> result;
+    result.reserve(_size);
+    for (const auto& block : _blocks) {
+        result.insert(result.end(), block.begin(), block.end());
+    }
+    return result;
+}
+
+std::size_t exact_quantiles::memory_bytes() const noexcept
+{
+    std::size_t total = sizeof(*this)
+                      + _blocks.capacity() * sizeof(std::vector<double>)
+                      + _tree.capacity() * sizeof(std::size_t);
+    for (const auto& block : _blocks) {
+        total += block.capacity() * sizeof(double);
+    }
+    return total;
+}
+
+}  // namespace app::statistics
@@ -7,7 +7,14 @@
 
 #include "file_streamer.hpp"
 
-#include <iostream>
+#include "median_binary.hpp"
+#include "memory_budget.hpp"
+#include "thread_placement.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
 #include <stdexcept>
 #include <utility>
 
@@ -15,52 +22,278 @@ namespace app::io {
 
 namespace fs = std::filesystem;
 
-std::size_t file_streamer::_total_records = 0;
+std::atomic<std::size_t> file_streamer::_total_records{0};
+
+output_format parse_output_format(std::string_view name_) noexcept(false)
+{
+    if (name_ == "csv") {
+        return output_format::csv;
+    }
+    if (name_ == "binary") {
+        return output_format::binary;
+    }
+    throw std::invalid_argument{
+        "Unknown output format: " + std::string{name_}
+    };
+}
+
+std::string_view output_filename(output_format format_) noexcept
+{
+    return format_ == output_format::binary ? "median.bin" : "median.csv";
+}
 
 // ==================== конструктор/деструктор ====================
 
-file_streamer::file_streamer(std::string filename_)
+file_streamer::file_streamer(std::string filename_, const output_settings& settings_)
     : _filename{std::move(filename_)}
+    , _settings{settings_}
 {
-    // Открываем файл в режиме append
-    _file_stream.open(_filename, std::ios::app);
-    
-    if (!_file_stream.is_open()) {
-        throw std::runtime_error{
-            "Failed to open file for writing: " + _filename
-        };
+    // Буферизует сам file_streamer - буфер потока не нужен
+    _file_stream.rdbuf()->pubsetbuf(nullptr, 0);
+
+    // При ротации сегменты открывает поток записи
+    if (!_settings.rotating()) {
+        // CSV дописываем; двоичный файл начинаем заново - его заголовок описывает колонки всех записей
+        if (_settings._format == output_format::binary) {
+            _file_stream.open(_filename, std::ios::binary | std::ios::trunc);
+        } else {
+            _file_stream.open(_filename, std::ios::app);
+        }
+
+        if (!_file_stream.is_open()) {
+            throw std::runtime_error{
+                "Failed to open file for writing: " + _filename
+            };
+        }
     }
-}
+    _segment_start = std::chrono::steady_clock::now();
 
-file_streamer::file_streamer(file_streamer&& other_) noexcept
-    : _file_stream{std::move(other_._file_stream)}
-    , _filename{std::move(other_._filename)}
-    , _header_written{other_._header_written}
-{}
+    _front.reserve(_settings._buffer_size + NUMBER_CHARS);
+    _back.reserve(_settings._buffer_size + NUMBER_CHARS);
+    _memory = &app::processing::memory_budget::instance().account("writer");
+    _memory->set(_front.capacity() + _back.capacity());
+
+    _writing = std::jthread{[this](std::stop_token stoken_) {
+        writing(stoken_);
+    }};
+}
 
-file_streamer& file_streamer::operator=(file_streamer&& other_) noexcept
+file_streamer::~file_streamer()
 {
-    if (this != &other_) {
-        _file_stream = std::move(other_._file_stream);
-        _filename = std::move(other_._filename);
-        _header_written = other_._header_written;
+    // Поток записи дописывает оставшийся буфер перед выходом
+    _writing.request_stop();
+    if (_writing.joinable()) {
+        _writing.join();
     }
-    return *this;
+    // Последний сегмент обрезается до реальной длины
+    _segment.reset();
 }
 
 // ==================== private методы ====================
 
-void file_streamer::write_header_if_needed(std::vector<std::pair<std::string, double>> const extra_values_name_) noexcept
+void file_streamer::write_header_if_needed(std::vector<std::pair<std::string, double>> const extra_values_name_, bool grouped_) noexcept
 {
-    // Если файл пустой - пишем заголовок
-    if (fs::file_size(_filename) == 0) {
-        _file_stream << "receive_ts;median";
+    _header_written = true;
+
+    if (_settings._format == output_format::binary) {
+        std::vector<std::string_view> columns;
+        columns.reserve(extra_values_name_.size());
+        for (const auto& extra_value : extra_values_name_) {
+            columns.push_back(extra_value.first);
+        }
+        binary::put_header(_header, columns, _settings._delta_timestamps ? binary::FLAG_DELTA_TIMESTAMPS : 0);
+    } else {
+        _header = grouped_ ? "receive_ts;group;median" : "receive_ts;median";
         for (auto& _extra_value_name : extra_values_name_) {
-            _file_stream << ";" << _extra_value_name.first;
+            _header += ';';
+            _header += _extra_value_name.first;
+        }
+        _header += '\n';
+
+        // Дописываемый CSV уже может начинаться с заголовка
+        if (!_settings.rotating() && fs::file_size(_filename) != 0) {
+            return;
         }
-        _file_stream << std::endl;
     }
-    _header_written = true;
+    _front += _header;
+    _segment_bytes = _header.size();
+}
+
+void file_streamer::check_stream() const noexcept(false)
+{
+    if (!_settings.rotating() && !_file_stream.is_open()) {
+        throw std::runtime_error{"File stream is not open"};
+    }
+    if (_failed.load(std::memory_order_relaxed)) {
+        throw std::runtime_error{"Failed to write to file: " + _filename};
+    }
+}
+
+void file_streamer::append(std::int_fast64_t value_) noexcept(false)
+{
+    char buffer[NUMBER_CHARS];
+    const auto [end, ec] = std::to_chars(buffer, buffer + NUMBER_CHARS, value_);
+    _front.append(buffer, end);
+}
+
+void file_streamer::append(double value_) noexcept(false)
+{
+    char buffer[NUMBER_CHARS];
+    const auto [end, ec] = std::to_chars(buffer, buffer + NUMBER_CHARS, value_, std::chars_format::fixed, 8);
+    _front.append(buffer, end);
+}
+
+void file_streamer::append_binary(
+    std::int_fast64_t timestamp_,
+    double median_,
+    std::vector<std::pair<std::string, double>> const& extra_values_) noexcept(false)
+{
+    if (_settings._delta_timestamps) {
+        binary::put_varint(_front, timestamp_ - _last_timestamp);
+        _last_timestamp = timestamp_;
+    } else {
+        binary::put_le(_front, static_cast<std::uint64_t>(timestamp_));
+    }
+    binary::put_double(_front, median_);
+    for (const auto& value : extra_values_) {
+        binary::put_double(_front, value.second);
+    }
+}
+
+void file_streamer::begin_record(
+    std::unique_lock<std::mutex>& lock_,
+    std::vector<std::pair<std::string, double>> const& extra_values_,
+    bool grouped_) noexcept(false)
+{
+    if (!_header_written) {
+        write_header_if_needed(extra_values_, grouped_);
+        return;
+    }
+    // Сегмент закрывается только с записями и только на границе записи
+    if (!_settings.rotating() || _segment_bytes <= _header.size()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool by_size = _settings._rotate_size > 0 && _segment_bytes >= _settings._rotate_size;
+    const bool by_time = _settings._rotate_interval.count() > 0 && now - _segment_start >= _settings._rotate_interval;
+    if (!by_size && !by_time) {
+        return;
+    }
+
+    hand_off(lock_, true);
+    // Каждый сегмент читается независимо: свой заголовок и своя база разностей
+    _front += _header;
+    _segment_bytes = _header.size();
+    _segment_start = now;
+    _last_timestamp = 0;
+}
+
+void file_streamer::end_record(std::unique_lock<std::mutex>& lock_, std::size_t start_) noexcept(false)
+{
+    if (_settings._format == output_format::csv) {
+        _front += '\n';
+    }
+    _total_records.fetch_add(1, std::memory_order_relaxed);
+    _segment_bytes += _front.size() - start_;
+
+    if (_front.size() >= _settings._buffer_size) {
+        hand_off(lock_);
+    }
+}
+
+void file_streamer::hand_off(std::unique_lock<std::mutex>& lock_, bool rotate_) noexcept
+{
+    // Второй буфер ещё пишется - ждём его, а не растим очередь
+    _condition.wait(lock_, [this] { return !_back_ready; });
+    _front.swap(_back);
+    // Ёмкость растёт только под записи длиннее резерва
+    _memory->set(_front.capacity() + _back.capacity());
+    _back_ready = true;
+    _back_rotate = rotate_;
+    _condition.notify_all();
+}
+
+void file_streamer::open_segment() noexcept(false)
+{
+    // <имя>.NNNNNN<расширение>; сегменты прошлых запусков не перезаписываем
+    const fs::path base{_filename};
+    fs::path path;
+    do {
+        char index[16];
+        const auto [end, ec] = std::to_chars(index, index + sizeof(index), ++_segment_index);
+        const std::string digits(index, end);
+        path = base.parent_path() / (base.stem().string() + "." + std::string(6 - std::min<std::size_t>(digits.size(), 6), '0')
+            + digits + base.extension().string());
+    } while (fs::exists(path));
+
+    const auto preallocate = _settings._rotate_size > 0
+        ? _settings._rotate_size + _settings._rotate_size / 16
+        : TIME_SEGMENT_SIZE;
+    _segment = std::make_unique<segment_writer>(path, preallocate);
+}
+
+void file_streamer::write_out(const std::string& buffer_) noexcept(false)
+{
+    if (!_settings.rotating()) {
+        _file_stream.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        _file_stream.flush();
+        if (!_file_stream) {
+            throw std::runtime_error{"Failed to write to file: " + _filename};
+        }
+        return;
+    }
+
+    if (!buffer_.empty()) {
+        if (!_segment) {
+            open_segment();
+        }
+        _segment->write(buffer_.data(), buffer_.size());
+    }
+}
+
+void file_streamer::writing(std::stop_token stoken_) noexcept
+{
+    app::processing::thread_placement::instance().apply(app::processing::pipeline_stage::writer);
+    app::processing::trace_thread("file_streamer");
+    std::unique_lock<std::mutex> lock{_mutex};
+
+    while (true) {
+        const bool handed = _condition.wait_for(lock, stoken_, _settings._flush_interval,
+            [this] { return _back_ready; });
+        const bool rotate = handed && _back_rotate;
+
+        if (!handed) {
+            // Истёк интервал или остановка - забираем неполный буфер
+            if (!_front.empty()) {
+                _front.swap(_back);
+                _back_ready = true;
+            } else if (stoken_.stop_requested()) {
+                return;
+            } else {
+                continue;
+            }
+        }
+
+        // Запись - вне мьютекса, заполнение _front продолжается
+        lock.unlock();
+        try {
+            app::processing::trace_span span{"write"};
+            write_out(_back);
+            if (rotate && _segment) {
+                _segment->seal();
+                _segment.reset();
+            }
+        } catch (const std::exception&) {
+            _failed.store(true, std::memory_order_relaxed);
+        }
+        lock.lock();
+
+        _back.clear();
+        _back_ready = false;
+        _back_rotate = false;
+        _condition.notify_all();
+    }
 }
 
 // ==================== public методы ====================
@@ -70,38 +303,75 @@ file_streamer& file_streamer::write_median(
     double median_,
     std::vector<std::pair<std::string, double>> const extra_values_) noexcept(false)
 {
-    if (!_file_stream.is_open()) {
-        throw std::runtime_error{"File stream is not open"};
-    }
+    check_stream();
+    std::unique_lock<std::mutex> lock{_mutex};
 
-    // Проверяем, нужно ли писать заголовок
-    if (!_header_written) {
-        write_header_if_needed(extra_values_);
+    // Заголовок и, при ротации, новый сегмент
+    begin_record(lock, extra_values_, false);
+    const auto start = _front.size();
+
+    if (_settings._format == output_format::binary) {
+        append_binary(timestamp_, median_, extra_values_);
+        end_record(lock, start);
+        return *this;
     }
     
     // Форматируем вывод
-    _file_stream << std::fixed << std::setprecision(8) << timestamp_ << ';' << median_;
+    append(timestamp_);
+    _front += ';';
+    append(median_);
     
     for (auto& value : extra_values_) {
-        _file_stream << ";" << std::fixed << std::setprecision(8) << value.second;
+        _front += ';';
+        append(value.second);
     }
-    _file_stream << std::endl;
+    end_record(lock, start);
 
-    ++_total_records;
+    return *this;
+}
+
+file_streamer& file_streamer::write_group_median(
+    std::int_fast64_t timestamp_,
+    std::string_view group_,
+    double median_,
+    std::vector<std::pair<std::string, double>> const& extra_values_) noexcept(false)
+{
+    check_stream();
+    if (_settings._format == output_format::binary) {
+        throw std::runtime_error{"Binary output does not support grouped results"};
+    }
+    std::unique_lock<std::mutex> lock{_mutex};
+
+    begin_record(lock, extra_values_, true);
+    const auto start = _front.size();
+    
+    append(timestamp_);
+    _front += ';';
+    _front += group_;
+    _front += ';';
+    append(median_);
+    
+    for (auto& value : extra_values_) {
+        _front += ';';
+        append(value.second);
+    }
+    end_record(lock, start);
 
     return *this;
 }
 
 std::size_t file_streamer::total_records() const noexcept
 {
-    return _total_records;
+    return _total_records.load(std::memory_order_relaxed);
 }
 
 void file_streamer::flush() noexcept
 {
-    if (_file_stream.is_open()) {
-        _file_stream.flush();
+    std::unique_lock<std::mutex> lock{_mutex};
+    if (!_front.empty()) {
+        hand_off(lock);
     }
+    _condition.wait(lock, [this] { return !_back_ready; });
 }
 
-}  // namespace app::io
\ No newline at end of file
+}  // namespace app::io
@@ -0,0 +1,81 @@
+/**
+ * \file group_key.cpp
+ * \brief Реализация ключа группировки строк
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "group_key.hpp"
+
+#include <filesystem>
+#include <stdexcept>
+
+namespace app::processing {
+
+namespace {
+    /**
+     * \brief Имя стороны заявки
+     */
+    [[nodiscard]] std::string_view side_name(trade_side side_) noexcept
+    {
+        switch (side_) {
+            case trade_side::bid:     return "bid";
+            case trade_side::ask:     return "ask";
+            case trade_side::unknown: break;
+        }
+        return "unknown";
+    }
+
+    /**
+     * \brief Имя источника: имя файла без расширения, при совпадении имён - с индексом
+     *
+     * Файлы с одним именем из разных директорий иначе дали бы одинаковые
+     * метки разных групп ("orders#0", "orders#1").
+     */
+    [[nodiscard]] std::string source_name(std::size_t source_, const std::vector<std::string>& sources_)
+    {
+        if (source_ >= sources_.size()) {
+            return std::to_string(source_);
+        }
+
+        const auto stem = std::filesystem::path{sources_[source_]}.stem();
+        for (std::size_t i = 0; i < sources_.size(); ++i) {
+            if (i != source_ && std::filesystem::path{sources_[i]}.stem() == stem) {
+                return stem.string() + '#' + std::to_string(source_);
+            }
+        }
+        return stem.string();
+    }
+} // unnamed namespace
+
+void add_group_dimension(group_settings& settings_, std::string_view name_) noexcept(false)
+{
+    if (name_ == "side") {
+        settings_._by_side = true;
+    } else if (name_ == "file" || name_ == "instrument") {
+        settings_._by_file = true;
+    } else {
+        throw std::invalid_argument{
+            "Unknown group_by dimension: " + std::string{name_}
+        };
+    }
+}
+
+std::string group_label(std::uint64_t key_, const group_settings& settings_)
+{
+    std::string label;
+
+    if (settings_._by_file) {
+        label = source_name(static_cast<std::size_t>(key_ >> 8), settings_._sources);
+    }
+    if (settings_._by_side) {
+        if (!label.empty()) {
+            label += '/';
+        }
+        label += side_name(static_cast<trade_side>(key_ & 0xFF));
+    }
+
+    return label;
+}
+
+}  // namespace app::processing
@@ -0,0 +1,75 @@
+/**
+ * \file latency_histogram.cpp
+ * \brief Реализация гистограммы задержек
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace app::processing {
+
+std::size_t latency_histogram::index(std::uint64_t value_) noexcept
+{
+    if (value_ < SUB_COUNT) {
+        return static_cast<std::size_t>(value_);
+    }
+    // value_ в [2^e, 2^(e+1)): блок по степени, внутри - старшие SUB_BITS разрядов после ведущего
+    const auto exponent = static_cast<unsigned>(std::bit_width(value_)) - 1;
+    const auto sub = static_cast<std::size_t>(value_ >> (exponent - SUB_BITS)) - SUB_COUNT;
+    return (exponent - SUB_BITS + 1) * SUB_COUNT + sub;
+}
+
+std::uint64_t latency_histogram::upper_bound(std::size_t index_) noexcept
+{
+    if (index_ < SUB_COUNT) {
+        return index_;
+    }
+    const auto exponent = static_cast<unsigned>(index_ / SUB_COUNT) + SUB_BITS - 1;
+    const auto sub = index_ % SUB_COUNT;
+    const auto width = std::uint64_t{1} << (exponent - SUB_BITS);
+    return ((SUB_COUNT + sub) << (exponent - SUB_BITS)) + (width - 1);
+}
+
+void latency_histogram::record(std::uint64_t value_) noexcept
+{
+    _buckets[index(value_)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    auto current = _max.load(std::memory_order_relaxed);
+    while (value_ > current && !_max.compare_exchange_weak(current, value_, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t latency_histogram::percentile(double q_) const noexcept
+{
+    const auto total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(std::clamp(q_, 0.0, 1.0) * static_cast<double>(total))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(upper_bound(i), max());
+        }
+    }
+    return max();
+}
+
+void latency_histogram::reset() noexcept
+{
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace app::processing
@@ -7,10 +7,15 @@
 
 #include "logger.hpp"
 
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 namespace app::processing {
 
+namespace {
+    constexpr std::size_t LOG_QUEUE_SIZE = 8192;    ///< Сообщений в кольце асинхронного логгера
+} // unnamed namespace
+
 std::once_flag logger::init_flag;
 std::shared_ptr<spdlog::logger> logger::logger_instance;
 
@@ -23,7 +28,11 @@ void logger::init() noexcept
         console_sink->set_level(spdlog::level::info);
         console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
         
-        logger_instance = std::make_shared<spdlog::logger>("console_logger", console_sink);
+        // Вывод в консоль - в отдельном потоке; при переполнении кольца
+        // затираются старые сообщения, а не блокируются рабочие потоки
+        spdlog::init_thread_pool(LOG_QUEUE_SIZE, 1);
+        logger_instance = std::make_shared<spdlog::async_logger>(
+            "console_logger", console_sink, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
         logger_instance->set_level(spdlog::level::info);
                 
         // Регистрируем как основной логгер
@@ -37,8 +46,9 @@ void logger::shutdown() noexcept
 {
     if (logger_instance) {
         logger_instance->flush();
-        spdlog::drop_all();
         logger_instance.reset();
+        // Дописывает очередь и останавливает поток логгера
+        spdlog::shutdown();
     }
 }
 
@@ -18,15 +18,66 @@
 
 
 #include "argument_parser.hpp"
+#include "compression_tuner.hpp"
 #include "config_parser.hpp"
+#include "csv_reader.hpp"
 #include "data_queue.hpp"
 #include "file_streamer.hpp"
 #include "logger.hpp"
 #include "median_calculator.hpp"
+#include "memory_budget.hpp"
+#include "pipeline_metrics.hpp"
 #include "readers_manager.hpp"
+#include "shm_publisher.hpp"
+#include "thread_placement.hpp"
+#include "trace.hpp"
 
 namespace fs = std::filesystem;
 
+namespace {
+
+/**
+ * \brief Подбирает компрессию T-Digest по выборке входных файлов и печатает отчёт
+ * \return выбранная компрессия
+ */
+[[nodiscard]] std::size_t calibrate_compression(const app::config::parsing_result& config_) {
+    const auto& settings = config_._tuning_settings;
+    spdlog::info("Подбор компрессии: выборка до " ANSI_BLUE "{}" ANSI_RESET " строк, ошибка ранга не больше "
+                 ANSI_BLUE "{}" ANSI_RESET, settings._sample_rows, settings._max_rank_error);
+
+    const auto sample = app::io::read_price_sample(config_._csv_files, settings._sample_rows);
+    const auto result = app::statistics::tune_compression(sample, config_._engine_settings, settings);
+
+    for (std::size_t i = 0; i < settings._quantiles.size(); ++i) {
+        spdlog::info("    q = " ANSI_BLUE "{}" ANSI_RESET ": наибольшая ошибка ранга " ANSI_GREEN "{:.6f}" ANSI_RESET,
+                     settings._quantiles[i], result._rank_errors[i]);
+    }
+    if (!result._met) {
+        spdlog::warn("Порог не достигнут до max_compression = " ANSI_BLUE "{}" ANSI_RESET, settings._max_compression);
+    }
+    spdlog::info("Компрессия: " ANSI_GREEN "{}" ANSI_RESET " (выборка " ANSI_BLUE "{}" ANSI_RESET
+                 " строк, проверок " ANSI_BLUE "{}" ANSI_RESET ")",
+                 result._compression, result._sample_rows, result._evaluations);
+    // Свой движок у каждой группы и метрики, поэтому память - на один движок
+    spdlog::info("Память движка: " ANSI_GREEN "{}" ANSI_RESET " байт, вставок в секунду: " ANSI_GREEN "{:.0f}" ANSI_RESET,
+                 result._memory_bytes, result._inserts_per_sec);
+    spdlog::info("Закрепить в " ANSI_YELLOW "{}" ANSI_RESET ": [calculator] compression = " ANSI_GREEN "{}" ANSI_RESET,
+                 config_._config_file.string(), result._compression);
+    return result._compression;
+}
+
+/**
+ * \brief Инициализирует логгер и закрывает его при любом выходе из main
+ *
+ * Логгер асинхронный: без shutdown() хвост очереди сообщений теряется.
+ */
+struct logger_scope {
+    logger_scope() { app::processing::logger::init(); }
+    ~logger_scope() { app::processing::logger::shutdown(); }
+};
+
+} // unnamed namespace
+
 /**
  * \brief Точка входа в программу
  * \param argc количество аргументов командной строки
@@ -39,7 +90,7 @@ int main(int argc, char* argv[]) {
         SetConsoleOutputCP(CP_UTF8);
     #endif
 
-    app::processing::logger::init();
+    const logger_scope logging;
 
     spdlog::info("Запуск приложения " ANSI_GREEN "csv_median_calculator v1.0.0" ANSI_RESET);
     
@@ -51,31 +102,57 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         
-        const auto config = app::config::parse_configuration(cli_args._variables);
+        auto config = app::config::parse_configuration(cli_args._variables);
         
         if (!config.is_valid()) {
             return 1;
         }
+
+        if (cli_args._calibrate || config._auto_compression) {
+            config._engine_settings._compression = calibrate_compression(config);
+            if (cli_args._calibrate) {
+                return 0;
+            }
+        }
         
         
-        if (!std::filesystem::exists(config._output_dir / "median.csv")) {
-            spdlog::info("Создание " ANSI_YELLOW "{}" ANSI_RESET, config._output_dir.string() + "/median.csv");
+        const auto output_path = config._output_dir / app::io::output_filename(config._output_settings._format);
+
+        // До создания потоков: их первые интервалы тоже попадут в трассу
+        auto& tracer = app::processing::tracer::instance();
+        tracer.start(config._trace_settings);
+        app::processing::memory_budget::instance().configure(config._memory_settings);
+        app::processing::thread_placement::instance().configure(config._placement_settings);
+
+        if (!std::filesystem::exists(output_path)) {
+            spdlog::info("Создание " ANSI_YELLOW "{}" ANSI_RESET, output_path.string());
             fs::create_directories(config._output_dir);
         }
         
-        const auto output_path = config._output_dir / "median.csv";
-        
         auto file_streamer = std::make_shared<app::io::file_streamer>(
-            output_path.string()
+            output_path.string(), config._output_settings
         );
         spdlog::info("Создание менеджера ридеров");
         auto readers_mgr = std::make_unique<app::io::readers_manager>(cli_args._streaming_mode);
+        // До запуска потребителей: воронки и потока калькулятора
+        readers_mgr->set_funnel_wait(config._wait_settings._funnel);
+        readers_mgr->tasks()->set_wait_strategy(config._wait_settings._calculator);
         spdlog::info("Создание калькулятора");
-        auto median_calc = std::make_unique<app::processing::median_calculator>(readers_mgr->tasks(), config._extra_values_name, file_streamer);
+        auto median_calc = app::processing::make_median_calculator(
+            readers_mgr->tasks(), config._extra_values_name, file_streamer,
+            config._engine_settings, config._group_settings, config._metrics,
+            config._emission_settings, config._shards);
+        if (config._publisher_settings.enabled()) {
+            median_calc->publish_to(std::make_shared<app::io::shm_publisher>(config._publisher_settings));
+        }
         
+        auto& metrics = app::processing::pipeline_metrics::instance();
+        metrics.start_export(config._stats_settings);
+
         spdlog::info("Добавление файлов в менеджер");
-        for (const auto& file : config._csv_files) {
-            readers_mgr->add_csv_file(file);
+        // Индекс источника - индекс файла в конфиге, по нему строятся метки групп
+        for (std::size_t i = 0; i < config._csv_files.size(); ++i) {
+            readers_mgr->add_csv_file(config._csv_files[i], static_cast<std::uint32_t>(i));
         }
         
         readers_mgr->run();
@@ -89,10 +166,13 @@ int main(int argc, char* argv[]) {
         readers_mgr->stop();
         median_calc->stop();
         file_streamer->flush();
+        metrics.stop_export();
+        tracer.stop();
         
         std::cout << "======================================================" << std::endl;
         spdlog::info("Обработано строк: " ANSI_GREEN "{}" ANSI_RESET, readers_mgr->total_tasks().load());
         spdlog::info("Записано изменений медианы: " ANSI_GREEN "{}" ANSI_RESET, file_streamer->total_records());
+        spdlog::info("Память движка квантилей: " ANSI_GREEN "{}" ANSI_RESET " байт", median_calc->engine_memory());
         spdlog::info("Результат сохранен в: " ANSI_YELLOW "{}" ANSI_RESET, output_path.string());
         spdlog::info(ANSI_GREEN "Завершение работы" ANSI_RESET);
     } catch (const std::exception& e) {
@@ -7,73 +7,177 @@
 
 #include "median_calculator.hpp"
 
+#include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 #include "logger.hpp"
+#include "pipeline_metrics.hpp"
+#include "thread_placement.hpp"
+#include "trace.hpp"
 
 namespace app::processing {
 
-// ==================== конструкторы/деструктор ====================
+namespace {
+    /**
+     * \brief Разбирает имя вида "p90" / "p99.9" в квантиль
+     * \return квантиль в (0, 1) или отрицательное значение, если имя не квантиль
+     */
+    [[nodiscard]] double parse_percentile(const std::string& name_) noexcept
+    {
+        if (name_.size() < 2 || name_.front() != 'p') {
+            return -1.0;
+        }
+        double percent = 0.0;
+        const auto [ptr, ec] = std::from_chars(name_.data() + 1, name_.data() + name_.size(), percent);
+        if (ec != std::errc{} || ptr != name_.data() + name_.size() || percent <= 0.0 || percent >= 100.0) {
+            return -1.0;
+        }
+        return percent / 100.0;
+    }
+
+    /**
+     * \brief Количество значений, прижатых движком к краю диапазона (0 у движков без диапазона)
+     */
+    template <typename Engine>
+    [[nodiscard]] std::uint64_t clamped_values(const Engine& engine_) noexcept
+    {
+        if constexpr (requires { engine_.clamped(); }) {
+            return engine_.clamped();
+        } else {
+            return 0;
+        }
+    }
+} // unnamed namespace
+
+// ==================== median_calculator ====================
 
 median_calculator::median_calculator(
     std::shared_ptr<data_queue> tasks_,
     std::vector<std::string> extra_values_,
     std::shared_ptr<app::io::file_streamer> file_streamer_,
-    std::size_t digest_compression_)
-    : _extra_values_name{move(extra_values_)}
-    , _file_streamer{file_streamer_}
-    , _tdigest{std::make_unique<app::statistics::tdigest>(digest_compression_)}
-    , _tasks{std::move(tasks_)}
+    const std::vector<std::string>& metrics_,
+    const emission_settings& emission_settings_)
+    : _tasks{std::move(tasks_)}
+    , _file_streamer{std::move(file_streamer_)}
+    , _emission{emission_settings_}
+    , _engines_memory{memory_budget::instance().account("engines")}
 {
-    _calculating = std::jthread{[this] {
-        calculating(_stop_source.get_token());
-    }};
+    _metrics.reserve(metrics_.size());
+    for (const auto& metric : metrics_) {
+        _metrics.emplace_back(metric);
+    }
+
+    // Колонки, которые берутся из скользящих моментов
+    constexpr std::pair<std::string_view, stat_kind> MOMENT_COLUMNS[] = {
+        {"count", stat_kind::count},
+        {"sum", stat_kind::sum},
+        {"min", stat_kind::min},
+        {"max", stat_kind::max},
+        {"variance", stat_kind::variance},
+        {"stddev", stat_kind::stddev},
+        {"vwap", stat_kind::vwap},
+    };
+
+    // Имена колонок разбираем один раз, а не на каждой строке
+    _columns.reserve(extra_values_.size());
+    for (auto& name : extra_values_) {
+        const auto moment = std::find_if(std::begin(MOMENT_COLUMNS), std::end(MOMENT_COLUMNS),
+            [&name](const auto& entry_) { return entry_.first == name; });
+
+        if (name == "mean") {
+            _columns.push_back({std::move(name), stat_kind::mean});
+        } else if (moment != std::end(MOMENT_COLUMNS)) {
+            _columns.push_back({std::move(name), moment->second});
+            _with_moments = true;
+        } else if (const double q = parse_percentile(name); q > 0.0) {
+            _columns.push_back({std::move(name), stat_kind::quantile, q});
+        } else {
+            spdlog::warn("Неизвестная колонка " ANSI_YELLOW "{}" ANSI_RESET " пропущена", name);
+        }
+    }
+
+    // Для каждой метрики - медиана и те же квантильные колонки, что у цены
+    const auto price_columns = _columns.size();
+    for (std::size_t metric = 1; metric <= _metrics.size(); ++metric) {
+        const auto& prefix = _metrics[metric - 1].name();
+        _columns.push_back({prefix + "_median", stat_kind::median, 0.0, metric});
+        for (std::size_t i = 0; i < price_columns; ++i) {
+            const auto column = _columns[i];
+            if (column._kind == stat_kind::mean || column._kind == stat_kind::quantile) {
+                _columns.push_back({prefix + "_" + column._name, column._kind, column._quantile, metric});
+            }
+        }
+    }
 }
 
-median_calculator::~median_calculator()
+bool median_calculator::deferring(
+    const std::vector<std::unique_ptr<data>>& batch_,
+    std::size_t index_,
+    std::size_t& burst_) const noexcept
 {
+    const bool last_in_batch = index_ + 1 == batch_.size();
+
+    // Серия строк с одним receive_ts - одно обновление
+    if (_emission._coalesce_timestamps && !last_in_batch
+        && batch_[index_ + 1]->receive_ts == batch_[index_]->receive_ts) {
+        return true;
+    }
 
+    // Пока есть следующие строки, промежуточные значения никому не нужны
+    if (_emission._conflate && ++burst_ < _emission._conflate_limit
+        && (!last_in_batch || !_tasks->empty())) {
+        return true;
+    }
+    burst_ = 0;
+    return false;
 }
 
-median_calculator::median_calculator(median_calculator&& other_) noexcept
-    : _tdigest{std::move(other_._tdigest)}
-    , _tasks{std::move(other_._tasks)}
-    , _file_streamer{std::move(other_._file_streamer)}
-{}
+void median_calculator::publish_to(std::shared_ptr<app::io::shm_publisher> publisher_) noexcept
+{
+    std::lock_guard<std::mutex> lock{_output_mutex};
+    _publisher = std::move(publisher_);
+}
 
-median_calculator& median_calculator::operator=(median_calculator&& other_) noexcept
+void median_calculator::account_engines(std::size_t& batches_) noexcept
 {
-    if (this != &other_) {
-        stop();  // Останавливаем текущую обработку
-        
-        _tdigest = std::move(other_._tdigest);
-        _tasks = std::move(other_._tasks);
-        _file_streamer = std::move(other_._file_streamer);
+    if (++batches_ % MEMORY_BATCHES == 1) {
+        _engines_memory.set(engine_memory());
+        report_clamped();
     }
-    return *this;
 }
 
-// ==================== public методы ====================
-
-void median_calculator::stop() noexcept
+void median_calculator::report_clamped() noexcept
 {
-    _stop_source.request_stop();
-    if (_calculating.joinable()) {
-        _calculating.join();
+    const auto clamped = engine_clamped();
+    pipeline_metrics::instance().clamped(clamped);
+    if (clamped > 0 && !_clamped_reported) {
+        _clamped_reported = true;
+        spdlog::warn("Значения вышли за диапазон гистограммы и прижаты к краю: проверьте "
+                     ANSI_YELLOW "tick_size" ANSI_RESET " и " ANSI_YELLOW "max_pages" ANSI_RESET);
     }
 }
 
-// ==================== private методы ====================
-
 void median_calculator::output_result(
     std::int_fast64_t timestamp_,
     double median_,
-    std::vector<std::pair<std::string, double>> const extra_values_) noexcept(false)
+    std::vector<std::pair<std::string, double>> const extra_values_,
+    std::int_fast64_t read_time_) noexcept(false)
 {
+    trace_span span{"emit"};
     std::lock_guard<std::mutex> lock{_output_mutex};
-    
+    pipeline_metrics::instance().emitted(read_time_);
+
+    // Локальные потребители получают строку раньше, чем она попадёт в файл
+    if (_publisher) {
+        _publisher->publish(timestamp_, median_, extra_values_);
+    }
+
     if (_file_streamer) {
         // Запись в файл
         _file_streamer->write_median(timestamp_, median_, extra_values_);
@@ -82,33 +186,773 @@ void median_calculator::output_result(
         std::cout << std::fixed << std::setprecision(8)
         << "receive_ts: " << timestamp_
         << " / median: " << median_;
-        
+
+        std::cout << std::endl;
+    }
+}
+
+void median_calculator::output_group_result(
+    std::int_fast64_t timestamp_,
+    std::string_view group_,
+    double median_,
+    std::vector<std::pair<std::string, double>> const& extra_values_,
+    std::int_fast64_t read_time_) noexcept(false)
+{
+    trace_span span{"emit"};
+    std::lock_guard<std::mutex> lock{_output_mutex};
+    pipeline_metrics::instance().emitted(read_time_);
+
+    if (_file_streamer) {
+        _file_streamer->write_group_median(timestamp_, group_, median_, extra_values_);
+    } else {
+        std::cout << std::fixed << std::setprecision(8)
+        << "receive_ts: " << timestamp_
+        << " / group: " << group_
+        << " / median: " << median_;
+
         std::cout << std::endl;
     }
 }
 
-void median_calculator::calculating(std::stop_token stoken_) noexcept(false)
+// ==================== basic_median_calculator ====================
+
+template <app::statistics::quantile_estimator Engine>
+basic_median_calculator<Engine>::basic_median_calculator(
+    std::shared_ptr<data_queue> tasks_,
+    std::vector<std::string> extra_values_,
+    std::shared_ptr<app::io::file_streamer> file_streamer_,
+    const app::statistics::engine_settings& engine_settings_,
+    const std::vector<std::string>& metrics_,
+    const emission_settings& emission_settings_)
+    : median_calculator{std::move(tasks_), std::move(extra_values_), std::move(file_streamer_), metrics_, emission_settings_}
+    , _engine{app::statistics::make_engine<Engine>(engine_settings_)}
+{
+    _metric_engines.reserve(_metrics.size());
+    for (std::size_t i = 0; i < _metrics.size(); ++i) {
+        _metric_engines.push_back(app::statistics::make_engine<Engine>(
+            app::statistics::metric_settings(engine_settings_, _metrics[i].name())));
+    }
+
+    _calculating = std::jthread{[this] {
+        calculating(_stop_source.get_token());
+    }};
+}
+
+template <app::statistics::quantile_estimator Engine>
+basic_median_calculator<Engine>::~basic_median_calculator()
+{
+    stop();
+}
+
+template <app::statistics::quantile_estimator Engine>
+void basic_median_calculator<Engine>::stop() noexcept
+{
+    _stop_source.request_stop();
+    if (_calculating.joinable()) {
+        _calculating.join();
+    }
+    _engines_memory.set(engine_memory());
+    report_clamped();
+}
+
+template <app::statistics::quantile_estimator Engine>
+std::size_t basic_median_calculator<Engine>::engine_memory() const noexcept
+{
+    std::size_t total = _engine.memory_bytes();
+    for (const auto& engine : _metric_engines) {
+        total += engine.memory_bytes();
+    }
+    return total;
+}
+
+template <app::statistics::quantile_estimator Engine>
+std::uint64_t basic_median_calculator<Engine>::engine_clamped() const noexcept
+{
+    std::uint64_t total = clamped_values(_engine);
+    for (const auto& engine : _metric_engines) {
+        total += clamped_values(engine);
+    }
+    return total;
+}
+
+template <app::statistics::quantile_estimator Engine>
+double basic_median_calculator<Engine>::column_value(const stat_column& column_) const noexcept(false)
+{
+    const Engine& engine = column_._metric ? _metric_engines[column_._metric - 1] : _engine;
+
+    switch (column_._kind) {
+        case stat_kind::median:   return engine.median();
+        case stat_kind::mean:     return engine.mean();
+        case stat_kind::quantile: return engine.quantile(column_._quantile);
+        case stat_kind::count:    return static_cast<double>(_moments.count());
+        case stat_kind::sum:      return _moments.sum();
+        case stat_kind::min:      return _moments.min();
+        case stat_kind::max:      return _moments.max();
+        case stat_kind::variance: return _moments.variance();
+        case stat_kind::stddev:   return _moments.stddev();
+        case stat_kind::vwap:     return _moments.vwap();
+    }
+    return 0.0;
+}
+
+template <app::statistics::quantile_estimator Engine>
+void basic_median_calculator<Engine>::calculating(std::stop_token stoken_) noexcept(false)
+{
+    auto& metrics = pipeline_metrics::instance();
+    thread_placement::instance().apply(pipeline_stage::calculator);
+    trace_thread("calculator");
+    emission_state emission;
+    std::size_t burst = 0;
+    std::size_t batches = 0;
+    std::vector<std::unique_ptr<data>> batch;
+    batch.reserve(BATCH_SIZE);
+
+    std::vector<std::pair<std::string, double>> extra_values;
+    extra_values.reserve(_columns.size());
+    for (const auto& column : _columns) {
+        extra_values.emplace_back(column._name, 0.0);
+    }
+
+    while (!stoken_.stop_requested()) {
+        // Блокируемся до появления данных или остановки
+        batch.clear();
+        if (_tasks->pop_batch(batch, BATCH_SIZE) == 0) {
+            // Очередь закрыта и пуста - конец потока
+            flush(emission, extra_values);
+            continue;
+        }
+        metrics.calculated(batch.size());
+        trace_span span{"digest"};
+        account_engines(batches);
+
+        for (std::size_t index = 0; index < batch.size(); ++index) {
+            const data& task = *batch[index];
+
+            // Обновляем движок квантилей
+            app::statistics::insert(_engine, task.price, task.receive_ts);
+            for (std::size_t i = 0; i < _metrics.size(); ++i) {
+                app::statistics::insert(_metric_engines[i], _metrics[i].value(task), task.receive_ts);
+            }
+            if (_with_moments) {
+                _moments.add(task.price, task.quantity);
+            }
+            if (deferring(batch, index, burst)) {
+                continue;
+            }
+            const double now_median = _engine.median();
+
+            // Выводим, если это разрешает политика вывода
+            if (emission.should_emit(_emission, task.receive_ts, now_median)) {
+                // Дополнительные колонки считаем только для выводимых строк
+                for (std::size_t i = 0; i < _columns.size(); ++i) {
+                    extra_values[i].second = column_value(_columns[i]);
+                }
+                output_result(task.receive_ts, now_median, extra_values, task.read_time);
+            }
+        }
+    }
+    flush(emission, extra_values);
+}
+
+template <app::statistics::quantile_estimator Engine>
+void basic_median_calculator<Engine>::flush(
+    emission_state& emission_,
+    std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false)
+{
+    std::int_fast64_t timestamp = 0;
+    double median = 0.0;
+    if (!emission_.flush(timestamp, median)) {
+        return;
+    }
+    // Подавленное значение - последнее обновление, движок в том же состоянии
+    for (std::size_t i = 0; i < _columns.size(); ++i) {
+        extra_values_[i].second = column_value(_columns[i]);
+    }
+    // Строка выводится позже чтения на время подавления: в задержку её не считаем
+    output_result(timestamp, median, extra_values_, 0);
+}
+
+template class basic_median_calculator<app::statistics::tdigest>;
+template class basic_median_calculator<app::statistics::tick_histogram>;
+template class basic_median_calculator<app::statistics::sliding_window>;
+template class basic_median_calculator<app::statistics::decayed_tdigest>;
+template class basic_median_calculator<app::statistics::merging_digest>;
+template class basic_median_calculator<app::statistics::exact_quantiles>;
+
+// ==================== grouped_median_calculator ====================
+
+template <app::statistics::quantile_estimator Engine>
+grouped_median_calculator<Engine>::grouped_median_calculator(
+    std::shared_ptr<data_queue> tasks_,
+    std::vector<std::string> extra_values_,
+    std::shared_ptr<app::io::file_streamer> file_streamer_,
+    const app::statistics::engine_settings& engine_settings_,
+    group_settings group_settings_,
+    const std::vector<std::string>& metrics_,
+    const emission_settings& emission_settings_)
+    : median_calculator{std::move(tasks_), std::move(extra_values_), std::move(file_streamer_), metrics_, emission_settings_}
+    , _group_settings{std::move(group_settings_)}
+{
+    _slot_settings.reserve(_metrics.size() + 1);
+    _slot_settings.push_back(engine_settings_);
+    for (const auto& metric : _metrics) {
+        _slot_settings.push_back(app::statistics::metric_settings(engine_settings_, metric.name()));
+    }
+    // Проверяем параметры движков сразу, а не при первой частой группе
+    for (const auto& settings : _slot_settings) {
+        (void)app::statistics::make_engine<Engine>(settings);
+    }
+
+    _calculating = std::jthread{[this] {
+        calculating(_stop_source.get_token());
+    }};
+}
+
+template <app::statistics::quantile_estimator Engine>
+grouped_median_calculator<Engine>::~grouped_median_calculator()
+{
+    stop();
+}
+
+template <app::statistics::quantile_estimator Engine>
+void grouped_median_calculator<Engine>::stop() noexcept
+{
+    _stop_source.request_stop();
+    if (_calculating.joinable()) {
+        _calculating.join();
+    }
+    _engines_memory.set(engine_memory());
+    report_clamped();
+}
+
+template <app::statistics::quantile_estimator Engine>
+std::size_t grouped_median_calculator<Engine>::engine_memory() const noexcept
+{
+    std::size_t total = _groups.bucket_count() * sizeof(typename decltype(_groups)::value_type);
+    for (const auto& [key, state] : _groups) {
+        total += state._label.capacity() + state._slots.capacity() * sizeof(slot);
+        for (const auto& distribution : state._slots) {
+            total += distribution._engine ? distribution._engine->memory_bytes() : distribution._small.memory_bytes();
+        }
+    }
+    return total;
+}
+
+template <app::statistics::quantile_estimator Engine>
+std::uint64_t grouped_median_calculator<Engine>::engine_clamped() const noexcept
+{
+    std::uint64_t total = 0;
+    for (const auto& [key, state] : _groups) {
+        for (const auto& distribution : state._slots) {
+            total += distribution._engine ? clamped_values(*distribution._engine) : 0;
+        }
+    }
+    return total;
+}
+
+template <app::statistics::quantile_estimator Engine>
+typename grouped_median_calculator<Engine>::group*
+grouped_median_calculator<Engine>::find_group(std::uint64_t key_) noexcept(false)
+{
+    // Бюджет не даёт движкам расти за счёт новых групп; существующие группы считаются дальше
+    if (const auto it = _groups.find(key_); it != _groups.end()) {
+        return &it->second;
+    }
+    if (memory_budget::instance().exhausted()) {
+        return nullptr;
+    }
+
+    auto [it, inserted] = _groups.try_emplace(key_);
+    if (inserted) {
+        it->second._label = group_label(key_, _group_settings);
+        it->second._slots.resize(_metrics.size() + 1);
+        if constexpr (!SMALL_GROUPS) {
+            for (std::size_t i = 0; i < _slot_settings.size(); ++i) {
+                it->second._slots[i]._engine = std::make_unique<Engine>(app::statistics::make_engine<Engine>(_slot_settings[i]));
+            }
+        }
+        spdlog::info("Новая группа " ANSI_YELLOW "{}" ANSI_RESET, it->second._label);
+    }
+    return &it->second;
+}
+
+template <app::statistics::quantile_estimator Engine>
+void grouped_median_calculator<Engine>::add(
+    slot& slot_,
+    const app::statistics::engine_settings& settings_,
+    double value_,
+    std::int_fast64_t timestamp_) noexcept(false)
+{
+    if (slot_._engine) {
+        app::statistics::insert(*slot_._engine, value_, timestamp_);
+    } else if constexpr (SMALL_GROUPS) {
+        slot_._small.add(value_);
+
+        // Ключ перестал быть редким - переносим значения в полноценный движок
+        if (slot_._small.size() >= _group_settings._small_limit) {
+            slot_._engine = std::make_unique<Engine>(app::statistics::make_engine<Engine>(settings_));
+            for (const double value : slot_._small.values()) {
+                slot_._engine->add(value);
+            }
+            slot_._small = {};
+        }
+    }
+}
+
+template <app::statistics::quantile_estimator Engine>
+void grouped_median_calculator<Engine>::add(group& group_, const data& row_) noexcept(false)
+{
+    add(group_._slots.front(), _slot_settings.front(), row_.price, row_.receive_ts);
+    for (std::size_t i = 0; i < _metrics.size(); ++i) {
+        add(group_._slots[i + 1], _slot_settings[i + 1], _metrics[i].value(row_), row_.receive_ts);
+    }
+
+    if (_with_moments) {
+        group_._moments.add(row_.price, row_.quantity);
+    }
+    group_._last_timestamp = row_.receive_ts;
+    group_._last_read = row_.read_time;
+}
+
+template <app::statistics::quantile_estimator Engine>
+void grouped_median_calculator<Engine>::emit(
+    group& group_,
+    std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false)
+{
+    const double now_median = visit(group_._slots.front(), [](const auto& estimator_) { return estimator_.median(); });
+    if (!group_._emission.should_emit(_emission, group_._last_timestamp, now_median)) {
+        return;
+    }
+    for (std::size_t i = 0; i < _columns.size(); ++i) {
+        extra_values_[i].second = column_value(group_, _columns[i]);
+    }
+    output_group_result(group_._last_timestamp, group_._label, now_median, extra_values_, group_._last_read);
+}
+
+template <app::statistics::quantile_estimator Engine>
+void grouped_median_calculator<Engine>::flush(std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false)
+{
+    for (auto& [key, state] : _groups) {
+        std::int_fast64_t timestamp = 0;
+        double median = 0.0;
+        if (!state._emission.flush(timestamp, median)) {
+            continue;
+        }
+        for (std::size_t i = 0; i < _columns.size(); ++i) {
+            extra_values_[i].second = column_value(state, _columns[i]);
+        }
+        output_group_result(timestamp, state._label, median, extra_values_, 0);
+    }
+}
+
+template <app::statistics::quantile_estimator Engine>
+double grouped_median_calculator<Engine>::column_value(const group& group_, const stat_column& column_) const noexcept(false)
+{
+    const auto& distribution = group_._slots[column_._metric];
+
+    switch (column_._kind) {
+        case stat_kind::median:
+            return visit(distribution, [](const auto& estimator_) { return estimator_.median(); });
+        case stat_kind::mean:
+            return visit(distribution, [](const auto& estimator_) { return estimator_.mean(); });
+        case stat_kind::quantile:
+            return visit(distribution, [&column_](const auto& estimator_) { return estimator_.quantile(column_._quantile); });
+        case stat_kind::count:    return static_cast<double>(group_._moments.count());
+        case stat_kind::sum:      return group_._moments.sum();
+        case stat_kind::min:      return group_._moments.min();
+        case stat_kind::max:      return group_._moments.max();
+        case stat_kind::variance: return group_._moments.variance();
+        case stat_kind::stddev:   return group_._moments.stddev();
+        case stat_kind::vwap:     return group_._moments.vwap();
+    }
+    return 0.0;
+}
+
+template <app::statistics::quantile_estimator Engine>
+void grouped_median_calculator<Engine>::calculating(std::stop_token stoken_) noexcept(false)
 {
-    double old_median = -1.0;
+    auto& metrics = pipeline_metrics::instance();
+    thread_placement::instance().apply(pipeline_stage::calculator);
+    trace_thread("calculator");
+    std::vector<std::uint64_t> dirty;
+    std::size_t burst = 0;
+    std::size_t batches = 0;
+    std::vector<std::unique_ptr<data>> batch;
+    batch.reserve(BATCH_SIZE);
+
+    std::vector<std::pair<std::string, double>> extra_values;
+    extra_values.reserve(_columns.size());
+    for (const auto& column : _columns) {
+        extra_values.emplace_back(column._name, 0.0);
+    }
 
     while (!stoken_.stop_requested()) {
         // Блокируемся до появления данных или остановки
-        std::unique_ptr<data> task = _tasks->pop();
+        batch.clear();
+        if (_tasks->pop_batch(batch, BATCH_SIZE) == 0) {
+            // Очередь закрыта и пуста - конец потока
+            flush(extra_values);
+            continue;
+        }
+        metrics.calculated(batch.size());
+        trace_span span{"digest"};
+        account_engines(batches);
+
+        for (std::size_t index = 0; index < batch.size(); ++index) {
+            const data& task = *batch[index];
+            const auto key = group_key(task, _group_settings);
+            if (auto* state = find_group(key)) {
+                add(*state, task);
+
+                // Вывод проверяем один раз на каждую изменившуюся группу
+                if (!state->_dirty) {
+                    state->_dirty = true;
+                    dirty.push_back(key);
+                }
+            } else {
+                memory_budget::instance().shed();
+                LOG_LIMITED(spdlog::level::warn, "Бюджет памяти исчерпан движками: строки новых групп отбрасываются");
+            }
+            if (deferring(batch, index, burst)) {
+                continue;
+            }
+            for (const auto dirty_key : dirty) {
+                auto& dirty_state = _groups.find(dirty_key)->second;
+                dirty_state._dirty = false;
+                emit(dirty_state, extra_values);
+            }
+            dirty.clear();
+        }
+    }
+    flush(extra_values);
+}
+
+template class grouped_median_calculator<app::statistics::tdigest>;
+template class grouped_median_calculator<app::statistics::tick_histogram>;
+template class grouped_median_calculator<app::statistics::sliding_window>;
+template class grouped_median_calculator<app::statistics::decayed_tdigest>;
+template class grouped_median_calculator<app::statistics::merging_digest>;
+template class grouped_median_calculator<app::statistics::exact_quantiles>;
+
+// ==================== sharded_median_calculator ====================
+
+template <app::statistics::mergeable_estimator Engine>
+sharded_median_calculator<Engine>::sharded_median_calculator(
+    std::shared_ptr<data_queue> tasks_,
+    std::vector<std::string> extra_values_,
+    std::shared_ptr<app::io::file_streamer> file_streamer_,
+    const app::statistics::engine_settings& engine_settings_,
+    std::size_t shards_,
+    const std::vector<std::string>& metrics_,
+    const emission_settings& emission_settings_)
+    : median_calculator{std::move(tasks_), std::move(extra_values_), std::move(file_streamer_), metrics_, emission_settings_}
+    , _engine_settings{engine_settings_}
+{
+    const auto engines = _metrics.size() + 1;
+    for (std::size_t i = 0; i < engines; ++i) {
+        _merged.push_back(app::statistics::make_engine<Engine>(_engine_settings));
+    }
 
-        if (!task) {
+    _shards.reserve(std::max<std::size_t>(shards_, 1));
+    for (std::size_t i = 0; i < std::max<std::size_t>(shards_, 1); ++i) {
+        auto& state = *_shards.emplace_back(std::make_unique<shard>());
+        for (std::size_t j = 0; j < engines; ++j) {
+            state._engines.push_back(app::statistics::make_engine<Engine>(_engine_settings));
+        }
+        state._thread = std::jthread{[this, &state, i](std::stop_token stoken_) {
+            thread_placement::instance().apply(pipeline_stage::shards);
+            trace_thread("shard " + std::to_string(i));
+            inserting(state, stoken_);
+        }};
+    }
+
+    _calculating = std::jthread{[this] {
+        calculating(_stop_source.get_token());
+    }};
+}
+
+template <app::statistics::mergeable_estimator Engine>
+sharded_median_calculator<Engine>::~sharded_median_calculator()
+{
+    stop();
+}
+
+template <app::statistics::mergeable_estimator Engine>
+void sharded_median_calculator<Engine>::stop() noexcept
+{
+    // Сначала координатор (он ждёт шарды), затем сами шарды
+    _stop_source.request_stop();
+    if (_calculating.joinable()) {
+        _calculating.join();
+    }
+    for (auto& state : _shards) {
+        state->_thread.request_stop();
+        if (state->_thread.joinable()) {
+            state->_thread.join();
+        }
+    }
+    _engines_memory.set(engine_memory());
+    report_clamped();
+}
+
+template <app::statistics::mergeable_estimator Engine>
+std::size_t sharded_median_calculator<Engine>::engine_memory() const noexcept
+{
+    std::size_t total = 0;
+    for (const auto& engine : _merged) {
+        total += engine.memory_bytes();
+    }
+    for (const auto& state : _shards) {
+        for (const auto& engine : state->_engines) {
+            total += engine.memory_bytes();
+        }
+    }
+    return total;
+}
+
+template <app::statistics::mergeable_estimator Engine>
+std::uint64_t sharded_median_calculator<Engine>::engine_clamped() const noexcept
+{
+    std::uint64_t total = 0;
+    for (const auto& state : _shards) {
+        for (const auto& engine : state->_engines) {
+            total += clamped_values(engine);
+        }
+    }
+    return total;
+}
+
+template <app::statistics::mergeable_estimator Engine>
+double sharded_median_calculator<Engine>::column_value(const stat_column& column_) const noexcept(false)
+{
+    const Engine& engine = _merged[column_._metric];
+
+    switch (column_._kind) {
+        case stat_kind::median:   return engine.median();
+        case stat_kind::mean:     return engine.mean();
+        case stat_kind::quantile: return engine.quantile(column_._quantile);
+        case stat_kind::count:    return static_cast<double>(_moments.count());
+        case stat_kind::sum:      return _moments.sum();
+        case stat_kind::min:      return _moments.min();
+        case stat_kind::max:      return _moments.max();
+        case stat_kind::variance: return _moments.variance();
+        case stat_kind::stddev:   return _moments.stddev();
+        case stat_kind::vwap:     return _moments.vwap();
+    }
+    return 0.0;
+}
+
+template <app::statistics::mergeable_estimator Engine>
+void sharded_median_calculator<Engine>::submit(shard& shard_, batch_type batch_) noexcept(false)
+{
+    {
+        std::unique_lock<std::mutex> lock{shard_._mutex};
+        // Не даём координатору уйти далеко вперёд медленного шарда
+        shard_._condition.wait(lock, [&shard_] {
+            return shard_._submitted - shard_._done < MAX_PENDING;
+        });
+        shard_._pending.push_back(std::move(batch_));
+        ++shard_._submitted;
+    }
+    shard_._condition.notify_all();
+}
+
+template <app::statistics::mergeable_estimator Engine>
+void sharded_median_calculator<Engine>::merge_shards() noexcept(false)
+{
+    trace_span span{"merge_shards"};
+    for (auto& engine : _merged) {
+        engine = app::statistics::make_engine<Engine>(_engine_settings);
+    }
+
+    for (auto& state : _shards) {
+        std::unique_lock<std::mutex> lock{state->_mutex};
+        state->_condition.wait(lock, [&state] { return state->_done == state->_submitted; });
+
+        // Шард простаивает, пока координатор не отдаст ему новую пачку
+        for (std::size_t i = 0; i < _merged.size(); ++i) {
+            _merged[i].merge(state->_engines[i]);
+        }
+    }
+}
+
+template <app::statistics::mergeable_estimator Engine>
+void sharded_median_calculator<Engine>::inserting(shard& shard_, std::stop_token stoken_) noexcept(false)
+{
+    std::vector<batch_type> work;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{shard_._mutex};
+            if (!shard_._condition.wait(lock, stoken_, [&shard_] { return !shard_._pending.empty(); })) {
+                return;
+            }
+            work.swap(shard_._pending);
+        }
+
+        for (const auto& batch : work) {
+            trace_span span{"digest"};
+            for (const auto& task : batch) {
+                app::statistics::insert(shard_._engines.front(), task->price, task->receive_ts);
+                for (std::size_t i = 0; i < _metrics.size(); ++i) {
+                    app::statistics::insert(shard_._engines[i + 1], _metrics[i].value(*task), task->receive_ts);
+                }
+            }
+        }
+
+        const auto processed = work.size();
+        work.clear();
+        {
+            std::lock_guard<std::mutex> lock{shard_._mutex};
+            shard_._done += processed;
+        }
+        shard_._condition.notify_all();
+    }
+}
+
+template <app::statistics::mergeable_estimator Engine>
+void sharded_median_calculator<Engine>::calculating(std::stop_token stoken_) noexcept(false)
+{
+    auto& metrics = pipeline_metrics::instance();
+    thread_placement::instance().apply(pipeline_stage::calculator);
+    trace_thread("coordinator");
+    emission_state emission;
+    std::size_t next = 0;
+    std::size_t batches = 0;
+    std::int_fast64_t last_emitted = 0;
+    std::int_fast64_t last_submitted = 0;
+    bool emitted = false;
+    bool unmerged = false;
+
+    std::vector<std::pair<std::string, double>> extra_values;
+    extra_values.reserve(_columns.size());
+    for (const auto& column : _columns) {
+        extra_values.emplace_back(column._name, 0.0);
+    }
+
+    while (!stoken_.stop_requested()) {
+        // Пачка уходит шарду целиком, поэтому каждый раз новая
+        batch_type batch;
+        batch.reserve(BATCH_SIZE);
+        if (_tasks->pop_batch(batch, BATCH_SIZE) == 0) {
+            // Очередь закрыта и пуста - конец потока
+            flush(emission, last_submitted, unmerged, extra_values);
+            continue;
+        }
+        metrics.calculated(batch.size());
+        trace_span span{"dispatch"};
+
+        if (_with_moments) {
+            for (const auto& task : batch) {
+                _moments.add(task->price, task->quantity);
+            }
+        }
+        const auto timestamp = batch.back()->receive_ts;
+        const auto read_time = batch.back()->read_time;
+        submit(*_shards[next], std::move(batch));
+        next = (next + 1) % _shards.size();
+        last_submitted = timestamp;
+        unmerged = true;
+
+        // Точка вывода - полный круг по шардам или опустевшая очередь
+        if (next != 0 && !_tasks->empty()) {
+            continue;
+        }
+        // Слияние не бесплатно: пропускаем его, если интервал всё равно не даст вывести
+        if (emitted && timestamp - last_emitted < _emission._min_interval) {
             continue;
         }
-        // Обновляем T-Digest
-        _tdigest->add(task->price);
-        const double now_median = _tdigest->median();
-        std::vector<std::pair<std::string, double>> _extra_values = _tdigest->extra_values(_extra_values_name);
-            
-        // Выводим если медиана значительно изменилась
-        if (std::abs(now_median - old_median) > EPSILON) {
-            output_result(task->receive_ts, now_median, _extra_values);
-            old_median = now_median;
+
+        merge_shards();
+        unmerged = false;
+        // Шарды простаивают до следующей пачки: их движки можно читать
+        account_engines(batches);
+        const double now_median = _merged.front().median();
+        if (emission.should_emit(_emission, timestamp, now_median)) {
+            for (std::size_t i = 0; i < _columns.size(); ++i) {
+                extra_values[i].second = column_value(_columns[i]);
+            }
+            output_result(timestamp, now_median, extra_values, read_time);
+            last_emitted = timestamp;
+            emitted = true;
         }
     }
+    flush(emission, last_submitted, unmerged, extra_values);
+}
+
+template <app::statistics::mergeable_estimator Engine>
+void sharded_median_calculator<Engine>::flush(
+    emission_state& emission_,
+    std::int_fast64_t timestamp_,
+    bool& unmerged_,
+    std::vector<std::pair<std::string, double>>& extra_values_) noexcept(false)
+{
+    std::int_fast64_t timestamp = timestamp_;
+    double median = 0.0;
+    if (unmerged_) {
+        // Слияние пропускалось из-за интервала - последние пачки ещё не учтены
+        merge_shards();
+        unmerged_ = false;
+        median = _merged.front().median();
+        if (!emission_.should_emit(_emission, timestamp, median) && !emission_.flush(timestamp, median)) {
+            return;
+        }
+    } else if (!emission_.flush(timestamp, median)) {
+        return;
+    }
+    for (std::size_t i = 0; i < _columns.size(); ++i) {
+        extra_values_[i].second = column_value(_columns[i]);
+    }
+    output_result(timestamp, median, extra_values_, 0);
+}
+
+template class sharded_median_calculator<app::statistics::tdigest>;
+template class sharded_median_calculator<app::statistics::merging_digest>;
+
+// ==================== фабрика ====================
+
+std::unique_ptr<median_calculator> make_median_calculator(
+    std::shared_ptr<data_queue> tasks_,
+    std::vector<std::string> extra_values_,
+    std::shared_ptr<app::io::file_streamer> file_streamer_,
+    const app::statistics::engine_settings& engine_settings_,
+    group_settings group_settings_,
+    const std::vector<std::string>& metrics_,
+    const emission_settings& emission_settings_,
+    std::size_t shards_) noexcept(false)
+{
+    return app::statistics::with_engine(engine_settings_._kind,
+        [&]<typename Engine>(std::type_identity<Engine>) -> std::unique_ptr<median_calculator> {
+            if (group_settings_.enabled()) {
+                if (shards_ > 1) {
+                    spdlog::warn("Шарды не поддерживаются при группировке, используется один поток");
+                }
+                return std::make_unique<grouped_median_calculator<Engine>>(
+                    std::move(tasks_), std::move(extra_values_),
+                    std::move(file_streamer_), engine_settings_, std::move(group_settings_),
+                    metrics_, emission_settings_);
+            }
+            if constexpr (std::is_same_v<Engine, app::statistics::exact_quantiles>) {
+                // Слитый точный движок хранит весь поток: пересборка в каждой точке вывода квадратична
+                if (shards_ > 1) {
+                    spdlog::warn("Движок " ANSI_YELLOW "{}" ANSI_RESET " не шардируется, используется один поток",
+                                 app::statistics::engine_name(engine_settings_._kind));
+                }
+            } else if constexpr (app::statistics::mergeable_estimator<Engine>) {
+                if (shards_ > 1) {
+                    return std::make_unique<sharded_median_calculator<Engine>>(
+                        std::move(tasks_), std::move(extra_values_),
+                        std::move(file_streamer_), engine_settings_, shards_,
+                        metrics_, emission_settings_);
+                }
+            } else if (shards_ > 1) {
+                spdlog::warn("Движок " ANSI_YELLOW "{}" ANSI_RESET " не сливается, используется один поток",
+                             app::statistics::engine_name(engine_settings_._kind));
+            }
+            return std::make_unique<basic_median_calculator<Engine>>(
+                std::move(tasks_), std::move(extra_values_),
+                std::move(file_streamer_), engine_settings_, metrics_, emission_settings_);
+        });
 }
 
-}  // namespace app::processing
\ No newline at end of file
+}  // namespace app::processing
@@ -0,0 +1,174 @@
+/**
+ * \file memory_budget.cpp
+ * \brief Реализация учёта памяти и бюджета
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "memory_budget.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "logger.hpp"
+#include "trace.hpp"
+
+namespace app::processing {
+
+namespace {
+    constexpr auto ADMIT_WAIT = std::chrono::milliseconds{1};  ///< Шаг ожидания места в бюджете
+    constexpr double MIB = 1024.0 * 1024.0;
+
+    [[nodiscard]] double to_mib(std::size_t bytes_) noexcept
+    {
+        return static_cast<double>(bytes_) / MIB;
+    }
+} // unnamed namespace
+
+memory_budget& memory_budget::instance() noexcept
+{
+    static memory_budget budget;
+    return budget;
+}
+
+void memory_budget::configure(const memory_settings& settings_) noexcept
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    _settings = settings_;
+    if (_settings.limited()) {
+        spdlog::info("Бюджет памяти " ANSI_BLUE "{:.1f}" ANSI_RESET " МБ", to_mib(_settings._budget));
+    }
+}
+
+memory_account& memory_budget::account(const std::string& name_, bool charged_) noexcept(false)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    for (auto& account : _accounts) {
+        if (account.name() == name_) {
+            return account;
+        }
+    }
+    return _accounts.emplace_back(name_, charged_);
+}
+
+void memory_budget::track_queue(std::shared_ptr<const data_queue> queue_) noexcept(false)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    _queues.push_back(std::move(queue_));
+}
+
+std::size_t memory_budget::queued_bytes() const noexcept
+{
+    std::size_t rows = 0;
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        for (const auto& queue : _queues) {
+            rows += queue->size();
+        }
+    }
+    return rows * ROW_BYTES;
+}
+
+std::size_t memory_budget::charged_bytes() const noexcept
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    std::size_t total = 0;
+    for (const auto& account : _accounts) {
+        if (account.charged()) {
+            total += account.bytes();
+        }
+    }
+    return total;
+}
+
+std::size_t memory_budget::queue_allowance() noexcept
+{
+    const auto charged = charged_bytes();
+    if (charged + MIN_QUEUE_BYTES <= _settings._budget) {
+        return _settings._budget - charged;
+    }
+    if (!_overrun_reported.exchange(true, std::memory_order_relaxed)) {
+        spdlog::warn("Подсистемы без очередей занимают " ANSI_YELLOW "{:.1f}" ANSI_RESET " МБ при бюджете "
+                     ANSI_BLUE "{:.1f}" ANSI_RESET " МБ: очередям оставлен минимум",
+                     to_mib(charged), to_mib(_settings._budget));
+    }
+    return MIN_QUEUE_BYTES;
+}
+
+void memory_budget::admit(std::stop_token stoken_) noexcept
+{
+    auto queued = queued_bytes();
+    auto peak = _queued_peak.load(std::memory_order_relaxed);
+    while (queued > peak && !_queued_peak.compare_exchange_weak(peak, queued, std::memory_order_relaxed)) {
+    }
+    if (!_settings.limited() || queued <= queue_allowance()) {
+        return;
+    }
+
+    // Очереди разгружает калькулятор; ридер ждёт, а не читает дальше
+    trace_span span{"throttle"};
+    const auto start = std::chrono::steady_clock::now();
+    while (!stoken_.stop_requested() && queued > queue_allowance()) {
+        std::this_thread::sleep_for(ADMIT_WAIT);
+        queued = queued_bytes();
+    }
+    const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    _throttled.fetch_add(1, std::memory_order_relaxed);
+    _throttled_ns.fetch_add(static_cast<std::uint64_t>(waited.count()), std::memory_order_relaxed);
+}
+
+bool memory_budget::exhausted() const noexcept
+{
+    return _settings.limited() && charged_bytes() + MIN_QUEUE_BYTES > _settings._budget;
+}
+
+std::string memory_budget::to_json() const noexcept(false)
+{
+    const auto queued = queued_bytes();
+    const auto charged = charged_bytes();
+
+    std::string out = "{\"budget\": " + std::to_string(_settings._budget)
+        + ", \"used\": " + std::to_string(queued + charged)
+        + ", \"throttled\": " + std::to_string(_throttled.load(std::memory_order_relaxed))
+        + ", \"throttled_ms\": " + std::to_string(_throttled_ns.load(std::memory_order_relaxed) / 1'000'000)
+        + ", \"shed_rows\": " + std::to_string(_shed.load(std::memory_order_relaxed))
+        + ", \"subsystems\": [\n      {\"name\": \"queues\", \"bytes\": " + std::to_string(queued)
+        + ", \"peak\": " + std::to_string(std::max(queued, _queued_peak.load(std::memory_order_relaxed)))
+        + ", \"charged\": true}";
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    for (const auto& account : _accounts) {
+        out += ",\n      {\"name\": \"" + account.name() + "\", \"bytes\": " + std::to_string(account.bytes())
+            + ", \"peak\": " + std::to_string(account.peak())
+            + ", \"charged\": " + (account.charged() ? "true" : "false") + "}";
+    }
+    out += "\n    ]}";
+    return out;
+}
+
+void memory_budget::log() const noexcept
+{
+    const auto queued = queued_bytes();
+    std::string details;
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        for (const auto& account : _accounts) {
+            details += fmt::format(", {} {:.1f} (пик {:.1f})", account.name(), to_mib(account.bytes()), to_mib(account.peak()));
+        }
+    }
+
+    spdlog::info("Память, МБ: очереди " ANSI_BLUE "{:.1f}" ANSI_RESET " (пик {:.1f}){}",
+                 to_mib(queued), to_mib(std::max(queued, _queued_peak.load(std::memory_order_relaxed))), details);
+    if (_settings.limited()) {
+        spdlog::info("Бюджет " ANSI_BLUE "{:.1f}" ANSI_RESET " МБ: ридеры ждали " ANSI_YELLOW "{}" ANSI_RESET
+                     " раз, всего " ANSI_YELLOW "{:.1f}" ANSI_RESET " с",
+                     to_mib(_settings._budget), _throttled.load(std::memory_order_relaxed),
+                     static_cast<double>(_throttled_ns.load(std::memory_order_relaxed)) / 1e9);
+        if (const auto shed = _shed.load(std::memory_order_relaxed)) {
+            spdlog::warn("Бюджет исчерпан движками: отброшено строк новых групп " ANSI_YELLOW "{}" ANSI_RESET, shed);
+        }
+    }
+}
+
+}  // namespace app::processing
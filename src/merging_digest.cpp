@@ -0,0 +1,202 @@
+/**
+ * \file merging_digest.cpp
+ * \brief Реализация Merging T-Digest
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "merging_digest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace app::statistics {
+
+merging_digest::merging_digest(std::size_t compression_)
+    : _compression{compression_}
+{
+    if (_compression == 0) {
+        throw std::invalid_argument{"Compression parameter must be positive"};
+    }
+    _buffer.reserve(_compression * BUFFER_FACTOR);
+    _centroids.reserve(_compression * 2);
+    _scratch.reserve(_compression * (BUFFER_FACTOR + 2));
+}
+
+double merging_digest::q_to_k(double q_) const noexcept
+{
+    return static_cast<double>(_compression) / (2.0 * std::numbers::pi) * std::asin(2.0 * q_ - 1.0);
+}
+
+double merging_digest::k_to_q(double k_) const noexcept
+{
+    const double angle = k_ * 2.0 * std::numbers::pi / static_cast<double>(_compression);
+    return (std::sin(std::min(angle, std::numbers::pi / 2.0)) + 1.0) / 2.0;
+}
+
+void merging_digest::add(double value_) noexcept
+{
+    if (value_ < _min_value) _min_value = value_;
+    if (value_ > _max_value) _max_value = value_;
+
+    _buffer.push_back({value_, 1.0});
+    _sum += value_;
+    ++_total_count;
+
+    if (_buffer.size() >= _compression * BUFFER_FACTOR) {
+        flush();
+    }
+}
+
+void merging_digest::merge(const merging_digest& other_) noexcept(false)
+{
+    if (other_._total_count == 0) {
+        return;
+    }
+
+    // Центроиды другого дигеста - это взвешенные точки буфера
+    _buffer.insert(_buffer.end(), other_._centroids.begin(), other_._centroids.end());
+    _buffer.insert(_buffer.end(), other_._buffer.begin(), other_._buffer.end());
+    _total_count += other_._total_count;
+    _sum += other_._sum;
+    _min_value = std::min(_min_value, other_._min_value);
+    _max_value = std::max(_max_value, other_._max_value);
+
+    if (_buffer.size() >= _compression * BUFFER_FACTOR) {
+        flush();
+    }
+}
+
+void merging_digest::flush() noexcept
+{
+    if (_buffer.empty()) {
+        return;
+    }
+
+    _scratch.clear();
+    _scratch.insert(_scratch.end(), _centroids.begin(), _centroids.end());
+    _scratch.insert(_scratch.end(), _buffer.begin(), _buffer.end());
+    _buffer.clear();
+    _buffer_sorted = 0;
+
+    std::sort(_scratch.begin(), _scratch.end(),
+              [](const centroid& a_, const centroid& b_) {
+                  return a_._mean < b_._mean;
+              });
+
+    double total_weight = 0.0;
+    for (const auto& c : _scratch) {
+        total_weight += c._weight;
+    }
+
+    _centroids.clear();
+    centroid current = _scratch.front();
+    double weight_so_far = 0.0;
+    double q_limit = k_to_q(q_to_k(0.0) + 1.0);
+
+    for (std::size_t i = 1; i < _scratch.size(); ++i) {
+        const auto& next = _scratch[i];
+        const double proposed = weight_so_far + current._weight + next._weight;
+
+        if (proposed / total_weight <= q_limit) {
+            current._mean += (next._mean - current._mean) * next._weight / (current._weight + next._weight);
+            current._weight += next._weight;
+        } else {
+            weight_so_far += current._weight;
+            _centroids.push_back(current);
+            q_limit = k_to_q(q_to_k(weight_so_far / total_weight) + 1.0);
+            current = next;
+        }
+    }
+    _centroids.push_back(current);
+}
+
+void merging_digest::sort_buffer() const noexcept
+{
+    if (_buffer_sorted == _buffer.size()) {
+        return;
+    }
+
+    // Обычно между запросами добавлено одно значение - вставка в отсортированный префикс
+    const auto by_mean = [](const centroid& a_, const centroid& b_) { return a_._mean < b_._mean; };
+    const auto middle = _buffer.begin() + static_cast<std::ptrdiff_t>(_buffer_sorted);
+    std::sort(middle, _buffer.end(), by_mean);
+    std::inplace_merge(_buffer.begin(), middle, _buffer.end(), by_mean);
+    _buffer_sorted = _buffer.size();
+}
+
+double merging_digest::quantile(double q_) const noexcept(false)
+{
+    if (q_ < 0.0 || q_ > 1.0) {
+        throw std::invalid_argument{
+            "Quantile must be in range [0, 1], got: " + std::to_string(q_)
+        };
+    }
+
+    if (_total_count == 0) {
+        throw std::runtime_error{"Cannot compute quantile from empty digest"};
+    }
+
+    if (q_ == 0.0) return _min_value;
+    if (q_ == 1.0) return _max_value;
+
+    // Буфер не вливаем: запрос после каждой вставки иначе сжимал бы дигест каждый раз
+    sort_buffer();
+
+    // Центроиды и буфер обходятся слиянием по _mean как одна последовательность
+    std::size_t next_centroid = 0;
+    std::size_t next_buffered = 0;
+    const auto next = [&]() -> const centroid& {
+        if (next_buffered == _buffer.size()
+            || (next_centroid < _centroids.size() && _centroids[next_centroid]._mean <= _buffer[next_buffered]._mean)) {
+            return _centroids[next_centroid++];
+        }
+        return _buffer[next_buffered++];
+    };
+    const std::size_t count = _centroids.size() + _buffer.size();
+
+    const centroid* left = &next();
+    if (count == 1) {
+        return left->_mean;
+    }
+
+    const double target = q_ * static_cast<double>(_total_count);
+
+    // Левее центра первого центроида - интерполяция от минимума
+    if (target < left->_weight / 2.0) {
+        return _min_value + (left->_mean - _min_value) * target / (left->_weight / 2.0);
+    }
+
+    // Между центрами соседних центроидов
+    double cumulative = left->_weight / 2.0;
+    for (std::size_t i = 1; i < count; ++i) {
+        const centroid* right = &next();
+        const double step = (left->_weight + right->_weight) / 2.0;
+
+        if (cumulative + step > target) {
+            const double t = (target - cumulative) / step;
+            return left->_mean + (right->_mean - left->_mean) * t;
+        }
+        cumulative += step;
+        left = right;
+    }
+
+    // Правее центра последнего центроида - интерполяция к максимуму
+    const double t = std::min(1.0, (target - cumulative) / (left->_weight / 2.0));
+    return left->_mean + (_max_value - left->_mean) * t;
+}
+
+double merging_digest::mean() const noexcept
+{
+    return _total_count ? _sum / static_cast<double>(_total_count) : 0.0;
+}
+
+std::size_t merging_digest::memory_bytes() const noexcept
+{
+    return sizeof(*this)
+         + (_centroids.capacity() + _buffer.capacity() + _scratch.capacity()) * sizeof(centroid);
+}
+
+}  // namespace app::statistics
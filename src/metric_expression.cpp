@@ -0,0 +1,95 @@
+/**
+ * \file metric_expression.cpp
+ * \brief Реализация разбора выражений метрик
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "metric_expression.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <iterator>
+#include <stdexcept>
+
+namespace app::processing {
+
+namespace {
+    constexpr std::string_view OPERATIONS = "+-*/";
+
+    /**
+     * \brief Позиция операции в выражении без пробелов
+     *
+     * Первый символ не считаем операцией - это может быть знак константы,
+     * знак после экспоненты константы ("1e-3") тоже пропускаем.
+     */
+    [[nodiscard]] std::size_t find_operation(std::string_view text_) noexcept
+    {
+        for (auto pos = text_.find_first_of(OPERATIONS, 1); pos != std::string_view::npos;
+             pos = text_.find_first_of(OPERATIONS, pos + 1)) {
+            const bool exponent_sign = pos >= 2
+                && (text_[pos - 1] == 'e' || text_[pos - 1] == 'E')
+                && std::isdigit(static_cast<unsigned char>(text_[pos - 2]));
+            if (!exponent_sign) {
+                return pos;
+            }
+        }
+        return std::string_view::npos;
+    }
+} // unnamed namespace
+
+metric_expression::metric_expression(std::string_view text_) noexcept(false)
+{
+    std::copy_if(text_.begin(), text_.end(), std::back_inserter(_name),
+                 [](unsigned char c_) { return !std::isspace(c_); });
+    if (_name.empty()) {
+        throw std::invalid_argument{"Empty metric expression"};
+    }
+
+    const auto split = find_operation(_name);
+    if (split == std::string_view::npos) {
+        _lhs = parse_operand(_name);
+        return;
+    }
+
+    const std::string_view name{_name};
+    _lhs = parse_operand(name.substr(0, split));
+    _rhs = parse_operand(name.substr(split + 1));
+    switch (name[split]) {
+        case '+': _operation = operation::add;      break;
+        case '-': _operation = operation::subtract; break;
+        case '*': _operation = operation::multiply; break;
+        default:  _operation = operation::divide;   break;
+    }
+}
+
+metric_expression::operand metric_expression::parse_operand(std::string_view text_) noexcept(false)
+{
+    if (text_ == "price") {
+        return {column::price};
+    }
+    if (text_ == "quantity") {
+        return {column::quantity};
+    }
+    if (text_ == "receive_ts") {
+        return {column::receive_ts};
+    }
+    if (text_ == "exchange_ts") {
+        return {column::exchange_ts};
+    }
+    if (text_ == "latency") {
+        return {column::latency};
+    }
+
+    operand result;
+    const auto [ptr, ec] = std::from_chars(text_.data(), text_.data() + text_.size(), result._constant);
+    if (text_.empty() || ec != std::errc{} || ptr != text_.data() + text_.size()) {
+        throw std::invalid_argument{
+            "Unknown metric operand: " + std::string{text_}
+        };
+    }
+    return result;
+}
+
+}  // namespace app::processing
@@ -0,0 +1,207 @@
+/**
+ * \file pipeline_metrics.cpp
+ * \brief Реализация метрик конвейера
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "pipeline_metrics.hpp"
+
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#include "logger.hpp"
+#include "memory_budget.hpp"
+
+namespace app::processing {
+
+namespace {
+    constexpr double LATENCY_PERCENTILES[] = {0.5, 0.9, 0.99, 0.999};  ///< Перцентили задержки в снимке
+    constexpr const char* LATENCY_NAMES[] = {"p50", "p90", "p99", "p999"};
+
+    /**
+     * \brief Дописывает строку в JSON с экранированием
+     */
+    void append_json_string(std::string& out_, std::string_view value_)
+    {
+        out_ += '"';
+        for (const char c : value_) {
+            if (c == '"' || c == '\\') {
+                out_ += '\\';
+                out_ += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out_ += ' ';
+            } else {
+                out_ += c;
+            }
+        }
+        out_ += '"';
+    }
+} // unnamed namespace
+
+pipeline_metrics& pipeline_metrics::instance() noexcept
+{
+    static pipeline_metrics metrics;
+    return metrics;
+}
+
+std::int_fast64_t pipeline_metrics::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+reader_counters& pipeline_metrics::register_reader(std::string name_) noexcept(false)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    auto& counters = _readers.emplace_back();
+    counters._name = std::move(name_);
+    return counters;
+}
+
+void pipeline_metrics::watch_queue(std::string name_, std::shared_ptr<const data_queue> queue_) noexcept(false)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    _queues.push_back({std::move(name_), std::move(queue_)});
+}
+
+void pipeline_metrics::emitted(std::int_fast64_t read_time_) noexcept
+{
+    _emitted.add();
+    const auto time = now();
+    _last_emitted.store(time, std::memory_order_relaxed);
+    if (read_time_ > 0) {
+        const auto latency = time - read_time_;
+        _latency.record(latency > 0 ? static_cast<std::uint64_t>(latency) : 0);
+
+        // Пишет только вывод по строке, прочитанной раньше всех предыдущих
+        auto first = _first_read.load(std::memory_order_relaxed);
+        while ((first == 0 || read_time_ < first)
+               && !_first_read.compare_exchange_weak(first, read_time_, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+std::string pipeline_metrics::to_json() const noexcept(false)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    const std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - _start;
+
+    std::string out = "{\n  \"uptime_s\": " + std::to_string(uptime.count()) + ",\n  \"readers\": [";
+    for (std::size_t i = 0; i < _readers.size(); ++i) {
+        const auto& reader = _readers[i];
+        out += i ? ",\n    {\"file\": " : "\n    {\"file\": ";
+        append_json_string(out, reader._name);
+        out += ", \"parsed\": " + std::to_string(reader._parsed.load())
+            + ", \"rejected\": " + std::to_string(reader._rejected.load()) + "}";
+    }
+    out += "\n  ],\n  \"funnel\": {\"forwarded\": " + std::to_string(_forwarded.load())
+        + ", \"dropped_out_of_order\": " + std::to_string(_dropped.load()) + "},\n  \"queues\": [";
+    for (std::size_t i = 0; i < _queues.size(); ++i) {
+        out += i ? ",\n    {\"name\": " : "\n    {\"name\": ";
+        append_json_string(out, _queues[i]._name);
+        out += ", \"depth\": " + std::to_string(_queues[i]._queue->size())
+            + ", \"high_water\": " + std::to_string(_queues[i]._queue->high_water()) + "}";
+    }
+    out += "\n  ],\n  \"calculator\": {\"rows\": " + std::to_string(_calculated.load())
+        + ", \"emitted\": " + std::to_string(_emitted.load())
+        + ", \"clamped\": " + std::to_string(_clamped.load(std::memory_order_relaxed)) + "},\n  \"latency_ns\": {\"count\": "
+        + std::to_string(_latency.count());
+    for (std::size_t i = 0; i < std::size(LATENCY_PERCENTILES); ++i) {
+        out += ", \"" + std::string{LATENCY_NAMES[i]} + "\": " + std::to_string(_latency.percentile(LATENCY_PERCENTILES[i]));
+    }
+    out += ", \"max\": " + std::to_string(_latency.max()) + "},\n  \"memory\": "
+        + memory_budget::instance().to_json() + "\n}\n";
+    return out;
+}
+
+void pipeline_metrics::log() const noexcept
+{
+    std::uint64_t parsed = 0;
+    std::uint64_t rejected = 0;
+    std::size_t high_water = 0;
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        for (const auto& reader : _readers) {
+            parsed += reader._parsed.load();
+            rejected += reader._rejected.load();
+        }
+        for (const auto& queue : _queues) {
+            high_water = std::max(high_water, queue._queue->high_water());
+        }
+    }
+
+    spdlog::info("Метрики: разобрано " ANSI_GREEN "{}" ANSI_RESET ", ошибок " ANSI_YELLOW "{}" ANSI_RESET
+                 ", не по порядку " ANSI_YELLOW "{}" ANSI_RESET ", посчитано " ANSI_GREEN "{}" ANSI_RESET
+                 ", выведено " ANSI_GREEN "{}" ANSI_RESET ", пик очереди " ANSI_BLUE "{}" ANSI_RESET,
+                 parsed, rejected, _dropped.load(), _calculated.load(), _emitted.load(), high_water);
+    spdlog::info("Задержка чтение → вывод, мкс: p50 " ANSI_BLUE "{:.1f}" ANSI_RESET
+                 ", p99 " ANSI_BLUE "{:.1f}" ANSI_RESET ", max " ANSI_BLUE "{:.1f}" ANSI_RESET,
+                 static_cast<double>(_latency.percentile(0.5)) / 1000.0,
+                 static_cast<double>(_latency.percentile(0.99)) / 1000.0,
+                 static_cast<double>(_latency.max()) / 1000.0);
+    if (const auto clamped = _clamped.load(std::memory_order_relaxed)) {
+        spdlog::warn("Прижато к краю диапазона гистограммы значений: " ANSI_YELLOW "{}" ANSI_RESET, clamped);
+    }
+    memory_budget::instance().log();
+}
+
+void pipeline_metrics::write_file() const noexcept
+{
+    if (_settings._file.empty()) {
+        return;
+    }
+    try {
+        // Читатель файла никогда не видит его наполовину записанным
+        auto temporary = _settings._file;
+        temporary += ".tmp";
+        {
+            std::ofstream out{temporary, std::ios::trunc};
+            out << to_json();
+        }
+        std::error_code ec;
+        std::filesystem::rename(temporary, _settings._file, ec);
+        if (ec) {
+            spdlog::warn("Не удалось записать статистику " ANSI_YELLOW "{}" ANSI_RESET ": {}",
+                         _settings._file.string(), ec.message());
+        }
+    } catch (const std::exception& e_) {
+        spdlog::warn("Не удалось записать статистику: {}", e_.what());
+    }
+}
+
+void pipeline_metrics::exporting(std::stop_token stoken_) noexcept
+{
+    std::mutex mutex;
+    std::unique_lock<std::mutex> lock{mutex};
+    while (!_condition.wait_for(lock, stoken_, _settings._interval, [] { return false; })) {
+        if (stoken_.stop_requested()) {
+            return;
+        }
+        write_file();
+        log();
+    }
+}
+
+void pipeline_metrics::start_export(const stats_settings& settings_) noexcept(false)
+{
+    _settings = settings_;
+    if (_settings._interval.count() > 0) {
+        _exporting = std::jthread{[this](std::stop_token stoken_) {
+            exporting(stoken_);
+        }};
+    }
+}
+
+void pipeline_metrics::stop_export() noexcept
+{
+    _exporting.request_stop();
+    if (_exporting.joinable()) {
+        _exporting.join();
+    }
+    write_file();
+    log();
+}
+
+}  // namespace app::processing
@@ -0,0 +1,72 @@
+/**
+ * \file quantile_engine.cpp
+ * \brief Реализация выбора движка квантилей
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "quantile_engine.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace app::statistics {
+
+engine_kind parse_engine_kind(std::string_view name_) noexcept(false)
+{
+    if (name_ == "tdigest") {
+        return engine_kind::tdigest;
+    }
+    if (name_ == "histogram") {
+        return engine_kind::histogram;
+    }
+    if (name_ == "window") {
+        return engine_kind::window;
+    }
+    if (name_ == "decayed") {
+        return engine_kind::decayed;
+    }
+    if (name_ == "merging") {
+        return engine_kind::merging;
+    }
+    if (name_ == "exact") {
+        return engine_kind::exact;
+    }
+    throw std::invalid_argument{
+        "Unknown quantile engine: " + std::string{name_}
+    };
+}
+
+engine_settings metric_settings(const engine_settings& settings_, std::string_view metric_) noexcept(false)
+{
+    engine_settings result = settings_;
+    result._metric_ticks.clear();
+
+    const auto found = std::find_if(settings_._metric_ticks.begin(), settings_._metric_ticks.end(),
+        [metric_](const auto& entry_) { return entry_.first == metric_; });
+    if (found != settings_._metric_ticks.end()) {
+        result._tick_size = found->second;
+    } else if (settings_._kind == engine_kind::histogram || settings_._kind == engine_kind::window) {
+        throw std::invalid_argument{
+            "Metric " + std::string{metric_} + " needs a tick size in [calculator.metric_ticks] for the "
+            + std::string{engine_name(settings_._kind)} + " engine"
+        };
+    }
+    return result;
+}
+
+std::string_view engine_name(engine_kind kind_) noexcept
+{
+    switch (kind_) {
+        case engine_kind::histogram: return "histogram";
+        case engine_kind::window:    return "window";
+        case engine_kind::decayed:   return "decayed";
+        case engine_kind::merging:   return "merging";
+        case engine_kind::exact:     return "exact";
+        case engine_kind::tdigest:   return "tdigest";
+    }
+    return "tdigest";
+}
+
+}  // namespace app::statistics
@@ -13,17 +13,27 @@
 
 #include "data_queue.hpp"
 #include "logger.hpp"
+#include "memory_budget.hpp"
+#include "pipeline_metrics.hpp"
+#include "thread_placement.hpp"
+#include "trace.hpp"
 
 namespace app::io {
 
 namespace fs = std::filesystem;
 
+namespace {
+    constexpr std::uint32_t TRACE_ROWS = 1024;      ///< Строк в одном интервале трассы
+} // unnamed namespace
+
 // ==================== конструкторы/деструктор ====================
 
 readers_manager::readers_manager(bool streaming_mode_)
     :_streaming_mode{streaming_mode_}
 {
     _tasks = std::make_shared<app::processing::data_queue>();
+    app::processing::pipeline_metrics::instance().watch_queue("tasks", _tasks);
+    app::processing::memory_budget::instance().track_queue(_tasks);
 }
 
 readers_manager::~readers_manager()
@@ -33,6 +43,8 @@ readers_manager::~readers_manager()
 readers_manager::readers_manager(readers_manager&& other_) noexcept
     : _readers{std::move(other_._readers)}
     , _tasks{std::move(other_._tasks)}
+    , _arrivals{std::move(other_._arrivals)}
+    , _funnel_wait{other_._funnel_wait}
 {}
 
 readers_manager& readers_manager::operator=(readers_manager&& other_) noexcept
@@ -43,13 +55,15 @@ readers_manager& readers_manager::operator=(readers_manager&& other_) noexcept
         std::lock_guard<std::mutex> lock{_mutex};
         _readers = std::move(other_._readers);
         _tasks = std::move(other_._tasks);
+        _arrivals = std::move(other_._arrivals);
+        _funnel_wait = other_._funnel_wait;
     }
     return *this;
 }
 
 // ==================== public методы ====================
 
-void readers_manager::add_csv_file(std::string filename_) noexcept(false)
+void readers_manager::add_csv_file(std::string filename_, std::uint32_t source_) noexcept(false)
 {
     // Проверяем существование файла
     if (!fs::exists(filename_)) {
@@ -66,10 +80,14 @@ void readers_manager::add_csv_file(std::string filename_) noexcept(false)
     
     try {
         // Создаём читателя
-        auto reader = std::make_shared<app::io::csv_reader>(filename_, _tasks, _streaming_mode);
+        auto reader = std::make_shared<app::io::csv_reader>(filename_, _tasks, _streaming_mode, source_);
+        // Все ридеры будят воронку одним сигналом
+        reader->local_queue()->attach_signal(_arrivals);
         // Создаём поток с функцией чтения
         // Используем jthread для автоматического join при разрушении
         std::jthread thread = std::jthread{&csv_reader::read_file, reader.get(), _readers_stoken.get_token()};
+        app::processing::pipeline_metrics::instance().watch_queue(filename_, reader->local_queue());
+        app::processing::memory_budget::instance().track_queue(reader->local_queue());
 
         std::lock_guard<std::mutex> lock{_mutex};
 
@@ -110,6 +128,7 @@ void readers_manager::stop() noexcept
     }
     if (_redirecting_tasks.joinable()) {
         _stoken_redirecting.request_stop();
+        _arrivals->notify();
         _redirecting_tasks.join();
     }
     //остановить главную очередь
@@ -123,6 +142,10 @@ std::atomic<std::size_t> readers_manager::total_tasks() const noexcept
 
 void readers_manager::redirecting_tasks(std::stop_token stoken) noexcept
 {
+    auto& metrics = app::processing::pipeline_metrics::instance();
+    app::processing::thread_placement::instance().apply(app::processing::pipeline_stage::funnel);
+    app::processing::trace_thread("funnel");
+    app::processing::trace_batch merging{"merge", TRACE_ROWS};
     int_fast64_t min_recieve_ts = 0;
     while (
     [&] -> bool {
@@ -135,36 +158,53 @@ void readers_manager::redirecting_tasks(std::stop_token stoken) noexcept
         if (!stoken.stop_requested()) { return true; }
         return false;
     }()) {
-        std::lock_guard<std::mutex> lock{_mutex};
-        std::shared_ptr<app::processing::data_queue> queue_with_min_ts = nullptr;
-        for (auto& tasks : _readers) {
-            if (tasks._reader_local_queue->empty()) {
-                continue;
-            }
-
-            // //провевяемая очередь начинается с элемента < минимального времени
-            while (!tasks._reader_local_queue->empty()) {
-                // Получаем указатель на первый элемент
-                const data* front_data = tasks._reader_local_queue->front();
-                if (!front_data) break;  // защита на всякий случай
+        // Эпоха до просмотра очередей: строка, пришедшая после, разбудит воронку
+        const auto seen = _arrivals->epoch();
+        bool forwarded = false;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            std::shared_ptr<app::processing::data_queue> queue_with_min_ts = nullptr;
+            for (auto& tasks : _readers) {
+                if (tasks._reader_local_queue->empty()) {
+                    continue;
+                }
+
+                // //провевяемая очередь начинается с элемента < минимального времени
+                while (!tasks._reader_local_queue->empty()) {
+                    // Получаем указатель на первый элемент
+                    const data* front_data = tasks._reader_local_queue->front();
+                    if (!front_data) break;  // защита на всякий случай
                 
-                if (front_data->receive_ts >= min_recieve_ts) break;
-                // Удаляем устаревший элемент
-                tasks._reader_local_queue->pop();
-            }
+                    if (front_data->receive_ts >= min_recieve_ts) break;
+                    // Удаляем устаревший элемент
+                    tasks._reader_local_queue->pop();
+                    metrics.dropped();
+                }
+
+                // захвачена первая непустая очередь
+                if (!tasks._reader_local_queue->empty() && queue_with_min_ts == nullptr) {
+                    queue_with_min_ts = tasks._reader_local_queue;
+                }
+                if (!tasks._reader_local_queue->empty() && tasks._reader_local_queue->front()->receive_ts <= queue_with_min_ts->front()->receive_ts) {
+                    queue_with_min_ts = tasks._reader_local_queue;
+                }
 
-            // захвачена первая непустая очередь
-            if (!tasks._reader_local_queue->empty() && queue_with_min_ts == nullptr) {
-                queue_with_min_ts = tasks._reader_local_queue;
             }
-            if (!tasks._reader_local_queue->empty() && tasks._reader_local_queue->front()->receive_ts <= queue_with_min_ts->front()->receive_ts) {
-                queue_with_min_ts = tasks._reader_local_queue;
+            if (queue_with_min_ts) {
+                min_recieve_ts = queue_with_min_ts->front()->receive_ts;
+                _tasks->push(queue_with_min_ts->pop());
+                metrics.forwarded();
+                merging.tick();
+                forwarded = true;
+            } else {
+                // Очереди пусты: интервал трассы не должен растягиваться на простой
+                merging.close();
             }
-
         }
-        if (queue_with_min_ts) {
-            min_recieve_ts = queue_with_min_ts->front()->receive_ts;
-            _tasks->push(queue_with_min_ts->pop());
+
+        // Ждём ридеров без мьютекса, иначе add_csv_file встанет на время простоя
+        if (!forwarded && !stoken.stop_requested()) {
+            _arrivals->wait(_funnel_wait, seen);
         }
     }
 }
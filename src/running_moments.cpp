@@ -0,0 +1,65 @@
+/**
+ * \file running_moments.cpp
+ * \brief Реализация скользящих моментов потока цен
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "running_moments.hpp"
+
+#include <cmath>
+
+namespace app::statistics {
+
+namespace acc = boost::accumulators;
+
+void running_moments::add(double price_, double quantity_) noexcept
+{
+    _prices(price_);
+    if (quantity_ > 0.0) {
+        _volumes(price_, acc::weight = quantity_);
+    }
+}
+
+std::size_t running_moments::count() const noexcept
+{
+    return acc::count(_prices);
+}
+
+double running_moments::sum() const noexcept
+{
+    return acc::sum(_prices);
+}
+
+double running_moments::min() const noexcept
+{
+    return empty() ? 0.0 : acc::min(_prices);
+}
+
+double running_moments::max() const noexcept
+{
+    return empty() ? 0.0 : acc::max(_prices);
+}
+
+double running_moments::mean() const noexcept
+{
+    return empty() ? 0.0 : acc::mean(_prices);
+}
+
+double running_moments::variance() const noexcept
+{
+    return empty() ? 0.0 : acc::variance(_prices);
+}
+
+double running_moments::stddev() const noexcept
+{
+    return std::sqrt(variance());
+}
+
+double running_moments::vwap() const noexcept
+{
+    const double volume = acc::sum_of_weights(_volumes);
+    return volume > 0.0 ? acc::weighted_sum(_volumes) / volume : 0.0;
+}
+
+}  // namespace app::statistics
@@ -0,0 +1,93 @@
+/**
+ * \file segment_writer.cpp
+ * \brief Реализация записи сегмента через memory-mapped file
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "segment_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace app::io {
+
+namespace fs = std::filesystem;
+
+namespace {
+    /**
+     * \brief Выделяет место под файл заданного размера
+     *
+     * resize_file задаёт длину; на Linux posix_fallocate дополнительно
+     * резервирует блоки, чтобы запись в отображение не упиралась в
+     * выделение места на диске.
+     */
+    void preallocate(const fs::path& path_, std::size_t size_) noexcept(false)
+    {
+        fs::resize_file(path_, size_);
+#if defined(__linux__)
+        if (const int fd = ::open(path_.c_str(), O_RDWR); fd >= 0) {
+            (void)::posix_fallocate(fd, 0, static_cast<off_t>(size_));
+            ::close(fd);
+        }
+#endif
+    }
+} // unnamed namespace
+
+segment_writer::segment_writer(fs::path path_, std::size_t preallocate_) noexcept(false)
+    : _path{std::move(path_)}
+{
+    std::ofstream{_path, std::ios::binary | std::ios::trunc};
+    map(std::max<std::size_t>(preallocate_, 1));
+}
+
+segment_writer::~segment_writer()
+{
+    try {
+        seal();
+    } catch (...) {
+        // Необрезанный сегмент лучше исключения из деструктора
+    }
+}
+
+void segment_writer::map(std::size_t capacity_) noexcept(false)
+{
+    _region = boost::interprocess::mapped_region{};
+    _mapping = boost::interprocess::file_mapping{};
+
+    preallocate(_path, capacity_);
+    _capacity = capacity_;
+
+    _mapping = boost::interprocess::file_mapping{_path.string().c_str(), boost::interprocess::read_write};
+    _region = boost::interprocess::mapped_region{_mapping, boost::interprocess::read_write};
+}
+
+void segment_writer::write(const char* data_, std::size_t size_) noexcept(false)
+{
+    if (size_ > _capacity - _length) {
+        map(std::max(_capacity * 2, _length + size_));
+    }
+    std::memcpy(static_cast<char*>(_region.get_address()) + _length, data_, size_);
+    _length += size_;
+}
+
+void segment_writer::seal() noexcept(false)
+{
+    if (_sealed) {
+        return;
+    }
+    _sealed = true;
+
+    _region = boost::interprocess::mapped_region{};
+    _mapping = boost::interprocess::file_mapping{};
+    fs::resize_file(_path, _length);
+}
+
+}  // namespace app::io
@@ -0,0 +1,98 @@
+/**
+ * \file shm_publisher.cpp
+ * \brief Реализация публикации результатов в разделяемую память
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "shm_publisher.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+#include "memory_budget.hpp"
+
+namespace app::io {
+
+namespace {
+    namespace bip = boost::interprocess;
+
+    /**
+     * \brief Удаляет сегмент, оставшийся от прошлого запуска, и возвращает имя
+     */
+    [[nodiscard]] const std::string& remove_stale(const std::string& name_) noexcept
+    {
+        bip::shared_memory_object::remove(name_.c_str());
+        return name_;
+    }
+} // unnamed namespace
+
+shm_publisher::shm_publisher(const publisher_settings& settings_) noexcept(false)
+    : _name{settings_._name}
+    , _memory{bip::create_only, remove_stale(_name).c_str(), bip::read_write}
+{
+    const auto capacity = std::bit_ceil(std::max<std::size_t>(settings_._capacity, 2));
+    _memory.truncate(static_cast<bip::offset_t>(shm::segment_size(capacity)));
+    _region = bip::mapped_region{_memory, bip::read_write};
+
+    // Сегмент создан обнулённым; magic выставляется последним, когда раскладка заполнена
+    _header = new (_region.get_address()) shm::ring_header{};
+    _header->_version = shm::VERSION;
+    _header->_capacity = static_cast<std::uint32_t>(capacity);
+    _slots = shm::slots(_region.get_address());
+    for (std::size_t i = 0; i < capacity; ++i) {
+        new (_slots + i) shm::ring_slot{};
+    }
+    _mask = static_cast<std::uint32_t>(capacity - 1);
+    _header->_magic.store(shm::MAGIC, std::memory_order_release);
+    app::processing::memory_budget::instance().account("shm_ring").add(static_cast<std::int64_t>(_region.get_size()));
+}
+
+shm_publisher::~shm_publisher()
+{
+    app::processing::memory_budget::instance().account("shm_ring").add(-static_cast<std::int64_t>(_region.get_size()));
+    bip::shared_memory_object::remove(_name.c_str());
+}
+
+void shm_publisher::write_header(std::vector<std::pair<std::string, double>> const& extra_values_) noexcept
+{
+    const auto columns = std::min(extra_values_.size(), shm::MAX_COLUMNS);
+    _header->_columns = static_cast<std::uint32_t>(columns);
+    for (std::size_t i = 0; i < columns; ++i) {
+        const auto& name = extra_values_[i].first;
+        const auto length = std::min(name.size(), shm::NAME_SIZE - 1);
+        std::copy_n(name.data(), length, _header->_names[i]);
+        _header->_names[i][length] = '\0';
+    }
+    // Колонки видны читателю через release-запись _published первой записи
+}
+
+void shm_publisher::publish(
+    std::int_fast64_t timestamp_,
+    double median_,
+    std::vector<std::pair<std::string, double>> const& extra_values_) noexcept
+{
+    if (_sequence == 0) {
+        write_header(extra_values_);
+    }
+
+    const auto sequence = ++_sequence;
+    auto& slot = _slots[(sequence - 1) & _mask];
+
+    // Нечётный счётчик - ячейка пишется; барьер не даёт данным обогнать его
+    slot._sequence.store(2 * sequence - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot._payload[0].store(static_cast<std::uint64_t>(timestamp_), std::memory_order_relaxed);
+    slot._payload[1].store(std::bit_cast<std::uint64_t>(median_), std::memory_order_relaxed);
+    const auto columns = _header->_columns;
+    for (std::size_t i = 0; i < columns; ++i) {
+        slot._payload[2 + i].store(std::bit_cast<std::uint64_t>(extra_values_[i].second), std::memory_order_relaxed);
+    }
+
+    slot._sequence.store(2 * sequence, std::memory_order_release);
+    _header->_published.store(sequence, std::memory_order_release);
+}
+
+}  // namespace app::io
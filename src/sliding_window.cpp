@@ -0,0 +1,107 @@
+/**
+ * \file sliding_window.cpp
+ * \brief Реализация медианы по скользящему окну
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "sliding_window.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace app::statistics {
+
+sliding_window::sliding_window(
+    std::int_fast64_t span_,
+    double tick_size_,
+    std::size_t max_pages_)
+    : _span{span_}
+    , _slice{std::max<std::int_fast64_t>(span_ / SLICES, 1)}
+    , _histogram{tick_size_, max_pages_}
+{
+    if (_span <= 0) {
+        throw std::invalid_argument{"Window span must be positive"};
+    }
+}
+
+void sliding_window::add(double value_, std::int_fast64_t timestamp_) noexcept(false)
+{
+    const auto index = timestamp_ / _slice;
+    if (index != _open_index) {
+        close_slice();
+        _open_index = index;
+    }
+    expire(timestamp_);
+
+    _histogram.add(value_);
+    ++_open[_histogram.to_tick(value_)];
+    _open_sum += value_;
+}
+
+void sliding_window::close_slice() noexcept(false)
+{
+    if (_open.empty()) {
+        return;
+    }
+    _slices.push_back({_open_index, {_open.begin(), _open.end()}, _open_sum});
+    _open.clear();
+    _open_sum = 0.0;
+    resum();
+}
+
+void sliding_window::expire(std::int_fast64_t timestamp_) noexcept
+{
+    // Срез вытесняется, когда его последняя единица receive_ts вышла за левую границу окна
+    const auto horizon = timestamp_ - _span;
+    bool expired = false;
+    while (!_slices.empty() && (_slices.front()._index + 1) * _slice - 1 <= horizon) {
+        for (const auto& [tick, count] : _slices.front()._ticks) {
+            _histogram.remove(tick, count);
+        }
+        _slices.pop_front();
+        expired = true;
+    }
+    if (expired) {
+        resum();
+    }
+}
+
+void sliding_window::resum() noexcept
+{
+    // Не вычитаем суммы вытесненных срезов, а складываем оставшиеся заново
+    _closed_sum = 0.0;
+    for (const auto& closed : _slices) {
+        _closed_sum += closed._sum;
+    }
+}
+
+double sliding_window::mean() const noexcept
+{
+    const auto count = _histogram.size();
+    return count ? (_closed_sum + _open_sum) / static_cast<double>(count) : 0.0;
+}
+
+std::vector<std::pair<std::string, double>> sliding_window::extra_values(std::vector<std::string> const values_name_) const noexcept(false)
+{
+    auto result = _histogram.extra_values(values_name_);
+    for (auto& [name, value] : result) {
+        if (name == "mean") {
+            value = mean();
+        }
+    }
+    return result;
+}
+
+std::size_t sliding_window::memory_bytes() const noexcept
+{
+    std::size_t total = sizeof(*this) - sizeof(_histogram)
+                      + _histogram.memory_bytes()
+                      + _open.bucket_count() * (sizeof(decltype(_open)::value_type) + 1);
+    for (const auto& closed : _slices) {
+        total += sizeof(slice) + closed._ticks.capacity() * sizeof(decltype(closed._ticks)::value_type);
+    }
+    return total;
+}
+
+}  // namespace app::statistics
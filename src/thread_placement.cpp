@@ -0,0 +1,290 @@
+/**
+ * \file thread_placement.cpp
+ * \brief Реализация размещения потоков
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "thread_placement.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "logger.hpp"
+
+namespace app::processing {
+
+namespace {
+    constexpr std::string_view STAGE_NAMES[STAGE_COUNT] = {"readers", "funnel", "calculator", "shards", "writer"};
+    constexpr std::string_view PRIORITY_NAMES[] = {"unchanged", "low", "normal", "high", "realtime"};
+#ifdef _WIN32
+    constexpr unsigned CPU_LIMIT = sizeof(DWORD_PTR) * 8;   ///< Процессоров в маске привязки потока
+#else
+    constexpr unsigned CPU_LIMIT = CPU_SETSIZE;             ///< Процессоров в cpu_set_t
+#endif
+
+    /**
+     * \brief Список процессоров для лога: "0-3,6"
+     */
+    [[nodiscard]] std::string format_cpu_list(const std::vector<unsigned>& cpus_)
+    {
+        if (cpus_.empty()) {
+            return "любые";
+        }
+        std::string out;
+        for (std::size_t i = 0; i < cpus_.size();) {
+            auto j = i;
+            while (j + 1 < cpus_.size() && cpus_[j + 1] == cpus_[j] + 1) {
+                ++j;
+            }
+            out += (out.empty() ? "" : ",") + std::to_string(cpus_[i]);
+            if (j > i) {
+                out += "-" + std::to_string(cpus_[j]);
+            }
+            i = j + 1;
+        }
+        return out;
+    }
+
+    /**
+     * \brief Процессоры, на которых процессу разрешено работать (taskset, cgroups)
+     */
+    [[nodiscard]] std::vector<unsigned> usable_cpus() noexcept(false)
+    {
+        std::vector<unsigned> cpus;
+#ifdef _WIN32
+        DWORD_PTR process = 0;
+        DWORD_PTR system = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system)) {
+            for (unsigned cpu = 0; cpu < CPU_LIMIT; ++cpu) {
+                if (process & (DWORD_PTR{1} << cpu)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#else
+        // Вызывается из главного потока до запуска стадий - его маска равна маске процесса
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_LIMIT; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        // Система не ответила - считаем доступными все процессоры
+        if (cpus.empty()) {
+            for (unsigned cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1U); ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    /**
+     * \brief Закрепляет текущий поток за процессорами
+     * \return false, если система отказала
+     */
+    [[nodiscard]] bool set_affinity(const std::vector<unsigned>& cpus_) noexcept
+    {
+#ifdef _WIN32
+        DWORD_PTR mask = 0;
+        for (const auto cpu : cpus_) {
+            if (cpu < sizeof(DWORD_PTR) * 8) {
+                mask |= DWORD_PTR{1} << cpu;
+            }
+        }
+        return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const auto cpu : cpus_) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        // pid 0 - вызывающий поток, а не весь процесс
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#endif
+    }
+
+    /**
+     * \brief Задаёт приоритет текущего потока
+     * \return false, если система отказала
+     */
+    [[nodiscard]] bool set_priority(thread_priority priority_) noexcept
+    {
+#ifdef _WIN32
+        int level = THREAD_PRIORITY_NORMAL;
+        switch (priority_) {
+            case thread_priority::unchanged: return true;
+            case thread_priority::low: level = THREAD_PRIORITY_BELOW_NORMAL; break;
+            case thread_priority::normal: level = THREAD_PRIORITY_NORMAL; break;
+            case thread_priority::high: level = THREAD_PRIORITY_ABOVE_NORMAL; break;
+            case thread_priority::realtime: level = THREAD_PRIORITY_TIME_CRITICAL; break;
+        }
+        return SetThreadPriority(GetCurrentThread(), level) != 0;
+#else
+        int nice = 0;
+        switch (priority_) {
+            case thread_priority::unchanged: return true;
+            case thread_priority::low: nice = 10; break;
+            case thread_priority::normal: nice = 0; break;
+            case thread_priority::high: nice = -10; break;
+            case thread_priority::realtime: {
+                sched_param param{};
+                param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+                return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+            }
+        }
+        // На Linux nice задаётся отдельно для каждого потока по его tid
+        return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) == 0;
+#endif
+    }
+} // unnamed namespace
+
+bool placement_settings::enabled() const noexcept
+{
+    return std::any_of(_stages.begin(), _stages.end(), [](const stage_placement& stage_) {
+        return !stage_._cpus.empty() || stage_._priority != thread_priority::unchanged;
+    });
+}
+
+std::string_view stage_name(pipeline_stage stage_) noexcept
+{
+    return STAGE_NAMES[static_cast<std::size_t>(stage_)];
+}
+
+thread_priority parse_priority(std::string_view name_) noexcept(false)
+{
+    for (std::size_t i = 0; i < std::size(PRIORITY_NAMES); ++i) {
+        if (name_ == PRIORITY_NAMES[i]) {
+            return static_cast<thread_priority>(i);
+        }
+    }
+    throw std::invalid_argument{"Unknown thread priority: " + std::string{name_}};
+}
+
+std::vector<unsigned> parse_cpu_list(std::string_view list_) noexcept(false)
+{
+    const auto parse_cpu = [list_](std::string_view text_) {
+        unsigned cpu = 0;
+        const auto [ptr, ec] = std::from_chars(text_.data(), text_.data() + text_.size(), cpu);
+        if (text_.empty() || ec != std::errc{} || ptr != text_.data() + text_.size()) {
+            throw std::invalid_argument{"Invalid CPU list: " + std::string{list_}};
+        }
+        // Проверяем до разворачивания диапазона: "0-4294967295" не должен выделять память
+        if (cpu >= CPU_LIMIT) {
+            throw std::invalid_argument{
+                "CPU " + std::to_string(cpu) + " is out of range (at most " + std::to_string(CPU_LIMIT) + " CPUs)"
+            };
+        }
+        return cpu;
+    };
+
+    std::vector<unsigned> cpus;
+    while (!list_.empty()) {
+        const auto comma = list_.find(',');
+        const auto item = list_.substr(0, comma);
+        list_ = comma == std::string_view::npos ? std::string_view{} : list_.substr(comma + 1);
+
+        const auto dash = item.find('-');
+        const auto first = parse_cpu(item.substr(0, dash));
+        const auto last = dash == std::string_view::npos ? first : parse_cpu(item.substr(dash + 1));
+        if (last < first) {
+            throw std::invalid_argument{"Invalid CPU range: " + std::string{item}};
+        }
+        for (auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+thread_placement& thread_placement::instance() noexcept
+{
+    static thread_placement placement;
+    return placement;
+}
+
+void thread_placement::configure(const placement_settings& settings_) noexcept(false)
+{
+    if (!settings_.enabled()) {
+        return;
+    }
+    auto settings = settings_;
+
+    const auto available = usable_cpus();
+    for (std::size_t i = 0; i < STAGE_COUNT; ++i) {
+        for (const auto cpu : settings._stages[i]._cpus) {
+            if (!std::binary_search(available.begin(), available.end(), cpu)) {
+                throw std::invalid_argument{
+                    "CPU " + std::to_string(cpu) + " of stage " + std::string{STAGE_NAMES[i]}
+                    + " is not available to the process (allowed: " + format_cpu_list(available) + ")"
+                };
+            }
+        }
+    }
+
+    // Изоляция: остальные стадии не занимают процессоры калькулятора
+    const auto& isolated = settings._stages[static_cast<std::size_t>(pipeline_stage::calculator)]._cpus;
+    if (settings._isolate_calculator && !isolated.empty()) {
+        for (std::size_t i = 0; i < STAGE_COUNT; ++i) {
+            if (i == static_cast<std::size_t>(pipeline_stage::calculator)) {
+                continue;
+            }
+            auto& cpus = settings._stages[i]._cpus;
+            if (cpus.empty()) {
+                cpus = available;
+            }
+            std::erase_if(cpus, [&isolated](unsigned cpu_) {
+                return std::binary_search(isolated.begin(), isolated.end(), cpu_);
+            });
+            if (cpus.empty()) {
+                throw std::invalid_argument{
+                    "Calculator isolation leaves stage " + std::string{STAGE_NAMES[i]} + " without CPUs"
+                };
+            }
+        }
+    }
+
+    _settings = std::move(settings);
+    for (std::size_t i = 0; i < STAGE_COUNT; ++i) {
+        const auto& stage = _settings._stages[i];
+        spdlog::info("Размещение " ANSI_BLUE "{}" ANSI_RESET ": CPU " ANSI_GREEN "{}" ANSI_RESET ", приоритет {}",
+                     STAGE_NAMES[i], format_cpu_list(stage._cpus),
+                     PRIORITY_NAMES[static_cast<std::size_t>(stage._priority)]);
+    }
+}
+
+void thread_placement::apply(pipeline_stage stage_) const noexcept
+{
+    const auto& stage = _settings._stages[static_cast<std::size_t>(stage_)];
+    if (!stage._cpus.empty() && !set_affinity(stage._cpus)) {
+        LOG_LIMITED(spdlog::level::warn, "Не удалось закрепить поток стадии " ANSI_YELLOW "{}" ANSI_RESET " за CPU {}",
+                    stage_name(stage_), format_cpu_list(stage._cpus));
+    }
+    if (!set_priority(stage._priority)) {
+        LOG_LIMITED(spdlog::level::warn, "Не удалось задать приоритет {} потоку стадии " ANSI_YELLOW "{}" ANSI_RESET,
+                    PRIORITY_NAMES[static_cast<std::size_t>(stage._priority)], stage_name(stage_));
+    }
+}
+
+}  // namespace app::processing
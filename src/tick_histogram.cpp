@@ -0,0 +1,284 @@
+/**
+ * \file tick_histogram.cpp
+ * \brief Реализация гистограммы по ценовым тикам
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "tick_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+namespace app::statistics {
+
+namespace {
+    constexpr double MAX_TICK = 4.0e18;   ///< Ограничение номера тика (защита от переполнения int64)
+
+    /**
+     * \brief Деление с округлением вниз для отрицательных номеров тиков
+     */
+    [[nodiscard]] std::int64_t floor_div(std::int64_t a_, std::int64_t b_) noexcept
+    {
+        const auto q = a_ / b_;
+        return (a_ % b_ != 0 && a_ < 0) ? q - 1 : q;
+    }
+} // unnamed namespace
+
+// ==================== page implementation ====================
+
+void tick_histogram::page::add(std::size_t tick_) noexcept
+{
+    for (std::size_t i = tick_ + 1; i <= PAGE_TICKS; i += i & (~i + 1)) {
+        ++_tree[i];
+    }
+    ++_total;
+}
+
+void tick_histogram::page::remove(std::size_t tick_, std::uint64_t count_) noexcept
+{
+    for (std::size_t i = tick_ + 1; i <= PAGE_TICKS; i += i & (~i + 1)) {
+        _tree[i] -= count_;
+    }
+    _total -= count_;
+}
+
+std::size_t tick_histogram::page::select(std::uint64_t rank_) const noexcept
+{
+    std::size_t pos = 0;
+    for (std::size_t step = PAGE_TICKS; step > 0; step >>= 1) {
+        if (pos + step <= PAGE_TICKS && _tree[pos + step] <= rank_) {
+            pos += step;
+            rank_ -= _tree[pos];
+        }
+    }
+    return pos;
+}
+
+// ==================== tick_histogram implementation ====================
+
+tick_histogram::tick_histogram(double tick_size_, std::size_t max_pages_)
+    : _tick_size{tick_size_}
+    , _max_pages{max_pages_}
+{
+    if (!(_tick_size > 0.0)) {
+        throw std::invalid_argument{"Tick size must be positive"};
+    }
+    if (_max_pages == 0) {
+        throw std::invalid_argument{"Histogram page limit must be positive"};
+    }
+}
+
+std::int64_t tick_histogram::to_tick(double value_) const noexcept
+{
+    const double tick = std::round(value_ / _tick_size);
+    return static_cast<std::int64_t>(std::clamp(tick, -MAX_TICK, MAX_TICK));
+}
+
+std::size_t tick_histogram::ensure_page(std::int64_t page_) noexcept(false)
+{
+    if (_pages.empty()) {
+        const auto initial = std::min(INITIAL_PAGES, _max_pages);
+        _first_page = page_ - static_cast<std::int64_t>(initial / 2);
+        _pages.resize(initial);
+        _page_tree.assign(initial + 1, 0);
+    }
+
+    const auto current = static_cast<std::int64_t>(_pages.size());
+    auto relative = page_ - _first_page;
+    if (relative >= 0 && relative < current) {
+        return static_cast<std::size_t>(relative);
+    }
+
+    // Цена вышла за текущий диапазон - расширяем каталог в нужную сторону
+    if (_pages.size() < _max_pages) {
+        const auto needed = (relative < 0) ? current - relative : relative + 1;
+        const auto grown = static_cast<std::int64_t>(std::min<std::uint64_t>(
+            std::max<std::uint64_t>(static_cast<std::uint64_t>(current) * 2,
+                                    static_cast<std::uint64_t>(needed)),
+            _max_pages));
+        const auto extra = static_cast<std::size_t>(grown - current);
+
+        if (relative < 0) {
+            std::vector<std::unique_ptr<page>> pages(extra);
+            pages.reserve(static_cast<std::size_t>(grown));
+            std::move(_pages.begin(), _pages.end(), std::back_inserter(pages));
+            _pages = std::move(pages);
+            _first_page -= static_cast<std::int64_t>(extra);
+        } else {
+            _pages.resize(static_cast<std::size_t>(grown));
+        }
+        rebuild_page_tree();
+        relative = page_ - _first_page;
+    }
+
+    return static_cast<std::size_t>(std::clamp<std::int64_t>(
+        relative, 0, static_cast<std::int64_t>(_pages.size()) - 1));
+}
+
+void tick_histogram::rebuild_page_tree() noexcept
+{
+    const std::size_t count = _pages.size();
+    _page_tree.assign(count + 1, 0);
+
+    for (std::size_t i = 1; i <= count; ++i) {
+        _page_tree[i] += _pages[i - 1] ? _pages[i - 1]->_total : 0;
+        const std::size_t parent = i + (i & (~i + 1));
+        if (parent <= count) {
+            _page_tree[parent] += _page_tree[i];
+        }
+    }
+}
+
+tick_histogram::position tick_histogram::locate(std::int64_t tick_) noexcept(false)
+{
+    const auto page_no = floor_div(tick_, static_cast<std::int64_t>(PAGE_TICKS));
+    const std::size_t idx = ensure_page(page_no);
+
+    const auto local = tick_ - (_first_page + static_cast<std::int64_t>(idx)) * static_cast<std::int64_t>(PAGE_TICKS);
+    const bool clamped = local < 0 || local >= static_cast<std::int64_t>(PAGE_TICKS);
+
+    return {
+        idx,
+        static_cast<std::size_t>(std::clamp<std::int64_t>(local, 0, PAGE_TICKS - 1)),
+        clamped
+    };
+}
+
+void tick_histogram::add(double value_) noexcept(false)
+{
+    if (value_ < _min_value) _min_value = value_;
+    if (value_ > _max_value) _max_value = value_;
+
+    const auto [idx, local, clamped] = locate(to_tick(value_));
+    if (clamped) {
+        ++_clamped;
+    }
+
+    auto& slot = _pages[idx];
+    if (!slot) {
+        slot = std::make_unique<page>();
+        ++_allocated_pages;
+    }
+    slot->add(local);
+
+    for (std::size_t i = idx + 1; i <= _pages.size(); i += i & (~i + 1)) {
+        ++_page_tree[i];
+    }
+
+    _sum += value_;
+    ++_total_count;
+}
+
+void tick_histogram::remove(std::int64_t tick_, std::uint64_t count_) noexcept
+{
+    if (count_ == 0 || count_ > _total_count) {
+        return;
+    }
+
+    // Тик уже был добавлен, поэтому его страница попадает в каталог
+    // и расширения каталога (единственного источника исключений) не будет;
+    // прижатый при добавлении тик прижимается к тому же краю
+    const auto [idx, local, clamped] = locate(tick_);
+
+    auto& slot = _pages[idx];
+    if (!slot || slot->_total < count_) {
+        return;
+    }
+    slot->remove(local, count_);
+
+    for (std::size_t i = idx + 1; i <= _pages.size(); i += i & (~i + 1)) {
+        _page_tree[i] -= count_;
+    }
+
+    _total_count -= count_;
+    _has_removals = true;
+}
+
+double tick_histogram::select(std::uint64_t rank_) const noexcept
+{
+    const std::size_t count = _pages.size();
+    std::size_t pos = 0;
+    for (std::size_t step = std::bit_floor(count); step > 0; step >>= 1) {
+        if (pos + step <= count && _page_tree[pos + step] <= rank_) {
+            pos += step;
+            rank_ -= _page_tree[pos];
+        }
+    }
+
+    const auto local = _pages[pos]->select(rank_);
+    const auto tick = (_first_page + static_cast<std::int64_t>(pos)) * static_cast<std::int64_t>(PAGE_TICKS)
+                    + static_cast<std::int64_t>(local);
+    return static_cast<double>(tick) * _tick_size;
+}
+
+double tick_histogram::quantile(double q_) const noexcept(false)
+{
+    if (q_ < 0.0 || q_ > 1.0) {
+        throw std::invalid_argument{
+            "Quantile must be in range [0, 1], got: " + std::to_string(q_)
+        };
+    }
+
+    if (_total_count == 0) {
+        throw std::runtime_error{"Cannot compute quantile from empty histogram"};
+    }
+
+    if (_has_removals) {
+        if (q_ == 0.0) return select(0);
+        if (q_ == 1.0) return select(_total_count - 1);
+    } else {
+        if (q_ == 0.0) return _min_value;
+        if (q_ == 1.0) return _max_value;
+    }
+
+    // Линейная интерполяция между соседними рангами (как у классической медианы)
+    const double position = q_ * static_cast<double>(_total_count - 1);
+    const auto lower = static_cast<std::uint64_t>(position);
+    const double fraction = position - static_cast<double>(lower);
+
+    double result = select(lower);
+    if (fraction > 0.0 && lower + 1 < _total_count) {
+        const double upper = select(lower + 1);
+        result += (upper - result) * fraction;
+    }
+
+    return _has_removals ? result : std::clamp(result, _min_value, _max_value);
+}
+
+double tick_histogram::mean() const noexcept
+{
+    return _total_count ? _sum / static_cast<double>(_total_count) : 0.0;
+}
+
+std::vector<std::pair<std::string, double>> tick_histogram::extra_values(std::vector<std::string> const values_name_) const noexcept(false)
+{
+    std::vector<std::pair<std::string, double>> _result;
+    _result.reserve(values_name_.size());
+
+    for (std::string _values_name : values_name_) {
+        if (_values_name == "mean") {
+            _result.push_back(std::make_pair(_values_name, mean()));
+        } else if (_values_name == "p90") {
+            _result.push_back(std::make_pair(_values_name, quantile(0.9)));
+        } else if (_values_name == "p95") {
+            _result.push_back(std::make_pair(_values_name, quantile(0.95)));
+        } else if (_values_name == "p99") {
+            _result.push_back(std::make_pair(_values_name, quantile(0.99)));
+        }
+    }
+
+    return _result;
+}
+
+std::size_t tick_histogram::memory_bytes() const noexcept
+{
+    return sizeof(*this)
+         + _allocated_pages * sizeof(page)
+         + _pages.capacity() * sizeof(std::unique_ptr<page>)
+         + _page_tree.capacity() * sizeof(std::uint64_t);
+}
+
+}  // namespace app::statistics
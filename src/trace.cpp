@@ -0,0 +1,184 @@
+/**
+ * \file trace.cpp
+ * \brief Реализация трассировки активности потоков
+ * \author github: Sobig-F
+ * \date 2026-02-15
+ */
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <new>
+
+#include "logger.hpp"
+
+namespace app::processing {
+
+namespace {
+    constexpr std::uint32_t TRACE_PID = 1;          ///< pid в трассе: процесс один
+
+    thread_local std::string t_thread_name;         ///< Имя потока до создания кольца
+
+    /**
+     * \brief Дописывает строку в JSON с экранированием (пути Windows содержат '\\')
+     */
+    void append_json_string(std::string& out_, std::string_view value_)
+    {
+        out_ += '"';
+        for (const char c : value_) {
+            if (c == '"' || c == '\\') {
+                out_ += '\\';
+                out_ += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out_ += ' ';
+            } else {
+                out_ += c;
+            }
+        }
+        out_ += '"';
+    }
+
+    /**
+     * \brief Дописывает наносекунды как микросекунды с тремя знаками (единица Chrome trace)
+     */
+    void append_microseconds(std::string& out_, std::uint64_t nanoseconds_)
+    {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), nanoseconds_ / 1000);
+        *result.ptr++ = '.';
+        const auto fraction = nanoseconds_ % 1000;
+        *result.ptr++ = static_cast<char>('0' + fraction / 100);
+        *result.ptr++ = static_cast<char>('0' + fraction / 10 % 10);
+        *result.ptr++ = static_cast<char>('0' + fraction % 10);
+        out_.append(buffer, result.ptr);
+    }
+} // unnamed namespace
+
+tracer& tracer::instance() noexcept
+{
+    static tracer trace;
+    return trace;
+}
+
+void tracer::start(const trace_settings& settings_) noexcept(false)
+{
+    if (!settings_.enabled()) {
+        return;
+    }
+    if constexpr (!TRACE_COMPILED) {
+        spdlog::warn("Трассировка не собрана: пересоберите с " ANSI_BLUE "-DCSV_MEDIAN_TRACE=ON" ANSI_RESET);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{_mutex};
+    _settings = settings_;
+    _settings._events_per_thread = std::max<std::size_t>(_settings._events_per_thread, 1);
+    _origin = now();
+    // Потоки, увидевшие запись включённой, видят и _origin с размером колец
+    _enabled.store(true, std::memory_order_release);
+    spdlog::info("Трассировка в " ANSI_YELLOW "{}" ANSI_RESET ", событий на поток " ANSI_BLUE "{}" ANSI_RESET,
+                 _settings._file.string(), _settings._events_per_thread);
+}
+
+void tracer::stop() noexcept
+{
+    if (!_enabled.exchange(false, std::memory_order_relaxed)) {
+        return;
+    }
+    try {
+        const auto json = to_json();
+        std::ofstream out{_settings._file, std::ios::binary | std::ios::trunc};
+        out << json;
+        if (!out) {
+            spdlog::warn("Не удалось записать трассу " ANSI_YELLOW "{}" ANSI_RESET, _settings._file.string());
+            return;
+        }
+        spdlog::info("Трасса сохранена в " ANSI_YELLOW "{}" ANSI_RESET, _settings._file.string());
+    } catch (const std::exception& e_) {
+        spdlog::warn("Не удалось записать трассу: {}", e_.what());
+    }
+}
+
+void tracer::name_thread(std::string name_) noexcept
+{
+    t_thread_name = std::move(name_);
+}
+
+tracer::thread_buffer* tracer::local() noexcept
+{
+    thread_local thread_buffer* buffer = nullptr;
+    if (buffer) {
+        return buffer;
+    }
+    try {
+        std::lock_guard<std::mutex> lock{_mutex};
+        auto& created = _buffers.emplace_back();
+        created._tid = static_cast<std::uint32_t>(_buffers.size());
+        created._name = t_thread_name.empty() ? "thread " + std::to_string(created._tid) : t_thread_name;
+        created._events.resize(_settings._events_per_thread);
+        buffer = &created;
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+    return buffer;
+}
+
+void tracer::record(const char* name_, std::uint64_t start_, std::uint64_t end_) noexcept
+{
+    auto* buffer = local();
+    if (!buffer) {
+        return;
+    }
+    // Писатель один, поэтому хватает загрузки и сохранения
+    const auto written = buffer->_written.load(std::memory_order_relaxed);
+    buffer->_events[written % buffer->_events.size()] = {
+        name_,
+        start_ > _origin ? start_ - _origin : 0,
+        end_ > _origin ? end_ - _origin : 0,
+    };
+    buffer->_written.store(written + 1, std::memory_order_release);
+}
+
+std::string tracer::to_json() const noexcept(false)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    std::string out;
+    out += "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    bool first = true;
+    const auto separator = [&out, &first] {
+        out += first ? "  " : ",\n  ";
+        first = false;
+    };
+
+    for (const auto& buffer : _buffers) {
+        const auto tid = std::to_string(buffer._tid);
+        separator();
+        out += "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " + std::to_string(TRACE_PID)
+             + ", \"tid\": " + tid + ", \"args\": {\"name\": ";
+        append_json_string(out, buffer._name);
+        out += "}}";
+
+        // Кольцо хранит последние size() событий в порядке записи
+        const auto written = buffer._written.load(std::memory_order_acquire);
+        const auto capacity = buffer._events.size();
+        const auto first_event = written > capacity ? written - capacity : 0;
+        for (auto i = first_event; i < written; ++i) {
+            const auto& event = buffer._events[i % capacity];
+            separator();
+            out += "{\"ph\": \"X\", \"name\": ";
+            append_json_string(out, event._name);
+            out += ", \"pid\": " + std::to_string(TRACE_PID) + ", \"tid\": " + tid + ", \"ts\": ";
+            append_microseconds(out, event._start);
+            out += ", \"dur\": ";
+            append_microseconds(out, event._end > event._start ? event._end - event._start : 0);
+            out += '}';
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+}  // namespace app::processing